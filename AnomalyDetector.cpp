@@ -0,0 +1,193 @@
+// AnomalyDetector.cpp
+
+// Implements AnomalyDetector: per-row climatological or rolling baselines laid out
+// as columns, and a vectorizable z-score and threshold pass over them.
+
+#include "AnomalyDetector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	const int kMinutesPerDay = 1440;
+
+	/**
+	 * @brief Returns 1 / stdDev, or 0 when the spread is unknown or zero (such rows are never flagged).
+	 *
+	 * @param  stdDev - The standard deviation.
+	 * @return double - The inverse.
+	 */
+	double inverseOf(double stdDev) {
+		return stdDev > 1e-12 ? 1.0 / stdDev : 0.0;
+	}
+}
+
+	/**
+	 * @brief Constructor for AnomalyDetector.
+	 *
+	 * @param  threshold - The |z| above which a reading is flagged.
+	 * @param  baseline - The baseline.
+	 * @param  window - Readings in the rolling baseline (at least 2).
+	 * @return void
+	 */
+AnomalyDetector::AnomalyDetector(double threshold, Baseline baseline, int window)
+	: threshold(threshold), baseline(baseline), window(std::max(2, window)) {}
+
+	/**
+	 * @brief Copies the metric's column over the range and scans it (wind direction is not scanned).
+	 *
+	 * @param  data - Pointer to the collection.
+	 * @param  metric - The metric.
+	 * @param  from - First minute key.
+	 * @param  to - Last minute key (inclusive).
+	 * @param  out - Receives the flagged readings.
+	 * @return size_t - The number flagged.
+	 */
+size_t AnomalyDetector::scan(const WeatherDataCollection* data, Metric metric, int from, int to,
+							 std::vector<Anomaly>* out) const {
+	if (!isLinearMetric(metric)) return 0;
+
+	std::vector<int> keys;
+	std::vector<double> values;
+	data->copySeries(metric, from, to, &keys, &values);
+	return scanSeries(&keys, &values, data->getClimatology(), metric, out);
+}
+
+	/**
+	 * @brief Builds the baseline columns, then computes and thresholds the z-scores in one flat loop.
+	 *
+	 * The loop writes a flag per row rather than branching, so it vectorizes; the flagged rows
+	 * are gathered afterwards. Wind direction has no linear baseline, so nothing is flagged.
+	 *
+	 * @param  keys - Pointer to the minute keys, ascending.
+	 * @param  values - Pointer to the values.
+	 * @param  climatology - Pointer to the normals (climatological baseline only).
+	 * @param  metric - The metric.
+	 * @param  out - Receives the flagged readings.
+	 * @return size_t - The number flagged.
+	 */
+size_t AnomalyDetector::scanSeries(const std::vector<int>* keys, const std::vector<double>* values,
+								   const ClimatologyIndex* climatology, Metric metric, std::vector<Anomaly>* out) const {
+	size_t n = std::min(keys->size(), values->size());
+	if (n == 0 || !isLinearMetric(metric)) return 0;
+
+	std::vector<double> mean;
+	std::vector<double> inverseStd;
+	if (baseline == Climatological) {
+		climatologicalBaseline(keys, climatology, metric, &mean, &inverseStd);
+	} else {
+		rollingBaseline(values, window, &mean, &inverseStd);
+	}
+
+	std::vector<double> z(n);
+	std::vector<unsigned char> flagged(n);
+	const double* v = values->data();
+	const double* mu = mean.data();
+	const double* inv = inverseStd.data();
+	double* zs = z.data();
+	unsigned char* flags = flagged.data();
+	const double limit = threshold;
+	for (size_t i = 0; i < n; ++i) {
+		double score = (v[i] - mu[i]) * inv[i];
+		zs[i] = score;
+		flags[i] = static_cast<unsigned char>(std::fabs(score) > limit);
+	}
+
+	size_t count = 0;
+	for (size_t i = 0; i < n; ++i) {
+		if (flags[i]) {
+			out->push_back(Anomaly{(*keys)[i], v[i], zs[i]});
+			++count;
+		}
+	}
+	return count;
+}
+
+	/**
+	 * @brief Looks the 24 hourly normals up once per calendar day and spreads them over that day's rows.
+	 *
+	 * @param  keys - Pointer to the minute keys, ascending.
+	 * @param  climatology - Pointer to the normals.
+	 * @param  metric - The metric.
+	 * @param  mean - Receives the mean per row.
+	 * @param  inverseStd - Receives the inverse standard deviation per row.
+	 * @return void
+	 */
+void AnomalyDetector::climatologicalBaseline(const std::vector<int>* keys, const ClimatologyIndex* climatology, Metric metric,
+											 std::vector<double>* mean, std::vector<double>* inverseStd) {
+	size_t n = keys->size();
+	mean->assign(n, 0.0);
+	inverseStd->assign(n, 0.0);
+	if (climatology == nullptr) return;
+
+	double dayMean[ClimatologyIndex::kHours];
+	double dayInverse[ClimatologyIndex::kHours];
+	Date date;
+	bool haveDay = false;
+	int currentDay = 0;
+
+	for (size_t i = 0; i < n; ++i) {
+		int key = (*keys)[i];
+		int day = key / kMinutesPerDay - (key % kMinutesPerDay < 0 ? 1 : 0);
+		if (!haveDay || day != currentDay) {
+			currentDay = day;
+			haveDay = true;
+			date.setMinuteKey(day * kMinutesPerDay);
+			int dayOfYear = date.GetDayOfYear();
+			for (int hour = 0; hour < ClimatologyIndex::kHours; ++hour) {
+				ClimateNormal normal = climatology->getNormal(metric, dayOfYear, hour);
+				dayMean[hour] = normal.mean;
+				dayInverse[hour] = normal.count < 2 ? 0.0 : inverseOf(normal.stdDev);
+			}
+		}
+
+		int hour = (key - day * kMinutesPerDay) / 60;
+		(*mean)[i] = dayMean[hour];
+		(*inverseStd)[i] = dayInverse[hour];
+	}
+}
+
+	/**
+	 * @brief Computes the trailing-window mean and spread of every row from prefix sums.
+	 *
+	 * Values are centred on the series mean before summing, which keeps the sums of squares
+	 * small and the variance free of cancellation. Row i is compared with rows
+	 * [i - window, i), so a spike does not dilute its own baseline.
+	 *
+	 * @param  values - Pointer to the values.
+	 * @param  window - The number of preceding readings.
+	 * @param  mean - Receives the mean per row.
+	 * @param  inverseStd - Receives the inverse standard deviation per row.
+	 * @return void
+	 */
+void AnomalyDetector::rollingBaseline(const std::vector<double>* values, int window,
+									  std::vector<double>* mean, std::vector<double>* inverseStd) {
+	size_t n = values->size();
+	mean->assign(n, 0.0);
+	inverseStd->assign(n, 0.0);
+
+	double centre = 0.0;
+	for (double value : *values) centre += value;
+	centre /= static_cast<double>(n);
+
+	std::vector<double> sum(n + 1, 0.0);
+	std::vector<double> sumSq(n + 1, 0.0);
+	for (size_t i = 0; i < n; ++i) {
+		double x = (*values)[i] - centre;
+		sum[i + 1] = sum[i] + x;
+		sumSq[i + 1] = sumSq[i] + x * x;
+	}
+
+	size_t w = static_cast<size_t>(window);
+	for (size_t i = 1; i < n; ++i) {
+		size_t first = i > w ? i - w : 0;
+		double count = static_cast<double>(i - first);
+		double s = sum[i] - sum[first];
+		double s2 = sumSq[i] - sumSq[first];
+		double m = s / count;
+		(*mean)[i] = m + centre;
+		if (count >= 2.0) {
+			double variance = std::max(0.0, (s2 - s * m) / (count - 1.0));
+			(*inverseStd)[i] = inverseOf(std::sqrt(variance));
+		}
+	}
+}
@@ -0,0 +1,113 @@
+#ifndef ANOMALYDETECTOR_H
+#define ANOMALYDETECTOR_H
+
+#include "ClimatologyIndex.h"
+#include "Metric.h"
+#include "WeatherDataCollection.h"
+#include <cstddef>
+#include <vector>
+
+/**
+ * @struct Anomaly
+ * @brief One flagged reading.
+ */
+struct Anomaly {
+	int key;        ///< Minute key of the reading (see Date::toMinuteKey).
+	double value;   ///< The reading.
+	double zScore;  ///< Its distance from the baseline mean, in baseline standard deviations.
+};
+
+/**
+ * @class AnomalyDetector
+ * @brief Flags readings whose z-score against a baseline exceeds a threshold.
+ *
+ * Two baselines are offered. The climatological baseline is the normal of the reading's
+ * (day-of-year, hour) cell from the collection's ClimatologyIndex, so a reading is judged
+ * against what is usual for that time of year and day. The rolling baseline is the mean
+ * and standard deviation of the preceding window readings, which catches spikes and steps
+ * relative to the recent past.
+ *
+ * A scan works on the metric's column, not on records: the baseline mean and inverse
+ * standard deviation are first laid out per row (looked up once per day, or taken from
+ * prefix sums), and the z-scores and threshold test are then one branch-free loop over
+ * contiguous arrays that the compiler vectorizes. Only flagged rows are emitted.
+ *
+ * Wind direction is not scanned: a z-score against a linear mean of angles is
+ * meaningless (see isLinearMetric), so it never flags anything.
+ */
+class AnomalyDetector {
+public:
+	/**
+	 * @enum Baseline
+	 * @brief What a reading is compared with.
+	 */
+	enum Baseline {
+		Climatological,  ///< The (day-of-year, hour) normal across all years.
+		Rolling          ///< The preceding window readings.
+	};
+
+	/**
+	 * @brief Constructor.
+	 * @param threshold The |z| above which a reading is flagged.
+	 * @param baseline The baseline.
+	 * @param window The number of preceding readings in the rolling baseline (144 is one day).
+	 */
+	explicit AnomalyDetector(double threshold = 4.0, Baseline baseline = Climatological, int window = 144);
+
+	/**
+	 * @brief Scans one metric of a collection over a minute-key range.
+	 * @param data A constant pointer to the collection.
+	 * @param metric The metric.
+	 * @param from The first minute key of the range.
+	 * @param to The last minute key of the range (inclusive).
+	 * @param out Receives the flagged readings in time order (appended).
+	 * @return size_t The number of readings flagged.
+	 */
+	size_t scan(const WeatherDataCollection* data, Metric metric, int from, int to, std::vector<Anomaly>* out) const;
+
+	/**
+	 * @brief Scans a series given as parallel key and value vectors.
+	 * @param keys A constant pointer to the minute keys, ascending.
+	 * @param values A constant pointer to the values.
+	 * @param climatology The normals for the climatological baseline (unused for the rolling one).
+	 * @param metric The metric the values belong to.
+	 * @param out Receives the flagged readings in time order (appended).
+	 * @return size_t The number of readings flagged (0 for wind direction).
+	 */
+	size_t scanSeries(const std::vector<int>* keys, const std::vector<double>* values,
+					  const ClimatologyIndex* climatology, Metric metric, std::vector<Anomaly>* out) const;
+
+	/**
+	 * @brief Gets the flagging threshold.
+	 * @return double The |z| threshold.
+	 */
+	double getThreshold() const { return threshold; }
+
+private:
+	/**
+	 * @brief Lays out the climatological mean and inverse standard deviation of each row.
+	 * @param keys The minute keys.
+	 * @param climatology The normals.
+	 * @param metric The metric.
+	 * @param mean Receives the mean per row.
+	 * @param inverseStd Receives 1 / standard deviation per row (0 where it is unknown or zero).
+	 */
+	static void climatologicalBaseline(const std::vector<int>* keys, const ClimatologyIndex* climatology, Metric metric,
+									   std::vector<double>* mean, std::vector<double>* inverseStd);
+
+	/**
+	 * @brief Lays out the mean and inverse standard deviation of the window readings before each row.
+	 * @param values The values.
+	 * @param window The number of preceding readings.
+	 * @param mean Receives the mean per row.
+	 * @param inverseStd Receives 1 / standard deviation per row (0 with fewer than 2 readings or no spread).
+	 */
+	static void rollingBaseline(const std::vector<double>* values, int window,
+								std::vector<double>* mean, std::vector<double>* inverseStd);
+
+	double threshold;   ///< |z| above which a reading is flagged.
+	Baseline baseline;  ///< The baseline.
+	int window;         ///< Readings in the rolling baseline.
+};
+
+#endif // ANOMALYDETECTOR_H
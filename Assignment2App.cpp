@@ -214,17 +214,13 @@ void Assignment2App::calculateCorrelations() {
         return;
     }
 
-    string s_t = "S_T";
-    string s_r = "S_R";
-    string t_r = "T_R";
-
     // Updated display message to reflect "All Years"
     cout << "\nSample Pearson Correlation Coefficient for Month " << month << " (All Years)" << endl;
 
     // Pass the sentinel year value (0)
-    cout << "S_T: " << weatherData.calculateSPCC(&year, &month, &s_t) << endl;
-    cout << "S_R: " << weatherData.calculateSPCC(&year, &month, &s_r) << endl;
-    cout << "T_R: " << weatherData.calculateSPCC(&year, &month, &t_r) << endl;
+    cout << "S_T: " << weatherData.calculateSPCC<Metric::SolarRadiation, Metric::Temperature>(&year, &month) << endl;
+    cout << "S_R: " << weatherData.calculateSPCC<Metric::SolarRadiation, Metric::WindSpeed>(&year, &month) << endl;
+    cout << "T_R: " << weatherData.calculateSPCC<Metric::Temperature, Metric::WindSpeed>(&year, &month) << endl;
 }
 
 	/**
@@ -0,0 +1,907 @@
+// Benchmark.cpp
+
+// Non-interactive driver that times a full load of the weather data followed by
+// every report the application can produce. It is built with exactly the same
+// flags as the main program and doubles as the training run for profile-guided
+// optimization (see the pgo-train target in CMakeLists.txt).
+
+#include "AnomalyDetector.h"
+#include "Bst.h"
+#include "MergeJoin.h"
+#include "PersistentBst.h"
+#include "RadixSort.h"
+#include "Statistics.h"
+#include "StreamingAggregator.h"
+#include "TaskPool.h"
+#include "WeatherDataCollection.h"
+#include "WindRose.h"
+#include "WriteAheadLog.h"
+#include "YearArchive.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+	/**
+	 * @brief Returns the number of milliseconds elapsed since the given start point.
+	 *
+	 * @param  start - The time point the measurement began at.
+	 * @return double - Elapsed wall-clock time in milliseconds.
+	 */
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+	/**
+	 * @brief Runs every report for every year in the requested range once.
+	 *
+	 * Console output of the reports is swallowed so that only the work itself is measured.
+	 *
+	 * @param  data - The loaded collection to query.
+	 * @param  firstYear - First year to report on.
+	 * @param  lastYear - Last year to report on (inclusive).
+	 * @param  reportFile - Path the CSV reports are written to.
+	 * @return void
+	 */
+static void runReports(const WeatherDataCollection* data, int firstYear, int lastYear, std::string* reportFile) {
+	std::ostringstream sink;
+	std::streambuf* saved = std::cout.rdbuf(sink.rdbuf());
+
+	int allYears = 0;
+
+	for (int year = firstYear; year <= lastYear; ++year) {
+		data->displayMonthlyTemperatures(&year);
+		data->generateMonthlyStats(&year, reportFile);
+		for (int month = 1; month <= 12; ++month) {
+			data->displayAverageWindSpeed(&year, &month);
+		}
+	}
+	for (int month = 1; month <= 12; ++month) {
+		data->calculateSPCC<Metric::SolarRadiation, Metric::Temperature>(&allYears, &month);
+		data->calculateSPCC<Metric::SolarRadiation, Metric::WindSpeed>(&allYears, &month);
+		data->calculateSPCC<Metric::Temperature, Metric::WindSpeed>(&allYears, &month);
+	}
+
+	std::cout.rdbuf(saved);
+}
+
+	/**
+	 * @brief Builds a compressed series for each metric and times month-by-month summaries over it.
+	 *
+	 * @param  data - The loaded collection.
+	 * @param  firstYear - First year to summarize.
+	 * @param  lastYear - Last year to summarize (inclusive).
+	 * @return void
+	 */
+static void runCompressed(const WeatherDataCollection* data, int firstYear, int lastYear) {
+	const char* names[kMetricCount] = {"windSpeed", "temperature", "solarRadiation", "windDirection"};
+
+	for (int m = 0; m < kMetricCount; ++m) {
+		auto start = std::chrono::steady_clock::now();
+		CompressedSeries* series = data->buildCompressedSeries(static_cast<Metric>(m));
+		double buildMs = elapsedMs(start);
+
+		start = std::chrono::steady_clock::now();
+		unsigned long covered = 0;
+		for (int year = firstYear; year <= lastYear; ++year) {
+			for (int month = 1; month <= 12; ++month) {
+				Date first(1, month, year);
+				Date next(1, month == 12 ? 1 : month + 1, month == 12 ? year + 1 : year);
+				covered += series->summarize(first.toMinuteKey(), next.toMinuteKey() - 1).count;
+			}
+		}
+		double queryMs = elapsedMs(start);
+
+		double bitsPerPoint = series->size() ? 8.0 * series->getMemoryBytes() / series->size() : 0.0;
+		std::cout << "compressed " << names[m] << ": " << series->size() << " points in "
+				  << series->getMemoryBytes() << " bytes (" << bitsPerPoint << " bits/point), build "
+				  << buildMs << " ms, " << covered << " points summarized in " << queryMs << " ms" << std::endl;
+		delete series;
+	}
+}
+
+	/**
+	 * @brief Builds the compact column store and times month-by-month summaries over it.
+	 *
+	 * @param  data - The loaded collection.
+	 * @param  firstYear - First year to summarize.
+	 * @param  lastYear - Last year to summarize (inclusive).
+	 * @return void
+	 */
+static void runColumnStore(const WeatherDataCollection* data, int firstYear, int lastYear) {
+	const char* encodings[4] = {"int16", "int32", "float32", "float64"};
+
+	auto start = std::chrono::steady_clock::now();
+	ColumnStore* store = data->buildColumnStore();
+	double buildMs = elapsedMs(start);
+
+	start = std::chrono::steady_clock::now();
+	unsigned long covered = 0;
+	for (int m = 0; m < kMetricCount; ++m) {
+		for (int year = firstYear; year <= lastYear; ++year) {
+			for (int month = 1; month <= 12; ++month) {
+				Date first(1, month, year);
+				Date next(1, month == 12 ? 1 : month + 1, month == 12 ? year + 1 : year);
+				covered += store->summarize(static_cast<Metric>(m), first.toMinuteKey(), next.toMinuteKey() - 1).count;
+			}
+		}
+	}
+	double queryMs = elapsedMs(start);
+
+	double bytesPerRow = store->size() ? static_cast<double>(store->getMemoryBytes()) / store->size() : 0.0;
+	std::cout << "column store: " << store->size() << " rows in " << store->getMemoryBytes() << " bytes ("
+			  << bytesPerRow << " bytes/row; wind " << encodings[store->getEncoding(Metric::WindSpeed)]
+			  << ", temperature " << encodings[store->getEncoding(Metric::Temperature)]
+			  << ", solar " << encodings[store->getEncoding(Metric::SolarRadiation)]
+			  << ", direction " << encodings[store->getEncoding(Metric::WindDirection)] << "), build "
+			  << buildMs << " ms, " << covered << " values summarized in " << queryMs << " ms" << std::endl;
+	delete store;
+}
+
+	/**
+	 * @brief Times appends into the delta tier of a copy of the collection, its compaction,
+	 * and month-by-month summaries merged across both tiers, plus the copy-and-append cycle
+	 * WeatherDataStore runs to publish each new version.
+	 *
+	 * @param  data - The loaded collection.
+	 * @param  firstYear - First year to summarize.
+	 * @param  lastYear - Last year to summarize (inclusive).
+	 * @return void
+	 */
+static void runTiered(const WeatherDataCollection* data, int firstYear, int lastYear) {
+	const int appends = 20000;
+
+	auto start = std::chrono::steady_clock::now();
+	WeatherDataCollection live(*data);
+	double copyMs = elapsedMs(start);
+
+	// Continue the feed every 10 minutes after the last stored reading
+	const ColumnStore* base = live.getBase();
+	int lastKey = (base && base->size() > 0) ? base->getKey(base->size() - 1) : 0;
+	// Each version is copied from the previous one, which stays alive until the copy is changed
+	const int versions = 200;
+	WeatherDataCollection* version = new WeatherDataCollection(*data);
+	start = std::chrono::steady_clock::now();
+	for (int i = 1; i <= versions; ++i) {
+		WeatherDataCollection* next = new WeatherDataCollection(*version);
+		next->addWeatherRecord(new WeatherRecord(Date::fromMinuteKey(lastKey + 10 * i), 5.0, 20.0, 100.0));
+		delete version;
+		version = next;
+	}
+	double publishMs = elapsedMs(start) / versions;
+	delete version;
+
+	start = std::chrono::steady_clock::now();
+	for (int i = 1; i <= appends; ++i) {
+		live.addWeatherRecord(new WeatherRecord(Date::fromMinuteKey(lastKey + 10 * i), 5.0, 20.0, 100.0));
+	}
+	double appendMs = elapsedMs(start);
+
+	start = std::chrono::steady_clock::now();
+	live.compact();
+	double compactMs = elapsedMs(start);
+
+	start = std::chrono::steady_clock::now();
+	unsigned long covered = 0;
+	for (int year = firstYear; year <= lastYear + 1; ++year) {
+		for (int month = 1; month <= 12; ++month) {
+			Date first(1, month, year);
+			Date next(1, month == 12 ? 1 : month + 1, month == 12 ? year + 1 : year);
+			covered += live.summarize(Metric::Temperature, first.toMinuteKey(), next.toMinuteKey() - 1).count;
+		}
+	}
+	double queryMs = elapsedMs(start);
+
+	std::cout << "tiered: copy " << copyMs << " ms, copy + append " << publishMs * 1000.0 << " us per published version, " << appends << " appends in " << appendMs << " ms ("
+			  << appendMs * 1000.0 / appends << " us each), final compaction " << compactMs << " ms, "
+			  << live.getTotalRecords() << " records, " << covered << " values summarized in "
+			  << queryMs << " ms" << std::endl;
+}
+
+	/**
+	 * @brief Times snapshots of a 20000-record delta: deep Bst copies against shared PersistentBst
+	 * copies, each followed by an insert into the original, and checks the snapshots stay unchanged.
+	 * The persistent tree takes its keys in ascending order, as the live delta does.
+	 *
+	 * @param  data - The loaded collection.
+	 * @return void
+	 */
+static void runSnapshots(const WeatherDataCollection* data) {
+	const int records = 20000;
+	const int snapshots = 200;
+	const ColumnStore* base = data->getBase();
+	int lastKey = (base && base->size() > 0) ? base->getKey(base->size() - 1) : 0;
+
+	// Bst does not balance itself, so it is given shuffled keys
+	std::vector<int> offsets(records);
+	for (int i = 0; i < records; ++i) offsets[i] = i + 1;
+	std::mt19937 rng(7);
+	std::shuffle(offsets.begin(), offsets.end(), rng);
+
+	Bst<WeatherRecord> deep;
+	PersistentBst<WeatherRecord> shared;
+	for (int i = 0; i < records; ++i) {
+		deep.insert(new WeatherRecord(Date::fromMinuteKey(lastKey + 10 * offsets[i]), 5.0, 20.0, 100.0));
+		shared.insert(new WeatherRecord(Date::fromMinuteKey(lastKey + 10 * (i + 1)), 5.0, 20.0, 100.0));
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < 5; ++i) {
+		Bst<WeatherRecord> copy(deep);
+	}
+	double deepMs = elapsedMs(start) / 5;
+
+	std::vector<PersistentBst<WeatherRecord>*> kept;
+	start = std::chrono::steady_clock::now();
+	for (int i = 1; i <= snapshots; ++i) {
+		kept.push_back(new PersistentBst<WeatherRecord>(shared));
+		shared.insert(new WeatherRecord(Date::fromMinuteKey(lastKey + 10 * (records + i)), 5.0, 20.0, 100.0));
+	}
+	double sharedMs = elapsedMs(start) / snapshots;
+
+	bool isolated = true;
+	for (int i = 0; i < snapshots; ++i) {
+		isolated = isolated && kept[i]->size() == records + i;
+		delete kept[i];
+	}
+
+	std::cout << "snapshots: " << records << "-record delta, deep copy " << deepMs << " ms, shared copy + insert "
+			  << sharedMs * 1000.0 << " us (" << snapshots << " snapshots " << (isolated ? "unchanged" : "CHANGED")
+			  << ", height " << shared.height() << ")" << std::endl;
+}
+
+	/**
+	 * @brief Traversal helper that adds a record's temperature to a running sum.
+	 *
+	 * @param  record - Pointer to the record.
+	 * @param  sum - Pointer to the sum.
+	 * @return void
+	 */
+static void addTemperature(const WeatherRecord* record, double* sum) {
+	*sum += record->temperature;
+}
+
+	/**
+	 * @brief Sequential form of addTemperature for Bst::inOrder.
+	 *
+	 * @param  record - Pointer to the record.
+	 * @param  context - Pointer to the sum.
+	 * @return void
+	 */
+static void addTemperatureTo(const WeatherRecord* record, void* context) {
+	addTemperature(record, static_cast<double*>(context));
+}
+
+	/**
+	 * @brief Times a full in-order traversal of a tree, sequential versus sliced over the TaskPool.
+	 *
+	 * @param  data - The loaded collection.
+	 * @return void
+	 */
+static void runTraversal(const WeatherDataCollection* data) {
+	const int records = 200000;
+	const ColumnStore* base = data->getBase();
+	int lastKey = (base && base->size() > 0) ? base->getKey(base->size() - 1) : 0;
+
+	std::vector<int> offsets(records);
+	for (int i = 0; i < records; ++i) offsets[i] = i + 1;
+	std::mt19937 rng(11);
+	std::shuffle(offsets.begin(), offsets.end(), rng);
+
+	Bst<WeatherRecord> tree;
+	for (int offset : offsets) {
+		tree.insert(new WeatherRecord(Date::fromMinuteKey(lastKey + 10 * offset), 5.0, offset % 40, 100.0));
+	}
+
+	double sequential = 0.0;
+	auto start = std::chrono::steady_clock::now();
+	tree.inOrder(addTemperatureTo, &sequential);
+	double sequentialMs = elapsedMs(start);
+
+	std::vector<double> sums;
+	start = std::chrono::steady_clock::now();
+	tree.parallelInOrder(addTemperature, &sums);
+	double parallel = 0.0;
+	for (double sum : sums) parallel += sum;
+	double parallelMs = elapsedMs(start);
+
+	std::cout << "traversal: " << records << "-record tree, sequential " << sequentialMs << " ms, "
+			  << sums.size() << " slices " << parallelMs << " ms ("
+			  << (parallel == sequential ? "same sum" : "SUM DIFFERS") << ")" << std::endl;
+}
+
+	/**
+	 * @brief Times retention: dropping the first year, then everything before a point inside the delta.
+	 *
+	 * @param  data - The loaded collection.
+	 * @param  firstYear - First year of the data.
+	 * @return void
+	 */
+static void runRetention(const WeatherDataCollection* data, int firstYear) {
+	const int appends = 1000;
+
+	WeatherDataCollection live(*data);
+	live.setCompactionThreshold(0);
+	const ColumnStore* base = live.getBase();
+	int lastKey = (base && base->size() > 0) ? base->getKey(base->size() - 1) : 0;
+	for (int i = 1; i <= appends; ++i) {
+		live.addWeatherRecord(new WeatherRecord(Date::fromMinuteKey(lastKey + 10 * i), 5.0, 20.0, 100.0));
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	int yearRemoved = live.eraseYear(firstYear);
+	double yearMs = elapsedMs(start);
+
+	Date* cutoff = Date::fromMinuteKey(lastKey + 10 * (appends / 2));
+	start = std::chrono::steady_clock::now();
+	int beforeRemoved = live.eraseBefore(cutoff);
+	double beforeMs = elapsedMs(start);
+	delete cutoff;
+
+	std::cout << "retention: year " << firstYear << " (" << yearRemoved << " records) dropped in " << yearMs
+			  << " ms, " << beforeRemoved << " more before the cutoff in " << beforeMs << " ms, "
+			  << live.getTotalRecords() << " records left (" << live.getDeltaRecordCount() << " in the delta)" << std::endl;
+}
+
+	/**
+	 * @brief Times nearest-timestamp lookups: one floor search per key versus one batch for all keys.
+	 *
+	 * The keys fall every 7 minutes (off the 10-minute grid) across the whole archive.
+	 *
+	 * @param  data - The loaded collection.
+	 * @return void
+	 */
+static void runLookups(const WeatherDataCollection* data) {
+	const ColumnStore* base = data->getBase();
+	if (!base || base->size() == 0) return;
+
+	std::vector<int> keys;
+	for (int key = base->getKey(0); key <= base->getKey(base->size() - 1); key += 7) {
+		keys.push_back(key);
+	}
+
+	WeatherRecord found(new Date(), 0.0, 0.0, 0.0);
+	double checksum = 0.0;
+	auto start = std::chrono::steady_clock::now();
+	for (int key : keys) {
+		if (data->findFloor(key, &found)) checksum += found.temperature;
+	}
+	double singleMs = elapsedMs(start);
+
+	double batchChecksum = 0.0;
+	start = std::chrono::steady_clock::now();
+	data->findFloorBatch(&keys, [](const WeatherRecord* record, void* context) {
+		if (record) *static_cast<double*>(context) += record->temperature;
+	}, &batchChecksum);
+	double batchMs = elapsedMs(start);
+
+	std::cout << "lookups: " << keys.size() << " floor lookups in " << singleMs << " ms one by one, "
+			  << batchMs << " ms batched" << (checksum == batchChecksum ? "" : " (MISMATCH)") << std::endl;
+}
+
+	/**
+	 * @brief Times merge-joins: the archive against a corrected copy, and two metrics of the archive
+	 * paired within 10 minutes.
+	 *
+	 * @param  data - The loaded collection.
+	 * @param  firstYear - First year of the data (left out of the copy).
+	 * @return void
+	 */
+static void runJoin(const WeatherDataCollection* data, int firstYear) {
+	WeatherDataCollection corrected(*data);
+	corrected.eraseYear(firstYear);
+
+	MergeJoin exact(0);
+	auto start = std::chrono::steady_clock::now();
+	DifferenceStats stats = exact.compare(data, &corrected, Metric::Temperature,
+										  std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+	double compareMs = elapsedMs(start);
+
+	MergeJoin near(10);
+	std::vector<double> x, y;
+	start = std::chrono::steady_clock::now();
+	size_t pairs = near.align(data, Metric::SolarRadiation, data, Metric::Temperature,
+							  std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), &x, &y);
+	double spcc = Statistics::calculateSPCC(&x, &y);
+	double alignMs = elapsedMs(start);
+
+	std::cout << "join: " << stats.count << " aligned temperatures compared in " << compareMs << " ms (bias "
+			  << stats.meanDifference << ", spcc " << stats.spcc << "), " << pairs << " solar/temperature pairs "
+			  << "aligned and correlated in " << alignMs << " ms (spcc " << spcc << ")" << std::endl;
+}
+
+	/**
+	 * @brief Times the SPCC of solar radiation and temperature over an array of records: gathered
+	 * into two vectors first, read in place through strided views, and over float spans.
+	 *
+	 * @param  data - The loaded collection.
+	 * @return void
+	 */
+static void runStatisticsViews(const WeatherDataCollection* data) {
+	const ColumnStore* base = data->getBase();
+	if (!base || base->size() < 2) return;
+	const size_t rows = base->size();
+
+	std::vector<double> solar(rows), temperature(rows);
+	base->copyColumn(Metric::SolarRadiation, 0, rows, solar.data());
+	base->copyColumn(Metric::Temperature, 0, rows, temperature.data());
+	std::vector<WeatherRecord> records;
+	records.reserve(rows);
+	for (size_t row = 0; row < rows; ++row) {
+		records.emplace_back(Date::fromMinuteKey(base->getKey(row)), 0.0, temperature[row], solar[row]);
+	}
+	std::vector<float> solarFloat(solar.begin(), solar.end());
+	std::vector<float> temperatureFloat(temperature.begin(), temperature.end());
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<double> x, y;
+	x.reserve(rows);
+	y.reserve(rows);
+	for (const WeatherRecord& record : records) {
+		x.push_back(record.solarRadiation);
+		y.push_back(record.temperature);
+	}
+	double gathered = Statistics::calculateSPCC(&x, &y);
+	double gatheredMs = elapsedMs(start);
+
+	start = std::chrono::steady_clock::now();
+	Statistics::StridedView<double> solarView(&records[0].solarRadiation, rows, sizeof(WeatherRecord));
+	Statistics::StridedView<double> temperatureView(&records[0].temperature, rows, sizeof(WeatherRecord));
+	double strided = Statistics::calculateSPCC(&solarView, &temperatureView);
+	double stridedMs = elapsedMs(start);
+
+	start = std::chrono::steady_clock::now();
+	Statistics::Span<float> solarSpan(solarFloat.data(), rows);
+	Statistics::Span<float> temperatureSpan(temperatureFloat.data(), rows);
+	double narrow = Statistics::calculateSPCC(&solarSpan, &temperatureSpan);
+	double floatMs = elapsedMs(start);
+
+	std::cout << "statistics views: spcc of " << rows << " records, gathered " << gatheredMs << " ms, strided "
+			  << stridedMs << " ms" << (strided == gathered ? "" : " (MISMATCH)") << ", float spans "
+			  << floatMs << " ms (spcc " << strided << ", float " << narrow << ")" << std::endl;
+}
+
+	/**
+	 * @brief Times sorting a shuffled copy of the archive: comparison sort on Dates, then the
+	 * radix sort on packed keys (sequential and parallel), then a bulk load of the shuffled records.
+	 *
+	 * @param  data - The loaded collection.
+	 * @return void
+	 */
+static void runSort(const WeatherDataCollection* data) {
+	std::vector<WeatherRecord*> records;
+	data->forEachInRange(std::numeric_limits<int>::min(), std::numeric_limits<int>::max(),
+						 [](const WeatherRecord* record, void* context) {
+		static_cast<std::vector<WeatherRecord*>*>(context)->push_back(new WeatherRecord(*record));
+	}, &records);
+	std::shuffle(records.begin(), records.end(), std::mt19937(42));
+
+	std::vector<WeatherRecord*> byDate(records);
+	auto start = std::chrono::steady_clock::now();
+	std::stable_sort(byDate.begin(), byDate.end(), [](const WeatherRecord* a, const WeatherRecord* b) {
+		return *a->date < b->date;
+	});
+	double compareMs = elapsedMs(start);
+
+	double radixMs[2];
+	bool agree = true;
+	for (int parallel = 0; parallel < 2; ++parallel) {
+		std::vector<WeatherRecord*> byKey(records);
+		start = std::chrono::steady_clock::now();
+		std::vector<uint32_t> keys(byKey.size());
+		for (size_t i = 0; i < byKey.size(); ++i) {
+			keys[i] = RadixSort::packKey(byKey[i]->date->toMinuteKey());
+		}
+		RadixSort::sortPairs(&keys, &byKey, parallel ? &TaskPool::instance() : nullptr);
+		radixMs[parallel] = elapsedMs(start);
+		agree = agree && byKey == byDate;
+	}
+
+	WeatherDataCollection loaded;
+	start = std::chrono::steady_clock::now();
+	int added = loaded.addWeatherRecords(&records);
+	double loadMs = elapsedMs(start);
+
+	std::cout << "sort: " << byDate.size() << " shuffled records, comparison sort " << compareMs << " ms, radix "
+			  << radixMs[0] << " ms, parallel radix " << radixMs[1] << " ms" << (agree ? "" : " (MISMATCH)")
+			  << "; bulk add of " << added << " in " << loadMs << " ms" << std::endl;
+}
+
+	/**
+	 * @brief Times a checkpoint of the collection, group-committed appends from several
+	 * threads, and recovery from the snapshot plus the log.
+	 *
+	 * @param  data - The loaded collection.
+	 * @param  loadMs - Time the collection took to load from the CSVs, for comparison.
+	 * @return void
+	 */
+static void runDurability(const WeatherDataCollection* data, double loadMs) {
+	std::string logPath = "bench_wal.log";
+	std::string snapshotPath = "bench_snapshot.bin";
+	const int writers = 4;
+	const int batches = 250;
+	const int batchSize = 20;
+
+	WriteAheadLog* log = new WriteAheadLog(&logPath);
+
+	auto start = std::chrono::steady_clock::now();
+	log->checkpoint(data, &snapshotPath);
+	double checkpointMs = elapsedMs(start);
+
+	const ColumnStore* base = data->getBase();
+	int lastKey = (base && base->size() > 0) ? base->getKey(base->size() - 1) : 0;
+	start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for (int w = 0; w < writers; ++w) {
+		threads.emplace_back([log, lastKey, w] {
+			for (int b = 0; b < batches; ++b) {
+				std::vector<WeatherRecord*> batch;
+				for (int i = 0; i < batchSize; ++i) {
+					int n = (w * batches + b) * batchSize + i + 1;
+					batch.push_back(new WeatherRecord(Date::fromMinuteKey(lastKey + 10 * n), 5.0, 20.0, 100.0));
+				}
+				log->append(&batch);
+				for (WeatherRecord* record : batch) delete record;
+			}
+		});
+	}
+	for (std::thread& t : threads) t.join();
+	double appendMs = elapsedMs(start);
+	unsigned long logged = log->getRecordCount();
+	unsigned long syncs = log->getSyncCount();
+	delete log; // As if the process had crashed here
+
+	start = std::chrono::steady_clock::now();
+	WriteAheadLog reopened(&logPath);
+	WeatherDataCollection recovered;
+	reopened.recover(&snapshotPath, &recovered);
+	double recoverMs = elapsedMs(start);
+
+	std::cout << "wal: checkpoint " << checkpointMs << " ms; " << logged << " records in "
+			  << writers * batches << " appends from " << writers << " threads, " << appendMs << " ms with "
+			  << syncs << " syncs; recovery " << recoverMs << " ms to " << recovered.getTotalRecords()
+			  << " records (CSV load " << loadMs << " ms)" << std::endl;
+
+	std::remove(logPath.c_str());
+	std::remove(snapshotPath.c_str());
+}
+
+	/**
+	 * @brief Times z-score lookups against the day/hour climatology for every hour of a year.
+	 *
+	 * @param  data - The loaded collection.
+	 * @return void
+	 */
+static void runClimatology(const WeatherDataCollection* data) {
+	const ClimatologyIndex* climatology = data->getClimatology();
+
+	auto start = std::chrono::steady_clock::now();
+	unsigned long lookups = 0;
+	double total = 0.0;
+	for (int day = 0; day < ClimatologyIndex::kDays; ++day) {
+		for (int hour = 0; hour < ClimatologyIndex::kHours; ++hour) {
+			ClimateNormal normal = climatology->getNormal(Metric::Temperature, day, hour);
+			total += normal.mean;
+			++lookups;
+		}
+	}
+	double lookupMs = elapsedMs(start);
+
+	Date valentines(14, 2, 2000, 15, 0);
+	ClimateNormal normal = climatology->getNormal(Metric::Temperature, &valentines);
+	std::cout << "climatology: " << lookups << " normals in " << lookupMs << " ms (average "
+			  << total / lookups << "); 14 February 15:00 temperature "
+			  << normal.mean << " (stdev " << normal.stdDev << ", " << normal.count << " readings)" << std::endl;
+}
+
+	/**
+	 * @brief Times climatological and rolling z-score scans of the whole archive, one metric at a time.
+	 *
+	 * @param  data - The loaded collection.
+	 * @return void
+	 */
+static void runAnomalies(const WeatherDataCollection* data) {
+	const Metric metrics[] = {Metric::WindSpeed, Metric::Temperature, Metric::SolarRadiation};
+	const char* names[] = {"wind", "temperature", "solar"};
+	AnomalyDetector detectors[] = {AnomalyDetector(4.0, AnomalyDetector::Climatological),
+								   AnomalyDetector(6.0, AnomalyDetector::Rolling, 144)};
+
+	std::cout << "anomalies:";
+	for (int d = 0; d < 2; ++d) {
+		std::cout << (d == 0 ? " climatological |z| > 4:" : "; rolling (1 day) |z| > 6:");
+		for (int m = 0; m < 3; ++m) {
+			std::vector<Anomaly> flagged;
+			auto start = std::chrono::steady_clock::now();
+			size_t count = detectors[d].scan(data, metrics[m], std::numeric_limits<int>::min(),
+											 std::numeric_limits<int>::max(), &flagged);
+			std::cout << " " << names[m] << " " << count << " in " << elapsedMs(start) << " ms";
+		}
+	}
+	std::cout << std::endl;
+}
+
+	/**
+	 * @brief Times a wind rose of the whole archive, one per calendar month across all years,
+	 * and one per month of every year.
+	 *
+	 * @param  data - The loaded collection.
+	 * @param  firstYear - First year to report on.
+	 * @param  lastYear - Last year to report on (inclusive).
+	 * @return void
+	 */
+static void runWindRose(const WeatherDataCollection* data, int firstYear, int lastYear) {
+	const int all = std::numeric_limits<int>::max();
+
+	WindRose archive;
+	auto start = std::chrono::steady_clock::now();
+	archive.add(data, std::numeric_limits<int>::min(), all);
+	double archiveMs = elapsedMs(start);
+
+	start = std::chrono::steady_clock::now();
+	unsigned long byMonth = 0;
+	for (int month = 1; month <= 12; ++month) {
+		WindRose rose;
+		byMonth += rose.add(data, std::numeric_limits<int>::min(), all, month);
+	}
+	double byMonthMs = elapsedMs(start);
+
+	start = std::chrono::steady_clock::now();
+	unsigned long reports = 0;
+	unsigned long covered = 0;
+	std::ostringstream sink;
+	for (int year = firstYear; year <= lastYear; ++year) {
+		for (int month = 1; month <= 12; ++month) {
+			Date first(1, month, year);
+			Date next(1, month == 12 ? 1 : month + 1, month == 12 ? year + 1 : year);
+			WindRose rose;
+			covered += rose.add(data, first.toMinuteKey(), next.toMinuteKey() - 1);
+			rose.writeTable(&sink);
+			++reports;
+		}
+	}
+	double reportsMs = elapsedMs(start);
+
+	int busiest = 0;
+	unsigned long busiestCount = 0;
+	for (int s = 0; s < archive.getSectors(); ++s) {
+		unsigned long n = 0;
+		for (int c = 0; c < archive.getSpeedClasses(); ++c) {
+			n += archive.getCount(s, c);
+		}
+		if (n > busiestCount) {
+			busiest = s;
+			busiestCount = n;
+		}
+	}
+
+	std::cout << "wind rose: " << archive.getTotal() << " readings in " << archiveMs << " ms (prevailing "
+			  << archive.getSectorName(busiest) << ", " << (archive.getTotal() ? 100.0 * archive.getCalm() / archive.getTotal() : 0.0)
+			  << "% calm), 12 calendar months (" << byMonth << " readings) in " << byMonthMs << " ms, "
+			  << reports << " monthly tables (" << covered << " readings) in " << reportsMs << " ms" << std::endl;
+}
+
+	/**
+	 * @brief Times approximate (sampled) and exact monthly temperature means and wind/temperature SPCCs,
+	 * and reports the largest error and how often the 95% interval held the exact answer.
+	 *
+	 * @param  data - The loaded collection.
+	 * @param  firstYear - First year to report on.
+	 * @param  lastYear - Last year to report on (inclusive).
+	 * @return void
+	 */
+static void runApproximate(const WeatherDataCollection* data, int firstYear, int lastYear) {
+	std::vector<Estimate> approximate[2];
+	std::vector<Estimate> exact[2];
+	double ms[2][2] = {{0.0, 0.0}, {0.0, 0.0}};
+
+	for (int pass = 0; pass < 2; ++pass) {
+		bool useAll = pass == 1;
+		std::vector<Estimate>* out = useAll ? exact : approximate;
+		auto start = std::chrono::steady_clock::now();
+		for (int year = firstYear; year <= lastYear; ++year) {
+			for (int month = 1; month <= 12; ++month) {
+				out[0].push_back(data->estimateMean(Metric::Temperature, &year, &month, useAll));
+			}
+		}
+		ms[pass][0] = elapsedMs(start);
+
+		start = std::chrono::steady_clock::now();
+		for (int year = firstYear; year <= lastYear; ++year) {
+			for (int month = 1; month <= 12; ++month) {
+				out[1].push_back(data->estimateSPCC(Metric::WindSpeed, Metric::Temperature, &year, &month, useAll));
+			}
+		}
+		ms[pass][1] = elapsedMs(start);
+	}
+
+	const char* names[] = {"temperature mean", "S_T spcc"};
+	std::cout << "approximate:";
+	for (int q = 0; q < 2; ++q) {
+		double worst = 0.0;
+		unsigned long covered = 0;
+		unsigned long answered = 0;
+		for (size_t i = 0; i < exact[q].size(); ++i) {
+			if (exact[q][i].population == 0) continue;
+			const Estimate& e = approximate[q][i];
+			double truth = exact[q][i].value;
+			worst = std::max(worst, std::fabs(e.value - truth));
+			covered += (truth >= e.lower - 1e-9 && truth <= e.upper + 1e-9) ? 1 : 0;
+			++answered;
+		}
+		std::cout << (q == 0 ? " " : "; ") << answered << " " << names[q] << "s sampled in " << ms[0][q]
+				  << " ms vs exact " << ms[1][q] << " ms (max error " << worst << ", "
+				  << (answered ? 100.0 * covered / answered : 0.0) << "% inside the 95% interval)";
+	}
+	std::cout << std::endl;
+}
+
+	/**
+	 * @brief Copies the collection into a year archive with a budget of a third of its size, then times
+	 * monthly summaries of every year twice over, which evicts and reloads years, and checks them against the collection.
+	 *
+	 * @param  data - The loaded collection.
+	 * @param  firstYear - First year to report on.
+	 * @param  lastYear - Last year to report on (inclusive).
+	 * @return void
+	 */
+static void runArchive(const WeatherDataCollection* data, int firstYear, int lastYear) {
+	std::string directory = ".";
+	YearArchive archive(&directory, std::numeric_limits<size_t>::max());
+
+	auto start = std::chrono::steady_clock::now();
+	size_t copied = archive.addCollection(data);
+	double buildMs = elapsedMs(start);
+	size_t fullBytes = archive.getStats().residentBytes;
+	archive.setBudget(fullBytes / 3);
+
+	start = std::chrono::steady_clock::now();
+	unsigned long queries = 0;
+	unsigned long mismatches = 0;
+	for (int pass = 0; pass < 2; ++pass) {
+		for (int year = firstYear; year <= lastYear; ++year) {
+			for (int month = 1; month <= 12; ++month) {
+				Date first(1, month, year);
+				Date next(1, month == 12 ? 1 : month + 1, month == 12 ? year + 1 : year);
+				SeriesSummary archived;
+				bool answered = archive.summarize(Metric::Temperature, first.toMinuteKey(), next.toMinuteKey() - 1, &archived);
+				SeriesSummary live = data->summarize(Metric::Temperature, first.toMinuteKey(), next.toMinuteKey() - 1);
+				mismatches += (!answered || archived.count != live.count || std::fabs(archived.sum - live.sum) > 1e-6) ? 1 : 0;
+				++queries;
+			}
+		}
+	}
+	double queryMs = elapsedMs(start);
+
+	ArchiveStats stats = archive.getStats();
+	std::cout << "year archive: " << copied << " records in " << stats.years << " years (" << fullBytes
+			  << " bytes) built in " << buildMs << " ms; budget " << stats.budgetBytes << " bytes, "
+			  << queries << " monthly summaries in " << queryMs << " ms (" << mismatches << " mismatches), "
+			  << stats.evictions << " evictions, " << stats.reloads << " reloads, " << stats.writes
+			  << " segments written, " << stats.residentYears << " years resident" << std::endl;
+}
+
+	/**
+	 * @brief Reads a whole file into a string.
+	 *
+	 * @param  filename - The file to read.
+	 * @return std::string - The contents (empty if the file cannot be read).
+	 */
+static std::string readFile(const std::string& filename) {
+	std::ifstream in(filename);
+	std::ostringstream contents;
+	contents << in.rdbuf();
+	return contents.str();
+}
+
+	/**
+	 * @brief Times the streaming aggregation and checks its reports against the in-memory ones.
+	 *
+	 * @param  data - The loaded collection.
+	 * @param  listFile - The list file the collection was loaded from.
+	 * @param  firstYear - First year to report on.
+	 * @param  lastYear - Last year to report on (inclusive).
+	 * @param  reportFile - Path the CSV reports are written to.
+	 * @return void
+	 */
+static void runStreaming(const WeatherDataCollection* data, std::string* listFile, int firstYear, int lastYear,
+						 std::string* reportFile) {
+	StreamingAggregator aggregator;
+
+	auto start = std::chrono::steady_clock::now();
+	aggregator.aggregateFiles(listFile);
+	double aggregateMs = elapsedMs(start);
+
+	int matching = 0;
+	for (int year = firstYear; year <= lastYear; ++year) {
+		data->generateMonthlyStats(&year, reportFile);
+		std::string expected = readFile(*reportFile);
+		aggregator.writeMonthlyStats(&year, reportFile);
+		if (readFile(*reportFile) == expected) ++matching;
+	}
+
+	std::cout << "streaming: " << aggregator.getRecordCount() << " records aggregated in " << aggregateMs
+			  << " ms, " << matching << "/" << (lastYear - firstYear + 1)
+			  << " yearly reports identical to the in-memory ones" << std::endl;
+}
+
+	/**
+	 * @brief Entry point of the benchmark.
+	 *
+	 * Usage: weather_bench [listFile] [repetitions] [firstYear] [lastYear] [threads]
+	 * The list file uses the same format as the interactive loader (CSV names relative to data/).
+	 * threads sets the TaskPool worker count (0 or omitted for the hardware default).
+	 *
+	 * @param  argc - Argument count.
+	 * @param  argv - Argument values.
+	 * @return int - 0 on success, 1 if nothing could be loaded.
+	 */
+int main(int argc, char* argv[]) {
+	std::string listFile = argc > 1 ? argv[1] : "data/data_source.txt";
+	int repetitions = argc > 2 ? std::atoi(argv[2]) : 1;
+	int firstYear = argc > 3 ? std::atoi(argv[3]) : 2010;
+	int lastYear = argc > 4 ? std::atoi(argv[4]) : 2016;
+	int threads = argc > 5 ? std::atoi(argv[5]) : 0;
+	std::string reportFile = "bench_report.csv";
+
+	TaskPool::configure(threads);
+
+	if (repetitions < 1) repetitions = 1;
+
+	for (int rep = 0; rep < repetitions; ++rep) {
+		WeatherDataCollection data;
+
+		auto start = std::chrono::steady_clock::now();
+		data.loadFromFiles(&listFile);
+		double loadMs = elapsedMs(start);
+
+		if (data.getTotalRecords() == 0) {
+			std::cerr << "No records loaded from " << listFile << std::endl;
+			return 1;
+		}
+
+		start = std::chrono::steady_clock::now();
+		runReports(&data, firstYear, lastYear, &reportFile);
+		double reportMs = elapsedMs(start);
+
+		std::cout << "run " << (rep + 1) << ": records " << data.getTotalRecords()
+				  << ", load " << loadMs << " ms, reports " << reportMs << " ms" << std::endl;
+
+		if (rep == 0) {
+			runCompressed(&data, firstYear, lastYear);
+			runColumnStore(&data, firstYear, lastYear);
+			runTiered(&data, firstYear, lastYear);
+			runSnapshots(&data);
+			runTraversal(&data);
+			runRetention(&data, firstYear);
+			runLookups(&data);
+			runJoin(&data, firstYear);
+			runStatisticsViews(&data);
+			runSort(&data);
+			runDurability(&data, loadMs);
+			runStreaming(&data, &listFile, firstYear, lastYear, &reportFile);
+			runClimatology(&data);
+			runAnomalies(&data);
+			runWindRose(&data, firstYear, lastYear);
+			runApproximate(&data, firstYear, lastYear);
+			runArchive(&data, firstYear, lastYear);
+		}
+	}
+
+	std::cout << "task pool: " << TaskPool::instance().getThreadCount() << " workers" << std::endl;
+	for (const TaskTiming& t : TaskPool::instance().getTimings()) {
+		std::cout << "  " << t.name << ": " << t.count << " tasks, total " << t.totalMs
+				  << " ms, max " << t.maxMs << " ms" << std::endl;
+	}
+
+	std::remove(reportFile.c_str());
+	return 0;
+}
@@ -0,0 +1,274 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+/// @class BoundedQueue
+/// @brief Fixed-capacity lock-free multi-producer/multi-consumer queue.
+///
+/// Each cell carries a sequence number that tells producers and consumers whether
+/// it is free or full for the current lap around the ring, so push and pop only
+/// need one compare-and-swap on the shared position counter. The capacity is
+/// rounded up to a power of two. Blocking push/pop yield for a bounded number of
+/// retries and then sleep on a condition variable until another thread pops or pushes,
+/// so a stalled stage does not keep a core busy. Only the slow path takes the mutex:
+/// a successful push or pop checks a waiter count and signals only when someone sleeps.
+template <class T>
+class BoundedQueue {
+private:
+	/// @struct Cell
+	/// @brief One ring slot: its lap sequence number and the stored value.
+	struct Cell {
+		std::atomic<size_t> sequence; ///< Lap marker used to detect free/full.
+		T value;                      ///< The stored element.
+	};
+
+	Cell* cells;                                ///< Ring storage.
+	size_t mask;                                ///< Capacity - 1 (capacity is a power of two).
+	alignas(64) std::atomic<size_t> enqueuePos; ///< Next position producers claim.
+	alignas(64) std::atomic<size_t> dequeuePos; ///< Next position consumers claim.
+	alignas(64) std::atomic<int> waiters;       ///< Threads asleep (or about to sleep) in push or pop.
+	std::mutex waitMutex;                       ///< Guards the sleep in push and pop.
+	std::condition_variable changed;            ///< Signalled after a push or pop while waiters > 0.
+
+	/**
+	 * @brief Claims a free cell and stores the value, without signalling sleepers.
+	 * @param value The value to append.
+	 * @return bool True if appended, false if the queue was full.
+	 */
+	bool claimPush(const T& value);
+
+	/**
+	 * @brief Claims the oldest full cell and takes its value, without signalling sleepers.
+	 * @param value Receives the removed value on success.
+	 * @return bool True if a value was removed, false if the queue was empty.
+	 */
+	bool claimPop(T& value);
+
+	/**
+	 * @brief Retries an operation, yielding a bounded number of times and then sleeping until the queue changes.
+	 * @param attempt Callable returning true once the operation succeeded.
+	 */
+	template <class Attempt>
+	void retry(Attempt attempt);
+
+	/**
+	 * @brief Wakes sleeping threads after a successful push or pop.
+	 */
+	void signal();
+
+	BoundedQueue(const BoundedQueue<T>&) = delete;
+	BoundedQueue<T>& operator=(const BoundedQueue<T>&) = delete;
+
+public:
+	/**
+	 * @brief Constructs a queue holding at least the requested number of elements.
+	 * @param capacity The minimum capacity (rounded up to a power of two, at least 2).
+	 */
+	explicit BoundedQueue(size_t capacity);
+
+	/**
+	 * @brief Destructor. Releases the ring storage (elements are not deleted).
+	 */
+	~BoundedQueue();
+
+	/**
+	 * @brief Attempts to append a value without waiting.
+	 * @param value The value to append.
+	 * @return bool True if appended, false if the queue was full.
+	 */
+	bool tryPush(const T& value);
+
+	/**
+	 * @brief Attempts to remove the oldest value without waiting.
+	 * @param value Receives the removed value on success.
+	 * @return bool True if a value was removed, false if the queue was empty.
+	 */
+	bool tryPop(T& value);
+
+	/**
+	 * @brief Appends a value, waiting while the queue is full.
+	 * @param value The value to append.
+	 */
+	void push(const T& value);
+
+	/**
+	 * @brief Removes the oldest value, waiting while the queue is empty.
+	 * @return T The removed value.
+	 */
+	T pop();
+
+	/**
+	 * @brief Gets the capacity of the ring.
+	 * @return size_t The number of cells.
+	 */
+	size_t capacity() const { return mask + 1; }
+};
+
+// Template implementation
+
+/**
+ * @brief Constructor implementation. Rounds the capacity up and stamps each cell with its index.
+ * @param capacity The minimum capacity.
+ */
+template <class T>
+BoundedQueue<T>::BoundedQueue(size_t capacity) : enqueuePos(0), dequeuePos(0), waiters(0) {
+	size_t size = 2;
+	while (size < capacity) size <<= 1;
+	cells = new Cell[size];
+	mask = size - 1;
+	for (size_t i = 0; i < size; ++i) {
+		cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+/**
+ * @brief Destructor implementation.
+ */
+template <class T>
+BoundedQueue<T>::~BoundedQueue() {
+	delete[] cells;
+}
+
+/**
+ * @brief Claims the next free cell for a producer, or reports the queue as full.
+ * @param value The value to append.
+ * @return bool True if appended.
+ */
+template <class T>
+bool BoundedQueue<T>::claimPush(const T& value) {
+	size_t pos = enqueuePos.load(std::memory_order_relaxed);
+	for (;;) {
+		Cell* cell = &cells[pos & mask];
+		size_t seq = cell->sequence.load(std::memory_order_acquire);
+		std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+		if (diff == 0) {
+			if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				cell->value = value;
+				cell->sequence.store(pos + 1, std::memory_order_release);
+				return true;
+			}
+		} else if (diff < 0) {
+			return false; // The consumer has not emptied this cell from the previous lap
+		} else {
+			pos = enqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+/**
+ * @brief Claims the oldest full cell for a consumer, or reports the queue as empty.
+ * @param value Receives the removed value.
+ * @return bool True if a value was removed.
+ */
+template <class T>
+bool BoundedQueue<T>::claimPop(T& value) {
+	size_t pos = dequeuePos.load(std::memory_order_relaxed);
+	for (;;) {
+		Cell* cell = &cells[pos & mask];
+		size_t seq = cell->sequence.load(std::memory_order_acquire);
+		std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+		if (diff == 0) {
+			if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				value = cell->value;
+				cell->sequence.store(pos + mask + 1, std::memory_order_release);
+				return true;
+			}
+		} else if (diff < 0) {
+			return false; // No producer has filled this cell yet
+		} else {
+			pos = dequeuePos.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+/**
+ * @brief Non-blocking push implementation.
+ * @param value The value to append.
+ * @return bool True if appended.
+ */
+template <class T>
+bool BoundedQueue<T>::tryPush(const T& value) {
+	if (!claimPush(value)) return false;
+	signal();
+	return true;
+}
+
+/**
+ * @brief Non-blocking pop implementation.
+ * @param value Receives the removed value.
+ * @return bool True if a value was removed.
+ */
+template <class T>
+bool BoundedQueue<T>::tryPop(T& value) {
+	if (!claimPop(value)) return false;
+	signal();
+	return true;
+}
+
+/**
+ * @brief Signals the sleepers, if any. The fence pairs with the one in retry(), so either
+ * this thread sees the waiter or the waiter's re-check sees this push or pop.
+ */
+template <class T>
+void BoundedQueue<T>::signal() {
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (waiters.load(std::memory_order_relaxed) > 0) {
+		std::lock_guard<std::mutex> lock(waitMutex);
+		changed.notify_all();
+	}
+}
+
+/**
+ * @brief Spins with yield, then registers as a waiter and re-checks under the mutex before each sleep.
+ * A success while holding the mutex notifies directly, since signal() would take it again.
+ * @param attempt Callable returning true once the claim succeeded.
+ */
+template <class T>
+template <class Attempt>
+void BoundedQueue<T>::retry(Attempt attempt) {
+	const int kSpins = 64;
+	for (int spin = 0; spin < kSpins; ++spin) {
+		if (attempt()) {
+			signal();
+			return;
+		}
+		std::this_thread::yield();
+	}
+
+	std::unique_lock<std::mutex> lock(waitMutex);
+	waiters.fetch_add(1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	while (!attempt()) {
+		changed.wait(lock);
+	}
+	if (waiters.fetch_sub(1, std::memory_order_relaxed) > 1) {
+		changed.notify_all();
+	}
+}
+
+/**
+ * @brief Blocking push implementation.
+ * @param value The value to append.
+ */
+template <class T>
+void BoundedQueue<T>::push(const T& value) {
+	retry([this, &value] { return claimPush(value); });
+}
+
+/**
+ * @brief Blocking pop implementation.
+ * @return T The removed value.
+ */
+template <class T>
+T BoundedQueue<T>::pop() {
+	T value;
+	retry([this, &value] { return claimPop(value); });
+	return value;
+}
+
+#endif // BOUNDEDQUEUE_H
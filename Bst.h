@@ -1,8 +1,12 @@
 #ifndef BST_H
 #define BST_H
 
+#include "TaskPool.h"
+#include "TreeSlices.h"
+#include <algorithm>
 #include <iostream>
 #include <functional>
+#include <vector>
 
 /// @class Node
 /// @brief Template node class for Binary Search Tree
@@ -12,12 +16,13 @@ public:
 	T* data;  ///< Store pointer to the data element.
 	Node<T>* left;  ///< Pointer to the left child node.
 	Node<T>* right;  ///< Pointer to the right child node.
+	int subtreeSize;  ///< Number of nodes in the subtree rooted here, this one included.
 
 	/**
 	 * @brief Constructs a Node, taking ownership of the provided data pointer.
 	 * @param value The pointer to the data element.
 	 */
-	Node(T* value) : data(value), left(nullptr), right(nullptr) {}
+	Node(T* value) : data(value), left(nullptr), right(nullptr), subtreeSize(1) {}
 
 	/**
 	 * @brief Destructor. Deletes the owned data element.
@@ -27,6 +32,9 @@ public:
 
 /// @class Bst
 /// @brief Template Binary Search Tree with function pointers for traversal
+///
+/// Every node records the size of its subtree, so size() is O(1) and the in-order
+/// sequence can be sliced by rank for parallelInOrder().
 template <class T>
 class Bst {
 private:
@@ -37,9 +45,10 @@ private:
 	 * @brief Recursively inserts a new node containing the value.
 	 * @param node The current node being examined.
 	 * @param value The pointer to the data value to insert.
+	 * @param inserted Set to true if a node was created, false if an equal value was already present.
 	 * @return Node<T>* The updated root of the subtree.
 	 */
-	Node<T>* insertRec(Node<T>* node, T* value);
+	Node<T>* insertRec(Node<T>* node, T* value, bool* inserted);
 
 	/**
 	 * @brief Recursively searches for a node containing the value.
@@ -105,6 +114,50 @@ private:
 	 */
 	Node<T>* copyTreeRec(Node<T>* node);
 
+	/**
+	 * @brief Recursively splits a subtree in two along a monotone predicate.
+	 *
+	 * Only the nodes on one root-to-leaf path are visited; every other subtree is
+	 * relinked whole.
+	 * @param node The root of the subtree to split.
+	 * @param goesLeft Predicate that is true for a prefix of the in-order sequence.
+	 * @param right Receives the root of the nodes for which goesLeft is false.
+	 * @return Node<T>* The root of the nodes for which goesLeft is true.
+	 */
+	template <class Pred>
+	Node<T>* splitRec(Node<T>* node, Pred goesLeft, Node<T>** right);
+
+	/**
+	 * @brief Joins two trees whose values are all ordered left before right.
+	 * @param left The root of the tree holding the smaller values.
+	 * @param right The root of the tree holding the larger values.
+	 * @return Node<T>* The root of the joined tree.
+	 */
+	Node<T>* join(Node<T>* left, Node<T>* right);
+
+	/**
+	 * @brief Recursively deletes a detached subtree, reporting each value before it is freed.
+	 * @param node The root of the subtree.
+	 * @param onErase Function applied to each value before deletion (may be nullptr).
+	 * @param context Opaque pointer passed to onErase.
+	 * @return int The number of nodes deleted.
+	 */
+	int releaseRec(Node<T>* node, void (*onErase)(const T*, void*), void* context);
+
+	/**
+	 * @brief Recursively resolves the floors of a sorted run of keys in one shared descent.
+	 * @param node The current node being examined.
+	 * @param keys The keys, ascending.
+	 * @param begin The first key handled by this subtree.
+	 * @param end One past the last key handled by this subtree.
+	 * @param keyOf Function returning the key of a value.
+	 * @param best The floor found on the path so far (nullptr if none).
+	 * @param out Receives the floor node of each key.
+	 */
+	template <class K, class KeyOf>
+	void floorBatchRec(Node<T>* node, const K* keys, size_t begin, size_t end, KeyOf keyOf,
+					   Node<T>* best, Node<T>** out) const;
+
 public:
 	/**
 	 * @brief Default constructor. Initializes an empty tree.
@@ -130,10 +183,11 @@ public:
 	Bst<T>& operator=(const Bst<T>& other);
 
 	/**
-	 * @brief Inserts a data value into the BST. Takes ownership of the pointer.
+	 * @brief Inserts a data value into the BST. Takes ownership of the pointer if inserted.
 	 * @param value The pointer to the data value to insert.
+	 * @return bool True if inserted, false if an equal value was already present (the caller keeps ownership).
 	 */
-	void insert(T* value);
+	bool insert(T* value);
 
 	/**
 	 * @brief Searches for a data value in the BST.
@@ -142,6 +196,62 @@ public:
 	 */
 	Node<T>* search(T* value) const;
 
+	/**
+	 * @brief Removes every value inside a range and frees it.
+	 *
+	 * The tree is split at both ends of the range, the middle part is released as a whole
+	 * and the outer parts are joined again, so the cost is the height of the tree plus the
+	 * number of values removed rather than one search per value.
+	 * @param below Predicate that is true for values ordered before the range.
+	 * @param above Predicate that is true for values ordered after the range.
+	 * @param onErase Function applied to each removed value before it is deleted (may be nullptr).
+	 * @param context Opaque pointer passed to onErase.
+	 * @return int The number of values removed.
+	 */
+	template <class Below, class Above>
+	int eraseRange(Below below, Above above, void (*onErase)(const T*, void*) = nullptr, void* context = nullptr);
+
+	/**
+	 * @brief Removes every value v with first <= v <= last and frees it.
+	 * @param first A pointer to the lower bound (inclusive).
+	 * @param last A pointer to the upper bound (inclusive).
+	 * @return int The number of values removed.
+	 */
+	int eraseRange(const T* first, const T* last);
+
+	/**
+	 * @brief Finds the largest value whose key is not greater than a key.
+	 *
+	 * The key is compared with keyOf(value) directly, so no probe value has to be built.
+	 * @param key The key.
+	 * @param keyOf Function returning the key of a value; must order keys as the tree orders values.
+	 * @return Node<T>* The node holding the floor, or nullptr if every key is greater.
+	 */
+	template <class K, class KeyOf>
+	Node<T>* floor(const K& key, KeyOf keyOf) const;
+
+	/**
+	 * @brief Finds the smallest value whose key is not less than a key.
+	 * @param key The key.
+	 * @param keyOf Function returning the key of a value; must order keys as the tree orders values.
+	 * @return Node<T>* The node holding the ceiling, or nullptr if every key is smaller.
+	 */
+	template <class K, class KeyOf>
+	Node<T>* ceil(const K& key, KeyOf keyOf) const;
+
+	/**
+	 * @brief Finds the floor of each of a sorted array of keys.
+	 *
+	 * The keys are partitioned at every node on the way down, so each node is visited at
+	 * most once for the whole batch instead of once per key.
+	 * @param keys The keys, ascending.
+	 * @param count The number of keys.
+	 * @param keyOf Function returning the key of a value.
+	 * @param out Receives count nodes (nullptr where a key has no floor).
+	 */
+	template <class K, class KeyOf>
+	void floorBatch(const K* keys, size_t count, KeyOf keyOf, Node<T>** out) const;
+
 	// Traversal methods with function pointers
 	/**
 	 * @brief Initiates an in-order traversal, applying the visit function to each node.
@@ -169,6 +279,20 @@ public:
 	 */
 	void inOrder(void (*visit)(const T*, void*), void* context) const;
 
+	/**
+	 * @brief Visits every value in key order, split into equal slices visited in parallel.
+	 *
+	 * Slice s of the in-order sequence is visited with &(*results)[s] on a pool thread, so
+	 * per-slice results need no locking and combine in key order front to back.
+	 * @tparam Result The per-slice result type.
+	 * @param visit The function applied to each value with its slice's result.
+	 * @param results The per-slice results (if empty, sized to one slice per thread).
+	 * @param pool The pool, or nullptr to visit on the calling thread.
+	 */
+	template <class Result>
+	void parallelInOrder(void (*visit)(const T*, Result*), std::vector<Result>* results,
+						 TaskPool* pool = &TaskPool::instance()) const;
+
 	// Simple traversals (for backward compatibility)
 	/**
 	 * @brief Simple in-order traversal that prints the data (requires operator<< for T).
@@ -210,13 +334,6 @@ public:
 	int height() const;
 
 private:
-	/**
-	 * @brief Recursively calculates the size of the subtree rooted at node.
-	 * @param node The root of the subtree.
-	 * @return int The size of the subtree.
-	 */
-	int sizeRec(Node<T>* node) const;
-
 	/**
 	 * @brief Recursively calculates the height of the subtree rooted at node.
 	 * @param node The root of the subtree.
@@ -278,6 +395,7 @@ Node<T>* Bst<T>::copyTreeRec(Node<T>* node) {
 	Node<T>* newNode = new Node<T>(newData);
 	newNode->left = copyTreeRec(node->left);
 	newNode->right = copyTreeRec(node->right);
+	newNode->subtreeSize = node->subtreeSize;
 	return newNode;
 }
 
@@ -298,29 +416,35 @@ void Bst<T>::deleteTreeRec(Node<T>* node) {
  * @brief Recursively inserts a new node containing the value.
  * @param node The current node being examined.
  * @param value The pointer to the data value to insert.
+ * @param inserted Set to true if a node was created.
  * @return Node<T>* The updated root of the subtree.
  */
 template <class T>
-Node<T>* Bst<T>::insertRec(Node<T>* node, T* value) {
+Node<T>* Bst<T>::insertRec(Node<T>* node, T* value, bool* inserted) {
 	if (node == nullptr) {
+		*inserted = true;
 		return new Node<T>(value);
 	}
 
 	if (*value < *(node->data)) {  // Dereference for comparison
-		node->left = insertRec(node->left, value);
+		node->left = insertRec(node->left, value, inserted);
 	} else if (*value > *(node->data)) {  // Dereference for comparison
-		node->right = insertRec(node->right, value);
+		node->right = insertRec(node->right, value, inserted);
 	}
+	if (*inserted) node->subtreeSize += 1;
 	return node;
 }
 
 /**
- * @brief Inserts a data value into the BST. Takes ownership of the pointer.
+ * @brief Inserts a data value into the BST. Takes ownership of the pointer if inserted.
  * @param value The pointer to the data value to insert.
+ * @return bool True if inserted, false if an equal value was already present.
  */
 template <class T>
-void Bst<T>::insert(T* value) {
-	root = insertRec(root, value);
+bool Bst<T>::insert(T* value) {
+	bool inserted = false;
+	root = insertRec(root, value, &inserted);
+	return inserted;
 }
 
 /**
@@ -352,6 +476,190 @@ Node<T>* Bst<T>::search(T* value) const {
 	return searchRec(root, value);
 }
 
+/**
+ * @brief Recursively splits a subtree along a monotone predicate.
+ * @param node The root of the subtree to split.
+ * @param goesLeft Predicate that is true for a prefix of the in-order sequence.
+ * @param right Receives the root of the nodes for which goesLeft is false.
+ * @return Node<T>* The root of the nodes for which goesLeft is true.
+ */
+template <class T>
+template <class Pred>
+Node<T>* Bst<T>::splitRec(Node<T>* node, Pred goesLeft, Node<T>** right) {
+	if (node == nullptr) {
+		*right = nullptr;
+		return nullptr;
+	}
+
+	if (goesLeft(node->data)) {
+		// The node and its whole left subtree stay on the left
+		node->right = splitRec(node->right, goesLeft, right);
+		node->subtreeSize = 1 + TreeSlices::sizeOf(node->left) + TreeSlices::sizeOf(node->right);
+		return node;
+	}
+	Node<T>* left = splitRec(node->left, goesLeft, &node->left);
+	node->subtreeSize = 1 + TreeSlices::sizeOf(node->left) + TreeSlices::sizeOf(node->right);
+	*right = node;
+	return left;
+}
+
+/**
+ * @brief Joins two trees by hanging the right one below the largest node of the left one.
+ * @param left The root of the tree holding the smaller values.
+ * @param right The root of the tree holding the larger values.
+ * @return Node<T>* The root of the joined tree.
+ */
+template <class T>
+Node<T>* Bst<T>::join(Node<T>* left, Node<T>* right) {
+	if (left == nullptr) return right;
+	if (right == nullptr) return left;
+
+	// Every node on the right spine gains the right tree below it
+	Node<T>* last = left;
+	last->subtreeSize += right->subtreeSize;
+	while (last->right != nullptr) {
+		last = last->right;
+		last->subtreeSize += right->subtreeSize;
+	}
+	last->right = right;
+	return left;
+}
+
+/**
+ * @brief Recursively deletes a detached subtree, reporting each value before it is freed.
+ * @param node The root of the subtree.
+ * @param onErase Function applied to each value before deletion (may be nullptr).
+ * @param context Opaque pointer passed to onErase.
+ * @return int The number of nodes deleted.
+ */
+template <class T>
+int Bst<T>::releaseRec(Node<T>* node, void (*onErase)(const T*, void*), void* context) {
+	if (node == nullptr) return 0;
+
+	int count = 1 + releaseRec(node->left, onErase, context) + releaseRec(node->right, onErase, context);
+	if (onErase != nullptr) onErase(node->data, context);
+	delete node;
+	return count;
+}
+
+/**
+ * @brief Removes every value inside a range: split, release the middle, join.
+ * @param below Predicate that is true for values ordered before the range.
+ * @param above Predicate that is true for values ordered after the range.
+ * @param onErase Function applied to each removed value before it is deleted (may be nullptr).
+ * @param context Opaque pointer passed to onErase.
+ * @return int The number of values removed.
+ */
+template <class T>
+template <class Below, class Above>
+int Bst<T>::eraseRange(Below below, Above above, void (*onErase)(const T*, void*), void* context) {
+	Node<T>* rest = nullptr;
+	Node<T>* before = splitRec(root, below, &rest);
+
+	Node<T>* after = nullptr;
+	Node<T>* inside = splitRec(rest, [&above](const T* value) { return !above(value); }, &after);
+
+	root = join(before, after);
+	return releaseRec(inside, onErase, context);
+}
+
+/**
+ * @brief Removes every value v with first <= v <= last, using the value ordering.
+ * @param first A pointer to the lower bound (inclusive).
+ * @param last A pointer to the upper bound (inclusive).
+ * @return int The number of values removed.
+ */
+template <class T>
+int Bst<T>::eraseRange(const T* first, const T* last) {
+	return eraseRange([first](const T* value) { return *value < *first; },
+					  [last](const T* value) { return *last < *value; });
+}
+
+/**
+ * @brief Finds the largest value whose key is not greater than a key, descending from the root.
+ * @param key The key.
+ * @param keyOf Function returning the key of a value.
+ * @return Node<T>* The floor node, or nullptr if none.
+ */
+template <class T>
+template <class K, class KeyOf>
+Node<T>* Bst<T>::floor(const K& key, KeyOf keyOf) const {
+	Node<T>* best = nullptr;
+	Node<T>* node = root;
+	while (node != nullptr) {
+		if (key < keyOf(node->data)) {
+			node = node->left;
+		} else {
+			best = node;
+			node = node->right;
+		}
+	}
+	return best;
+}
+
+/**
+ * @brief Finds the smallest value whose key is not less than a key, descending from the root.
+ * @param key The key.
+ * @param keyOf Function returning the key of a value.
+ * @return Node<T>* The ceiling node, or nullptr if none.
+ */
+template <class T>
+template <class K, class KeyOf>
+Node<T>* Bst<T>::ceil(const K& key, KeyOf keyOf) const {
+	Node<T>* best = nullptr;
+	Node<T>* node = root;
+	while (node != nullptr) {
+		if (keyOf(node->data) < key) {
+			node = node->right;
+		} else {
+			best = node;
+			node = node->left;
+		}
+	}
+	return best;
+}
+
+/**
+ * @brief Recursively resolves the floors of keys[begin, end).
+ *
+ * Keys smaller than the node's key continue into the left subtree; the others have the
+ * node as their floor candidate and continue into the right subtree.
+ * @param node The current node being examined.
+ * @param keys The keys, ascending.
+ * @param begin The first key handled by this subtree.
+ * @param end One past the last key handled by this subtree.
+ * @param keyOf Function returning the key of a value.
+ * @param best The floor found on the path so far (nullptr if none).
+ * @param out Receives the floor node of each key.
+ */
+template <class T>
+template <class K, class KeyOf>
+void Bst<T>::floorBatchRec(Node<T>* node, const K* keys, size_t begin, size_t end, KeyOf keyOf,
+						   Node<T>* best, Node<T>** out) const {
+	if (begin == end) return;
+	if (node == nullptr) {
+		std::fill(out + begin, out + end, best);
+		return;
+	}
+
+	size_t split = static_cast<size_t>(std::lower_bound(keys + begin, keys + end, keyOf(node->data)) - keys);
+	floorBatchRec(node->left, keys, begin, split, keyOf, best, out);
+	floorBatchRec(node->right, keys, split, end, keyOf, node, out);
+}
+
+/**
+ * @brief Finds the floor of each of a sorted array of keys in one shared descent.
+ * @param keys The keys, ascending.
+ * @param count The number of keys.
+ * @param keyOf Function returning the key of a value.
+ * @param out Receives count nodes (nullptr where a key has no floor).
+ */
+template <class T>
+template <class K, class KeyOf>
+void Bst<T>::floorBatch(const K* keys, size_t count, KeyOf keyOf, Node<T>** out) const {
+	floorBatchRec(root, keys, 0, count, keyOf, nullptr, out);
+}
+
 // Traversal with simple function pointer
 /**
  * @brief Performs recursive in-order traversal and applies the visit function.
@@ -448,6 +756,18 @@ void Bst<T>::inOrder(void (*visit)(const T*, void*), void* context) const {
 	inOrderRec(root, visit, context);
 }
 
+/**
+ * @brief Slices the in-order sequence by rank and visits the slices on the pool (see TreeSlices).
+ * @param visit The function applied to each value with its slice's result.
+ * @param results The per-slice results.
+ * @param pool The pool, or nullptr.
+ */
+template <class T>
+template <class Result>
+void Bst<T>::parallelInOrder(void (*visit)(const T*, Result*), std::vector<Result>* results, TaskPool* pool) const {
+	TreeSlices::parallelInOrder(root, visit, results, pool);
+}
+
 // Simple traversals (backward compatibility)
 /**
  * @brief Simple in-order traversal that prints the data (requires operator<< for T).
@@ -521,23 +841,12 @@ bool Bst<T>::isEmpty() const {
 }
 
 /**
- * @brief Recursively calculates the size of the subtree rooted at node.
- * @param node The root of the subtree.
- * @return int The size of the subtree.
- */
-template <class T>
-int Bst<T>::sizeRec(Node<T>* node) const {
-	if (node == nullptr) return 0;
-	return 1 + sizeRec(node->left) + sizeRec(node->right);
-}
-
-/**
- * @brief Gets the total number of nodes in the tree.
+ * @brief Gets the total number of nodes in the tree, from the root's subtree size.
  * @return int The size of the tree.
  */
 template <class T>
 int Bst<T>::size() const {
-	return sizeRec(root);
+	return root ? root->subtreeSize : 0;
 }
 
 /**
@@ -0,0 +1,197 @@
+// ClimatologyIndex.cpp
+
+// Implements ClimatologyIndex: incremental (Welford) normals per day-of-year and
+// hour cell, their reversal on removal, and constant-time normal and anomaly lookups.
+
+#include "ClimatologyIndex.h"
+#include <algorithm>
+#include <cmath>
+
+	/**
+	 * @brief Constructor for ClimatologyIndex. No day is allocated until it gets a reading.
+	 *
+	 * @return void
+	 */
+ClimatologyIndex::ClimatologyIndex() {}
+
+	/**
+	 * @brief Destructor for ClimatologyIndex. The day handles release their cells.
+	 *
+	 * @return void
+	 */
+ClimatologyIndex::~ClimatologyIndex() {}
+
+	/**
+	 * @brief Copy constructor for ClimatologyIndex. Takes a reference to each of other's days.
+	 *
+	 * @param  other - The index to copy.
+	 * @return void
+	 */
+ClimatologyIndex::ClimatologyIndex(const ClimatologyIndex& other) {
+	std::copy(other.days, other.days + kDays, days);
+}
+
+	/**
+	 * @brief Assignment operator for ClimatologyIndex. Takes a reference to each of other's days.
+	 *
+	 * @param  other - The index to copy.
+	 * @return ClimatologyIndex& - Reference to this index.
+	 */
+ClimatologyIndex& ClimatologyIndex::operator=(const ClimatologyIndex& other) {
+	if (this != &other) {
+		std::copy(other.days, other.days + kDays, days);
+	}
+	return *this;
+}
+
+	/**
+	 * @brief Folds a record into its cell with Welford's update (wind direction is not tracked; see isLinearMetric).
+	 *
+	 * @param  record - Pointer to the record.
+	 * @return void
+	 */
+void ClimatologyIndex::add(const WeatherRecord* record) {
+	Cell* target = editCell(record->date->GetDayOfYear(), record->date->GetHour());
+	if (target == nullptr) return;
+
+	Cell& cell = *target;
+	cell.count += 1;
+
+	double values[kMetricCount];
+	values[static_cast<int>(Metric::WindSpeed)] = MetricColumn<Metric::WindSpeed>::get(record);
+	values[static_cast<int>(Metric::Temperature)] = MetricColumn<Metric::Temperature>::get(record);
+	values[static_cast<int>(Metric::SolarRadiation)] = MetricColumn<Metric::SolarRadiation>::get(record);
+
+	for (int m = 0; m < kMetricCount; ++m) {
+		if (!isLinearMetric(static_cast<Metric>(m))) continue;
+		double delta = values[m] - cell.mean[m];
+		cell.mean[m] += delta / cell.count;
+		cell.m2[m] += delta * (values[m] - cell.mean[m]);
+	}
+}
+
+	/**
+	 * @brief Reverses Welford's update for a record that was added earlier.
+	 *
+	 * @param  record - Pointer to the record.
+	 * @return void
+	 */
+void ClimatologyIndex::remove(const WeatherRecord* record) {
+	int day = record->date->GetDayOfYear();
+	int hour = record->date->GetHour();
+	if (cellAt(day, hour) == nullptr) return;
+
+	Cell& cell = *editCell(day, hour);
+	if (cell.count <= 1) {
+		cell = Cell();
+		return;
+	}
+
+	double values[kMetricCount];
+	values[static_cast<int>(Metric::WindSpeed)] = MetricColumn<Metric::WindSpeed>::get(record);
+	values[static_cast<int>(Metric::Temperature)] = MetricColumn<Metric::Temperature>::get(record);
+	values[static_cast<int>(Metric::SolarRadiation)] = MetricColumn<Metric::SolarRadiation>::get(record);
+
+	unsigned long count = cell.count - 1;
+	for (int m = 0; m < kMetricCount; ++m) {
+		if (!isLinearMetric(static_cast<Metric>(m))) continue;
+		double mean = (cell.mean[m] * cell.count - values[m]) / count;
+		cell.m2[m] = std::max(0.0, cell.m2[m] - (values[m] - mean) * (values[m] - cell.mean[m]));
+		cell.mean[m] = mean;
+	}
+	cell.count = count;
+}
+
+	/**
+	 * @brief Resets every cell.
+	 *
+	 * @return void
+	 */
+void ClimatologyIndex::clear() {
+	for (Shared<Day>& day : days) {
+		day.reset();
+	}
+}
+
+	/**
+	 * @brief Returns the cell of a day and hour.
+	 *
+	 * @param  dayOfYear - Day index (0-365).
+	 * @param  hour - Hour (0-23).
+	 * @return const Cell* - The cell, or nullptr if out of range or the day has no readings.
+	 */
+const ClimatologyIndex::Cell* ClimatologyIndex::cellAt(int dayOfYear, int hour) const {
+	if (dayOfYear < 0 || dayOfYear >= kDays || hour < 0 || hour >= kHours || !days[dayOfYear]) return nullptr;
+	return &days[dayOfYear]->cells[hour];
+}
+
+	/**
+	 * @brief Returns a cell for updating: its day is allocated (zeroed) if new, or copied if shared.
+	 *
+	 * @param  dayOfYear - Day index (0-365).
+	 * @param  hour - Hour (0-23).
+	 * @return Cell* - The cell, or nullptr if out of range.
+	 */
+ClimatologyIndex::Cell* ClimatologyIndex::editCell(int dayOfYear, int hour) {
+	if (dayOfYear < 0 || dayOfYear >= kDays || hour < 0 || hour >= kHours) return nullptr;
+	if (!days[dayOfYear]) days[dayOfYear].reset(new Day());
+	return &days[dayOfYear].edit()->cells[hour];
+}
+
+	/**
+	 * @brief Returns the normal of a metric for a day and hour.
+	 *
+	 * @param  metric - The metric.
+	 * @param  dayOfYear - Day index (0-365).
+	 * @param  hour - Hour (0-23).
+	 * @return ClimateNormal - Count, mean and sample standard deviation of the cell (empty for wind direction).
+	 */
+ClimateNormal ClimatologyIndex::getNormal(Metric metric, int dayOfYear, int hour) const {
+	ClimateNormal normal = {0, 0.0, 0.0};
+	const Cell* cell = cellAt(dayOfYear, hour);
+	if (cell == nullptr || cell->count == 0 || !isLinearMetric(metric)) return normal;
+
+	int m = static_cast<int>(metric);
+	normal.count = cell->count;
+	normal.mean = cell->mean[m];
+	normal.stdDev = cell->count < 2 ? 0.0 : std::sqrt(cell->m2[m] / (cell->count - 1));
+	return normal;
+}
+
+	/**
+	 * @brief Returns the normal of a metric for the day and hour of a date.
+	 *
+	 * @param  metric - The metric.
+	 * @param  date - Pointer to the date (its year is ignored).
+	 * @return ClimateNormal - The normal.
+	 */
+ClimateNormal ClimatologyIndex::getNormal(Metric metric, const Date* date) const {
+	return getNormal(metric, date->GetDayOfYear(), date->GetHour());
+}
+
+	/**
+	 * @brief Returns a reading minus the mean of its cell.
+	 *
+	 * @param  metric - The metric.
+	 * @param  date - Pointer to the date of the reading.
+	 * @param  value - The reading.
+	 * @return double - The anomaly, or 0 if the cell is empty.
+	 */
+double ClimatologyIndex::getAnomaly(Metric metric, const Date* date, double value) const {
+	ClimateNormal normal = getNormal(metric, date);
+	return normal.count == 0 ? 0.0 : value - normal.mean;
+}
+
+	/**
+	 * @brief Returns the anomaly of a reading in units of the cell's standard deviation.
+	 *
+	 * @param  metric - The metric.
+	 * @param  date - Pointer to the date of the reading.
+	 * @param  value - The reading.
+	 * @return double - The z-score, or 0 if the spread is unknown or zero.
+	 */
+double ClimatologyIndex::getZScore(Metric metric, const Date* date, double value) const {
+	ClimateNormal normal = getNormal(metric, date);
+	if (normal.count < 2 || normal.stdDev == 0.0) return 0.0;
+	return (value - normal.mean) / normal.stdDev;
+}
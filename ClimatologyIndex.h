@@ -0,0 +1,159 @@
+#ifndef CLIMATOLOGYINDEX_H
+#define CLIMATOLOGYINDEX_H
+
+#include "Date.h"
+#include "Metric.h"
+#include "Shared.h"
+#include "WeatherRecord.h"
+
+/**
+ * @struct ClimateNormal
+ * @brief The climatological normal of one metric in one (day-of-year, hour) cell.
+ */
+struct ClimateNormal {
+	unsigned long count; ///< Number of readings in the cell, across all years.
+	double mean;         ///< Mean of the readings (0 if count is 0).
+	double stdDev;       ///< Sample standard deviation of the readings (0 if count < 2).
+};
+
+/**
+ * @class ClimatologyIndex
+ * @brief Normals per (day-of-year, hour-of-day) cell across all years.
+ *
+ * The year is folded onto a 366-day calendar (see Date::GetDayOfYear), giving
+ * 366 x 24 cells. Each cell keeps the reading count and, per metric, a running mean
+ * and sum of squared deviations (Welford's method), updated as records are added (or removed). The
+ * normal and the anomaly of any timestamp are therefore answered in constant time,
+ * without touching the records. Wind direction has no linear normal (see
+ * isLinearMetric): it is not accumulated, and its normal is always empty.
+ *
+ * The cells of each day sit behind a Shared handle, so copying an index takes one
+ * reference per day instead of copying all the cells. A copy that is then updated only
+ * copies the days it changes. Days with no readings are not allocated.
+ */
+class ClimatologyIndex {
+public:
+	/**
+	 * @brief Number of day cells (a leap year).
+	 */
+	static const int kDays = 366;
+
+	/**
+	 * @brief Number of hour cells.
+	 */
+	static const int kHours = 24;
+
+	/**
+	 * @brief Constructor. Creates an empty index.
+	 */
+	ClimatologyIndex();
+
+	/**
+	 * @brief Destructor.
+	 */
+	~ClimatologyIndex();
+
+	/**
+	 * @brief Copy constructor. Shares the other index's days.
+	 * @param other The index to copy.
+	 */
+	ClimatologyIndex(const ClimatologyIndex& other);
+
+	/**
+	 * @brief Assignment operator. Shares the other index's days.
+	 * @param other The index to copy.
+	 * @return ClimatologyIndex& A reference to this index.
+	 */
+	ClimatologyIndex& operator=(const ClimatologyIndex& other);
+
+	/**
+	 * @brief Adds a record's readings to the cell of its day and hour.
+	 * @param record A constant pointer to the record.
+	 */
+	void add(const WeatherRecord* record);
+
+	/**
+	 * @brief Takes a previously added record's readings back out of its cell.
+	 * @param record A constant pointer to the record.
+	 */
+	void remove(const WeatherRecord* record);
+
+	/**
+	 * @brief Removes every reading.
+	 */
+	void clear();
+
+	/**
+	 * @brief Gets the normal of a metric for a day and hour.
+	 * @param metric The metric.
+	 * @param dayOfYear The day index (0-365, as returned by Date::GetDayOfYear).
+	 * @param hour The hour (0-23).
+	 * @return ClimateNormal The normal (count 0 for out-of-range or empty cells, and for wind direction).
+	 */
+	ClimateNormal getNormal(Metric metric, int dayOfYear, int hour) const;
+
+	/**
+	 * @brief Gets the normal of a metric for the day and hour of a date, ignoring its year.
+	 * @param metric The metric.
+	 * @param date A constant pointer to the date.
+	 * @return ClimateNormal The normal.
+	 */
+	ClimateNormal getNormal(Metric metric, const Date* date) const;
+
+	/**
+	 * @brief Gets how far a reading is from the normal of its day and hour.
+	 * @param metric The metric.
+	 * @param date A constant pointer to the date of the reading.
+	 * @param value The reading.
+	 * @return double The difference from the cell mean (0 if the cell is empty).
+	 */
+	double getAnomaly(Metric metric, const Date* date, double value) const;
+
+	/**
+	 * @brief Gets a reading's distance from the normal in standard deviations.
+	 * @param metric The metric.
+	 * @param date A constant pointer to the date of the reading.
+	 * @param value The reading.
+	 * @return double The z-score (0 if the cell has fewer than 2 readings or no spread).
+	 */
+	double getZScore(Metric metric, const Date* date, double value) const;
+
+private:
+	/**
+	 * @struct Cell
+	 * @brief Running statistics of one (day, hour) cell.
+	 */
+	struct Cell {
+		unsigned long count;        ///< Readings in the cell.
+		double mean[kMetricCount];  ///< Running mean per metric.
+		double m2[kMetricCount];    ///< Running sum of squared deviations per metric.
+	};
+
+	/**
+	 * @struct Day
+	 * @brief The cells of one day, hour by hour.
+	 */
+	struct Day {
+		Cell cells[kHours]; ///< One cell per hour.
+	};
+
+	/**
+	 * @brief Gets the cell of a day and hour.
+	 * @param dayOfYear The day index.
+	 * @param hour The hour.
+	 * @return const Cell* The cell, or nullptr if out of range or the day has no readings.
+	 */
+	const Cell* cellAt(int dayOfYear, int hour) const;
+
+	/**
+	 * @brief Gets a cell for updating, allocating its day or copying it if another index shares it.
+	 * @param dayOfYear The day index.
+	 * @param hour The hour.
+	 * @return Cell* The cell, or nullptr if out of range.
+	 */
+	Cell* editCell(int dayOfYear, int hour);
+
+	Shared<Day> days[kDays]; ///< Cells per day (empty for days without readings).
+};
+
+#endif // CLIMATOLOGYINDEX_H
@@ -0,0 +1,636 @@
+// ColumnStore.cpp
+
+// Implements ColumnStore: packing records into one buffer of narrow, exactly
+// decodable columns, and range lookups and aggregation over them.
+
+#include "ColumnStore.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	const double kPow10[5] = {1.0, 10.0, 100.0, 1000.0, 10000.0};
+	const char kMagic[4] = {'W', 'C', 'S', '3'};
+	const int kVersion1MetricCount = 3;
+	const size_t kLayoutBytes = sizeof(kMagic) + sizeof(uint32_t) + 2 * sizeof(uint64_t) +
+								kMetricCount * (2 * sizeof(int32_t) + sizeof(uint64_t));
+
+	/**
+	 * @brief Returns the size in bytes of one value of an encoding.
+	 *
+	 * @param  encoding - The encoding.
+	 * @return size_t - The element size.
+	 */
+	size_t elementSize(ColumnStore::Encoding encoding) {
+		switch (encoding) {
+			case ColumnStore::ScaledInt16: return sizeof(int16_t);
+			case ColumnStore::ScaledInt32: return sizeof(int32_t);
+			case ColumnStore::Float32: return sizeof(float);
+			default: return sizeof(double);
+		}
+	}
+
+	/**
+	 * @brief Rounds a byte count up to the next multiple of 8.
+	 *
+	 * @param  bytes - The byte count.
+	 * @return size_t - The aligned count.
+	 */
+	size_t align8(size_t bytes) {
+		return (bytes + 7) & ~static_cast<size_t>(7);
+	}
+
+	/**
+	 * @brief Converts stored values to double: divides by scale for the scaled encodings.
+	 *
+	 * @param  data - The stored column.
+	 * @param  begin - First row.
+	 * @param  end - One past the last row.
+	 * @param  scale - 10^digits (ignored unless Scaled).
+	 * @param  out - Destination array.
+	 * @return void
+	 */
+	template <class S, bool Scaled>
+	void widen(const S* data, size_t begin, size_t end, double scale, double* out) {
+		for (size_t i = begin; i < end; ++i) {
+			double value = static_cast<double>(data[i]);
+			out[i - begin] = Scaled ? value / scale : value;
+		}
+	}
+
+	/**
+	 * @brief Accumulates stored values, widened to double, into a summary.
+	 *
+	 * @param  data - The stored column.
+	 * @param  begin - First row.
+	 * @param  end - One past the last row.
+	 * @param  scale - 10^digits (ignored unless Scaled).
+	 * @param  summary - The summary to update.
+	 * @return void
+	 */
+	template <class S, bool Scaled>
+	void accumulate(const S* data, size_t begin, size_t end, double scale, SeriesSummary* summary) {
+		if (begin >= end) return;
+
+		double sum = 0.0;
+		double sumSq = 0.0;
+		double lo = std::numeric_limits<double>::infinity();
+		double hi = -std::numeric_limits<double>::infinity();
+		for (size_t i = begin; i < end; ++i) {
+			double value = static_cast<double>(data[i]);
+			if (Scaled) value /= scale;
+			sum += value;
+			sumSq += value * value;
+			lo = std::min(lo, value);
+			hi = std::max(hi, value);
+		}
+
+		summary->count = end - begin;
+		summary->sum = sum;
+		summary->sumSq = sumSq;
+		summary->min = lo;
+		summary->max = hi;
+	}
+
+	/**
+	 * @brief Writes values into a column buffer in the given encoding.
+	 *
+	 * @param  values - The values.
+	 * @param  scale - 10^digits (ignored unless Scaled).
+	 * @param  out - Destination column.
+	 * @return void
+	 */
+	template <class S, bool Scaled>
+	void narrow(const std::vector<double>* values, double scale, S* out) {
+		for (size_t i = 0; i < values->size(); ++i) {
+			double value = (*values)[i];
+			out[i] = Scaled ? static_cast<S>(std::llround(value * scale)) : static_cast<S>(value);
+		}
+	}
+}
+
+	/**
+	 * @brief Constructor for ColumnStore. Extracts each column and packs the buffer.
+	 *
+	 * @param  records - Pointer to the records, sorted by date.
+	 * @return void
+	 */
+ColumnStore::ColumnStore(const std::vector<WeatherRecord*>* records)
+	: rowCount(0), bufferBytes(0), buffer(nullptr), keys(nullptr), mapping(nullptr), mappingBytes(0) {
+	std::vector<int32_t> keyValues;
+	keyValues.reserve(records->size());
+	for (const WeatherRecord* record : *records) {
+		keyValues.push_back(record->date->toMinuteKey());
+	}
+
+	std::vector<double> values[kMetricCount];
+	extractColumn<Metric::WindSpeed>(records, &values[static_cast<int>(Metric::WindSpeed)]);
+	extractColumn<Metric::Temperature>(records, &values[static_cast<int>(Metric::Temperature)]);
+	extractColumn<Metric::SolarRadiation>(records, &values[static_cast<int>(Metric::SolarRadiation)]);
+	extractColumn<Metric::WindDirection>(records, &values[static_cast<int>(Metric::WindDirection)]);
+
+	pack(&keyValues, values);
+}
+
+	/**
+	 * @brief Merge constructor for ColumnStore. Interleaves the rows of a store with sorted records.
+	 *
+	 * The store's rows are decoded, merged with the records by key in a single pass
+	 * and the result is packed again; a record whose key the store already holds is skipped.
+	 *
+	 * @param  base - Pointer to the store to start from (may be nullptr).
+	 * @param  records - Pointer to the records to add, sorted by date.
+	 * @return void
+	 */
+ColumnStore::ColumnStore(const ColumnStore* base, const std::vector<WeatherRecord*>* records)
+	: rowCount(0), bufferBytes(0), buffer(nullptr), keys(nullptr), mapping(nullptr), mappingBytes(0) {
+	size_t baseRows = base ? base->size() : 0;
+
+	std::vector<double> baseValues[kMetricCount];
+	for (int m = 0; m < kMetricCount; ++m) {
+		baseValues[m].resize(baseRows);
+		if (baseRows > 0) base->copyColumn(static_cast<Metric>(m), 0, baseRows, baseValues[m].data());
+	}
+
+	std::vector<int32_t> keyValues;
+	std::vector<double> values[kMetricCount];
+	keyValues.reserve(baseRows + records->size());
+	for (int m = 0; m < kMetricCount; ++m) {
+		values[m].reserve(baseRows + records->size());
+	}
+
+	size_t row = 0;
+	size_t next = 0;
+	while (row < baseRows || next < records->size()) {
+		int recordKey = next < records->size() ? (*records)[next]->date->toMinuteKey() : 0;
+		if (row < baseRows && (next == records->size() || base->getKey(row) <= recordKey)) {
+			if (next < records->size() && base->getKey(row) == recordKey) ++next; // Already stored
+			keyValues.push_back(base->getKey(row));
+			for (int m = 0; m < kMetricCount; ++m) {
+				values[m].push_back(baseValues[m][row]);
+			}
+			++row;
+		} else {
+			const WeatherRecord* record = (*records)[next++];
+			keyValues.push_back(recordKey);
+			values[static_cast<int>(Metric::WindSpeed)].push_back(MetricColumn<Metric::WindSpeed>::get(record));
+			values[static_cast<int>(Metric::Temperature)].push_back(MetricColumn<Metric::Temperature>::get(record));
+			values[static_cast<int>(Metric::SolarRadiation)].push_back(MetricColumn<Metric::SolarRadiation>::get(record));
+			values[static_cast<int>(Metric::WindDirection)].push_back(MetricColumn<Metric::WindDirection>::get(record));
+		}
+	}
+
+	pack(&keyValues, values);
+}
+
+	/**
+	 * @brief Erase constructor for ColumnStore. Copies the rows outside [begin, end) slice by slice.
+	 *
+	 * Dropping rows cannot make an exact encoding inexact, so each column keeps its
+	 * encoding and the two remaining slices of it are copied with memcpy.
+	 *
+	 * @param  base - Pointer to the store to copy.
+	 * @param  begin - First row to leave out.
+	 * @param  end - One past the last row to leave out.
+	 * @return void
+	 */
+ColumnStore::ColumnStore(const ColumnStore* base, size_t begin, size_t end)
+	: rowCount(0), bufferBytes(0), buffer(nullptr), keys(nullptr), mapping(nullptr), mappingBytes(0) {
+	end = std::min(end, base->rowCount);
+	begin = std::min(begin, end);
+	rowCount = base->rowCount - (end - begin);
+
+	size_t offset = align8(rowCount * sizeof(int32_t));
+	for (int m = 0; m < kMetricCount; ++m) {
+		columns[m] = base->columns[m];
+		columns[m].offset = offset;
+		offset += align8(rowCount * elementSize(columns[m].encoding));
+	}
+
+	bufferBytes = offset;
+	buffer = new unsigned char[bufferBytes > 0 ? bufferBytes : 1];
+
+	size_t tail = base->rowCount - end;
+	std::memcpy(buffer, base->buffer, begin * sizeof(int32_t));
+	std::memcpy(buffer + begin * sizeof(int32_t), base->buffer + end * sizeof(int32_t), tail * sizeof(int32_t));
+	keys = reinterpret_cast<const int32_t*>(buffer);
+
+	for (int m = 0; m < kMetricCount; ++m) {
+		size_t width = elementSize(columns[m].encoding);
+		const unsigned char* from = base->buffer + base->columns[m].offset;
+		unsigned char* to = buffer + columns[m].offset;
+		std::memcpy(to, from, begin * width);
+		std::memcpy(to + begin * width, from + end * width, tail * width);
+	}
+}
+
+	/**
+	 * @brief Copy constructor for ColumnStore. Copies the buffer.
+	 *
+	 * @param  other - The store to copy.
+	 * @return void
+	 */
+ColumnStore::ColumnStore(const ColumnStore& other)
+	: rowCount(other.rowCount), bufferBytes(other.bufferBytes),
+	  buffer(new unsigned char[other.bufferBytes > 0 ? other.bufferBytes : 1]), keys(nullptr),
+	  mapping(nullptr), mappingBytes(0) {
+	std::memcpy(buffer, other.buffer, bufferBytes);
+	keys = reinterpret_cast<const int32_t*>(buffer);
+	std::copy(other.columns, other.columns + kMetricCount, columns);
+}
+
+	/**
+	 * @brief Assignment operator for ColumnStore.
+	 *
+	 * @param  other - The store to copy.
+	 * @return ColumnStore& - Reference to this store.
+	 */
+ColumnStore& ColumnStore::operator=(const ColumnStore& other) {
+	if (this != &other) {
+		unsigned char* copy = new unsigned char[other.bufferBytes > 0 ? other.bufferBytes : 1];
+		std::memcpy(copy, other.buffer, other.bufferBytes);
+		release();
+		buffer = copy;
+		rowCount = other.rowCount;
+		bufferBytes = other.bufferBytes;
+		keys = reinterpret_cast<const int32_t*>(buffer);
+		std::copy(other.columns, other.columns + kMetricCount, columns);
+	}
+	return *this;
+}
+
+	/**
+	 * @brief Picks each column's encoding and packs keys and values into one buffer.
+	 *
+	 * @param  keyValues - Pointer to the minute keys, ascending.
+	 * @param  values - Array of kMetricCount columns, each as long as keyValues.
+	 * @return void
+	 */
+void ColumnStore::pack(const std::vector<int32_t>* keyValues, const std::vector<double>* values) {
+	rowCount = keyValues->size();
+
+	size_t offset = align8(rowCount * sizeof(int32_t));
+	for (int m = 0; m < kMetricCount; ++m) {
+		chooseEncoding(&values[m], &columns[m]);
+		columns[m].offset = offset;
+		offset += align8(rowCount * elementSize(columns[m].encoding));
+	}
+
+	bufferBytes = offset;
+	buffer = new unsigned char[bufferBytes > 0 ? bufferBytes : 1];
+
+	int32_t* keyColumn = reinterpret_cast<int32_t*>(buffer);
+	std::copy(keyValues->begin(), keyValues->end(), keyColumn);
+	keys = keyColumn;
+
+	for (int m = 0; m < kMetricCount; ++m) {
+		unsigned char* out = buffer + columns[m].offset;
+		switch (columns[m].encoding) {
+			case ScaledInt16: narrow<int16_t, true>(&values[m], columns[m].scale, reinterpret_cast<int16_t*>(out)); break;
+			case ScaledInt32: narrow<int32_t, true>(&values[m], columns[m].scale, reinterpret_cast<int32_t*>(out)); break;
+			case Float32: narrow<float, false>(&values[m], 1.0, reinterpret_cast<float*>(out)); break;
+			case Float64: narrow<double, false>(&values[m], 1.0, reinterpret_cast<double*>(out)); break;
+		}
+	}
+}
+
+	/**
+	 * @brief Private default constructor for ColumnStore. Creates an empty store for readFrom to fill.
+	 *
+	 * @return void
+	 */
+ColumnStore::ColumnStore() : rowCount(0), bufferBytes(0), buffer(nullptr), keys(nullptr), mapping(nullptr), mappingBytes(0) {}
+
+	/**
+	 * @brief Destructor for ColumnStore.
+	 *
+	 * @return void
+	 */
+ColumnStore::~ColumnStore() {
+	release();
+}
+
+	/**
+	 * @brief Frees the heap buffer, or unmaps the file the buffer points into.
+	 *
+	 * @return void
+	 */
+void ColumnStore::release() {
+	if (mapping != nullptr) {
+#ifndef _WIN32
+		munmap(mapping, mappingBytes);
+#endif
+		mapping = nullptr;
+		mappingBytes = 0;
+	} else {
+		delete[] buffer;
+	}
+	buffer = nullptr;
+	keys = nullptr;
+}
+
+	/**
+	 * @brief Picks the narrowest encoding that reproduces every value exactly.
+	 *
+	 * Scaled integers are preferred (int16, then int32), then float32, then double.
+	 *
+	 * @param  values - The column values.
+	 * @param  column - Receives the encoding and scale.
+	 * @return void
+	 */
+void ColumnStore::chooseEncoding(const std::vector<double>* values, Column* column) {
+	column->scaleDigits = 0;
+	column->scale = 1.0;
+
+	int digits = CompressedSeries::chooseScale(values->data(), values->size());
+	if (digits >= 0) {
+		double scale = kPow10[digits];
+		long long lo = 0, hi = 0;
+		for (double value : *values) {
+			long long q = std::llround(value * scale);
+			lo = std::min(lo, q);
+			hi = std::max(hi, q);
+		}
+
+		if (lo >= std::numeric_limits<int16_t>::min() && hi <= std::numeric_limits<int16_t>::max()) {
+			column->encoding = ScaledInt16;
+		} else if (lo >= std::numeric_limits<int32_t>::min() && hi <= std::numeric_limits<int32_t>::max()) {
+			column->encoding = ScaledInt32;
+		} else {
+			digits = -1;
+		}
+		if (digits >= 0) {
+			column->scaleDigits = digits;
+			column->scale = scale;
+			return;
+		}
+	}
+
+	bool floatExact = true;
+	for (double value : *values) {
+		if (static_cast<double>(static_cast<float>(value)) != value) {
+			floatExact = false;
+			break;
+		}
+	}
+	column->encoding = floatExact ? Float32 : Float64;
+}
+
+	/**
+	 * @brief Returns one value of a column, widened to double.
+	 *
+	 * @param  metric - The column.
+	 * @param  row - The row index.
+	 * @return double - The value.
+	 */
+double ColumnStore::getValue(Metric metric, size_t row) const {
+	double value;
+	copyColumn(metric, row, row + 1, &value);
+	return value;
+}
+
+	/**
+	 * @brief Binary search for the first row with key >= key.
+	 *
+	 * @param  key - The minute key.
+	 * @return size_t - The row index, or size() if none.
+	 */
+size_t ColumnStore::lowerBound(int key) const {
+	return static_cast<size_t>(std::lower_bound(keys, keys + rowCount, key) - keys);
+}
+
+	/**
+	 * @brief Exponential search from a hint, then binary search for the first row with key >= key.
+	 *
+	 * @param  key - The minute key.
+	 * @param  first - Row to start from.
+	 * @return size_t - The row index, or size() if none.
+	 */
+size_t ColumnStore::lowerBound(int key, size_t first) const {
+	size_t lo = std::min(first, rowCount);
+	size_t step = 1;
+	size_t hi = lo;
+	while (hi < rowCount && keys[hi] < key) {
+		lo = hi + 1;
+		hi = std::min(rowCount, hi + step);
+		step *= 2;
+	}
+	return static_cast<size_t>(std::lower_bound(keys + lo, keys + hi, key) - keys);
+}
+
+	/**
+	 * @brief Copies rows [begin, end) of a column to out as doubles.
+	 *
+	 * The encoding is resolved once; the per-row loop is specialized for it.
+	 *
+	 * @param  metric - The column.
+	 * @param  begin - First row.
+	 * @param  end - One past the last row.
+	 * @param  out - Destination array.
+	 * @return void
+	 */
+void ColumnStore::copyColumn(Metric metric, size_t begin, size_t end, double* out) const {
+	const Column& column = columns[static_cast<int>(metric)];
+	const unsigned char* data = buffer + column.offset;
+	switch (column.encoding) {
+		case ScaledInt16: widen<int16_t, true>(reinterpret_cast<const int16_t*>(data), begin, end, column.scale, out); break;
+		case ScaledInt32: widen<int32_t, true>(reinterpret_cast<const int32_t*>(data), begin, end, column.scale, out); break;
+		case Float32: widen<float, false>(reinterpret_cast<const float*>(data), begin, end, 1.0, out); break;
+		case Float64: widen<double, false>(reinterpret_cast<const double*>(data), begin, end, 1.0, out); break;
+	}
+}
+
+	/**
+	 * @brief Aggregates a column over the key range [from, to].
+	 *
+	 * @param  metric - The column.
+	 * @param  from - First minute key.
+	 * @param  to - Last minute key (inclusive).
+	 * @return SeriesSummary - The aggregates.
+	 */
+SeriesSummary ColumnStore::summarize(Metric metric, int from, int to) const {
+	SeriesSummary summary = {0, 0.0, 0.0, 0.0, 0.0};
+	if (from > to) return summary;
+
+	size_t begin = lowerBound(from);
+	size_t end = (to == std::numeric_limits<int>::max()) ? rowCount : lowerBound(to + 1);
+
+	const Column& column = columns[static_cast<int>(metric)];
+	const unsigned char* data = buffer + column.offset;
+	switch (column.encoding) {
+		case ScaledInt16: accumulate<int16_t, true>(reinterpret_cast<const int16_t*>(data), begin, end, column.scale, &summary); break;
+		case ScaledInt32: accumulate<int32_t, true>(reinterpret_cast<const int32_t*>(data), begin, end, column.scale, &summary); break;
+		case Float32: accumulate<float, false>(reinterpret_cast<const float*>(data), begin, end, 1.0, &summary); break;
+		case Float64: accumulate<double, false>(reinterpret_cast<const double*>(data), begin, end, 1.0, &summary); break;
+	}
+	return summary;
+}
+
+	/**
+	 * @brief Writes a magic tag, the row count, the column descriptors and the raw buffer.
+	 *
+	 * The layout is padded to a multiple of 8 bytes, so in a mapped file the buffer keeps the
+	 * alignment its columns need.
+	 *
+	 * @param  out - Pointer to the binary output stream.
+	 * @return bool - False if the stream failed.
+	 */
+bool ColumnStore::writeTo(std::ostream* out) const {
+	uint32_t padding = 0;
+	uint64_t header[2] = {rowCount, bufferBytes};
+	out->write(kMagic, sizeof(kMagic));
+	out->write(reinterpret_cast<const char*>(&padding), sizeof(padding));
+	out->write(reinterpret_cast<const char*>(header), sizeof(header));
+	for (int m = 0; m < kMetricCount; ++m) {
+		int32_t descriptor[2] = {static_cast<int32_t>(columns[m].encoding), columns[m].scaleDigits};
+		uint64_t offset = columns[m].offset;
+		out->write(reinterpret_cast<const char*>(descriptor), sizeof(descriptor));
+		out->write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+	}
+	out->write(reinterpret_cast<const char*>(buffer), static_cast<std::streamsize>(bufferBytes));
+	return out->good();
+}
+
+	/**
+	 * @brief Reads the layout written by writeTo into this store, checking it before trusting it.
+	 *
+	 * WCS1 layouts (written before wind direction was stored) have three metric columns and
+	 * no padding word; their wind direction column is left for readFrom to add. WCS2 layouts
+	 * have every column but no padding word, so their buffer is not 8-byte aligned in a
+	 * mapped file.
+	 *
+	 * @param  in - Pointer to the binary input stream.
+	 * @param  version - Receives the layout version (the digit of the magic tag).
+	 * @return bool - False if the stream is truncated, of an unknown version or the layout inconsistent.
+	 */
+bool ColumnStore::readLayout(std::istream* in, int* version) {
+	char magic[sizeof(kMagic)];
+	uint32_t padding;
+	uint64_t header[2];
+	if (!in->read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic) - 1) != 0) return false;
+	*version = magic[sizeof(kMagic) - 1] - '0';
+	if (*version < 1 || *version > kMagic[sizeof(kMagic) - 1] - '0') return false;
+	if (*version >= 3 && !in->read(reinterpret_cast<char*>(&padding), sizeof(padding))) return false;
+	if (!in->read(reinterpret_cast<char*>(header), sizeof(header))) return false;
+
+	rowCount = static_cast<size_t>(header[0]);
+	bufferBytes = static_cast<size_t>(header[1]);
+	if (bufferBytes < align8(rowCount * sizeof(int32_t))) return false;
+
+	int columnCount = (*version == 1) ? kVersion1MetricCount : kMetricCount;
+	for (int m = 0; m < columnCount; ++m) {
+		int32_t descriptor[2];
+		uint64_t offset;
+		if (!in->read(reinterpret_cast<char*>(descriptor), sizeof(descriptor)) ||
+			!in->read(reinterpret_cast<char*>(&offset), sizeof(offset)) ||
+			descriptor[0] < ScaledInt16 || descriptor[0] > Float64 || descriptor[1] < 0 || descriptor[1] > 4) {
+			return false;
+		}
+
+		Column& column = columns[m];
+		column.encoding = static_cast<Encoding>(descriptor[0]);
+		column.scaleDigits = descriptor[1];
+		column.scale = kPow10[descriptor[1]];
+		column.offset = static_cast<size_t>(offset);
+		if (column.offset % 8 != 0 || column.offset + rowCount * elementSize(column.encoding) > bufferBytes) return false;
+	}
+	return true;
+}
+
+	/**
+	 * @brief Reads a store written by writeTo, checking the layout before trusting it.
+	 *
+	 * A WCS1 store gets a wind direction column of zeros, as version 1 write-ahead logs do
+	 * when they are migrated.
+	 *
+	 * @param  in - Pointer to the binary input stream.
+	 * @return ColumnStore* - The new store, or nullptr if the stream is truncated or inconsistent.
+	 */
+ColumnStore* ColumnStore::readFrom(std::istream* in) {
+	ColumnStore* store = new ColumnStore();
+	int version = 0;
+	bool valid = store->readLayout(in, &version);
+
+	if (valid) {
+		size_t stored = store->bufferBytes;
+		if (version == 1) {
+			Column& direction = store->columns[static_cast<int>(Metric::WindDirection)];
+			direction.encoding = ScaledInt16;
+			direction.scaleDigits = 0;
+			direction.scale = 1.0;
+			direction.offset = align8(stored);
+			store->bufferBytes = direction.offset + align8(store->rowCount * sizeof(int16_t));
+		}
+		store->buffer = new unsigned char[store->bufferBytes > 0 ? store->bufferBytes : 1]();
+		valid = static_cast<bool>(in->read(reinterpret_cast<char*>(store->buffer), static_cast<std::streamsize>(stored)));
+		store->keys = reinterpret_cast<const int32_t*>(store->buffer);
+	}
+
+	if (!valid) {
+		delete store;
+		return nullptr;
+	}
+	return store;
+}
+
+	/**
+	 * @brief Checks a file's layout, then maps the whole file and points the buffer just past the layout.
+	 *
+	 * The mapping is private and read-only; the store never writes to its buffer.
+	 *
+	 * @param  path - Pointer to the file path.
+	 * @return ColumnStore* - The new store, or nullptr if the file cannot be opened, is inconsistent or is not the size its layout says.
+	 */
+ColumnStore* ColumnStore::mapFile(const std::string* path) {
+	std::ifstream in(*path, std::ios::binary);
+	if (!in.is_open()) return nullptr;
+#ifdef _WIN32
+	return readFrom(&in);
+#else
+	ColumnStore* store = new ColumnStore();
+	int version = 0;
+	if (!store->readLayout(&in, &version)) {
+		delete store;
+		return nullptr;
+	}
+	if (version != kMagic[sizeof(kMagic) - 1] - '0') {
+		// Older layouts are not padded for mapping (and WCS1 lacks a column): read them into an owned, aligned buffer
+		delete store;
+		in.clear();
+		in.seekg(0);
+		return readFrom(&in);
+	}
+	in.close();
+
+	int fd = open(path->c_str(), O_RDONLY | O_CLOEXEC);
+	struct stat info;
+	size_t expected = kLayoutBytes + store->bufferBytes;
+	if (fd < 0 || fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) != expected) {
+		if (fd >= 0) close(fd);
+		delete store;
+		return nullptr;
+	}
+
+	void* mapped = mmap(nullptr, expected, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapped == MAP_FAILED) {
+		delete store;
+		return nullptr;
+	}
+
+	store->mapping = mapped;
+	store->mappingBytes = expected;
+	store->buffer = static_cast<unsigned char*>(mapped) + kLayoutBytes;
+	store->keys = reinterpret_cast<const int32_t*>(store->buffer);
+	return store;
+#endif
+}
@@ -0,0 +1,322 @@
+#ifndef COLUMNSTORE_H
+#define COLUMNSTORE_H
+
+#include "CompressedSeries.h"
+#include "Metric.h"
+#include "WeatherRecord.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @class ColumnStore
+ * @brief Immutable, compact column-oriented copy of a time-ordered set of records.
+ *
+ * Rows live in one contiguous buffer: a column of int32 minute keys (see
+ * Date::toMinuteKey) followed by one column per Metric. Each metric column uses the
+ * narrowest type that reproduces every value exactly, chosen when the store is built:
+ * a scaled int16 or int32 (value = stored / 10^digits) when the values have at most
+ * four decimal places, otherwise float32 if that is exact, otherwise double. For the
+ * recorded sensors this is int16 throughout, i.e. 10 bytes per row.
+ *
+ * Values are always widened to double before they are accumulated.
+ *
+ * A store is either built in memory or mapped read-only from a file written by writeTo(),
+ * in which case the buffer is the file's pages and nothing is copied (see mapFile()).
+ */
+class ColumnStore {
+public:
+	/**
+	 * @enum Encoding
+	 * @brief Storage type of one metric column.
+	 */
+	enum Encoding {
+		ScaledInt16,  ///< int16 holding value * 10^digits.
+		ScaledInt32,  ///< int32 holding value * 10^digits.
+		Float32,      ///< float holding the value.
+		Float64       ///< double holding the value.
+	};
+
+	/**
+	 * @struct RowRange
+	 * @brief Rows [begin, end) of the store, read as elements [offset, offset + end - begin) of a ColumnView.
+	 */
+	struct RowRange {
+		size_t begin;   ///< First row.
+		size_t end;     ///< One past the last row.
+		size_t offset;  ///< View index of the first row (the sum of the lengths of the earlier ranges).
+	};
+
+	/**
+	 * @class ColumnView
+	 * @brief View of one column over a set of row ranges, read in its stored type and widened to double.
+	 *
+	 * Meets the view requirements of the Statistics templates, so they run over the store's
+	 * buffer without a decoded copy. The ranges are read back to back in the order given;
+	 * a single range is indexed directly, several are found by binary search on offset.
+	 * @tparam S The stored type.
+	 * @tparam Scaled True for the scaled integer encodings (the value is stored / scale).
+	 */
+	template <class S, bool Scaled>
+	class ColumnView {
+	public:
+		/**
+		 * @brief Constructor.
+		 * @param data A constant pointer to the column (row 0).
+		 * @param scale 10^digits (ignored unless Scaled).
+		 * @param ranges A constant pointer to the row ranges (must outlive the view).
+		 */
+		ColumnView(const S* data, double scale, const std::vector<RowRange>* ranges)
+			: data(data), scale(scale), ranges(ranges),
+			  count(ranges->empty() ? 0 : ranges->back().offset + ranges->back().end - ranges->back().begin) {}
+
+		/**
+		 * @brief Gets the number of elements.
+		 * @return size_t The total length of the ranges.
+		 */
+		size_t size() const { return count; }
+
+		/**
+		 * @brief Reads an element.
+		 * @param i The index.
+		 * @return double The value, widened as by copyColumn().
+		 */
+		double operator[](size_t i) const {
+			const RowRange* range = ranges->data();
+			if (ranges->size() > 1) {
+				range = std::upper_bound(range, range + ranges->size(), i,
+										 [](size_t index, const RowRange& r) { return index < r.offset; }) - 1;
+			}
+			double value = static_cast<double>(data[range->begin + (i - range->offset)]);
+			return Scaled ? value / scale : value;
+		}
+
+	private:
+		const S* data;                         ///< Column start.
+		double scale;                          ///< Scale divisor.
+		const std::vector<RowRange>* ranges;   ///< Rows read.
+		size_t count;                          ///< Number of elements.
+	};
+
+	/**
+	 * @brief Constructor. Copies the records into compact columns.
+	 * @param records A constant pointer to the records, sorted by date.
+	 */
+	explicit ColumnStore(const std::vector<WeatherRecord*>* records);
+
+	/**
+	 * @brief Merge constructor. Builds a new store holding the rows of base plus the records.
+	 *
+	 * Used to fold recent records into an existing store without going back to the
+	 * records it was built from. A record whose key base already holds is skipped.
+	 * @param base A constant pointer to the store to start from (may be nullptr).
+	 * @param records A constant pointer to the records to add, sorted by date.
+	 */
+	ColumnStore(const ColumnStore* base, const std::vector<WeatherRecord*>* records);
+
+	/**
+	 * @brief Erase constructor. Builds a copy of base without the rows [begin, end).
+	 *
+	 * The remaining rows keep their encodings and are copied as raw column slices, without
+	 * decoding. Used for retention (dropping a range of dates).
+	 * @param base A constant pointer to the store to copy.
+	 * @param begin The first row to leave out.
+	 * @param end One past the last row to leave out.
+	 */
+	ColumnStore(const ColumnStore* base, size_t begin, size_t end);
+
+	/**
+	 * @brief Copy constructor. Copies the column buffer.
+	 * @param other The store to copy.
+	 */
+	ColumnStore(const ColumnStore& other);
+
+	/**
+	 * @brief Assignment operator. Copies the column buffer.
+	 * @param other The store to copy.
+	 * @return ColumnStore& A reference to this store.
+	 */
+	ColumnStore& operator=(const ColumnStore& other);
+
+	/**
+	 * @brief Destructor. Frees the column buffer.
+	 */
+	~ColumnStore();
+
+	/**
+	 * @brief Writes the store in a binary form that readFrom() restores without re-encoding.
+	 * @param out A pointer to the output stream (opened in binary mode).
+	 * @return bool False if the stream failed.
+	 */
+	bool writeTo(std::ostream* out) const;
+
+	/**
+	 * @brief Reads a store written by writeTo(), or by an older version of it (a WCS1 store's wind direction reads as 0).
+	 * @param in A pointer to the input stream (opened in binary mode).
+	 * @return ColumnStore* A pointer to the new store, or nullptr if the data is not a valid store. Caller must delete it.
+	 */
+	static ColumnStore* readFrom(std::istream* in);
+
+	/**
+	 * @brief Maps a file written by writeTo() read-only and uses it as the buffer in place.
+	 *
+	 * Pages are read from disk when first touched and the kernel may drop them again under
+	 * memory pressure. Where memory mapping is unavailable, or the file has an older (WCS1 or
+	 * WCS2) layout, whose buffer is not aligned for mapping, it is read as by readFrom().
+	 * @param path A constant pointer to the file path.
+	 * @return ColumnStore* A pointer to the new store, or nullptr if the file is missing or not a valid store. Caller must delete it.
+	 */
+	static ColumnStore* mapFile(const std::string* path);
+
+	/**
+	 * @brief Tells whether the buffer is a file mapping rather than heap memory.
+	 * @return bool True for a store returned by mapFile().
+	 */
+	bool isMapped() const { return mapping != nullptr; }
+
+	/**
+	 * @brief Gets the number of rows.
+	 * @return size_t The row count.
+	 */
+	size_t size() const { return rowCount; }
+
+	/**
+	 * @brief Gets the minute key of a row.
+	 * @param row The row index.
+	 * @return int The key.
+	 */
+	int getKey(size_t row) const { return keys[row]; }
+
+	/**
+	 * @brief Gets one value, widened to double.
+	 * @param metric The column.
+	 * @param row The row index.
+	 * @return double The value.
+	 */
+	double getValue(Metric metric, size_t row) const;
+
+	/**
+	 * @brief Finds the first row whose key is not less than key.
+	 * @param key The minute key.
+	 * @return size_t The row index, or size() if every key is smaller.
+	 */
+	size_t lowerBound(int key) const;
+
+	/**
+	 * @brief Finds the first row at or after a hint whose key is not less than key.
+	 *
+	 * Gallops forward from the hint before binary searching, so resolving an ascending
+	 * run of keys costs the log of the gaps between them rather than of the whole store.
+	 * @param key The minute key.
+	 * @param first The row to start from (every earlier row must have a smaller key).
+	 * @return size_t The row index, or size() if every key is smaller.
+	 */
+	size_t lowerBound(int key, size_t first) const;
+
+	/**
+	 * @brief Copies the rows [begin, end) of a column into out as doubles.
+	 * @param metric The column.
+	 * @param begin The first row.
+	 * @param end One past the last row.
+	 * @param out Destination array of at least end - begin doubles.
+	 */
+	void copyColumn(Metric metric, size_t begin, size_t end, double* out) const;
+
+	/**
+	 * @brief Resolves a column's encoding once and passes a ColumnView of it to a callable.
+	 * @param metric The column.
+	 * @param ranges A constant pointer to the row ranges (must outlive the call).
+	 * @param visit Called once as visit(view), with a ColumnView specialized for the encoding.
+	 */
+	template <class Visit>
+	void visitColumn(Metric metric, const std::vector<RowRange>* ranges, Visit visit) const {
+		const Column& column = columns[static_cast<int>(metric)];
+		const unsigned char* data = buffer + column.offset;
+		switch (column.encoding) {
+			case ScaledInt16: visit(ColumnView<int16_t, true>(reinterpret_cast<const int16_t*>(data), column.scale, ranges)); break;
+			case ScaledInt32: visit(ColumnView<int32_t, true>(reinterpret_cast<const int32_t*>(data), column.scale, ranges)); break;
+			case Float32: visit(ColumnView<float, false>(reinterpret_cast<const float*>(data), 1.0, ranges)); break;
+			case Float64: visit(ColumnView<double, false>(reinterpret_cast<const double*>(data), 1.0, ranges)); break;
+		}
+	}
+
+	/**
+	 * @brief Aggregates a column over the rows with from <= key <= to.
+	 * @param metric The column.
+	 * @param from The first minute key of the range.
+	 * @param to The last minute key of the range (inclusive).
+	 * @return SeriesSummary The aggregates, accumulated in double.
+	 */
+	SeriesSummary summarize(Metric metric, int from, int to) const;
+
+	/**
+	 * @brief Gets the storage type chosen for a column.
+	 * @param metric The column.
+	 * @return Encoding The encoding.
+	 */
+	Encoding getEncoding(Metric metric) const { return columns[static_cast<int>(metric)].encoding; }
+
+	/**
+	 * @brief Gets the size of the column buffer plus the object itself.
+	 * @return size_t The size in bytes.
+	 */
+	size_t getMemoryBytes() const { return sizeof(*this) + bufferBytes; }
+
+private:
+	/**
+	 * @struct Column
+	 * @brief Location and encoding of one metric column inside the buffer.
+	 */
+	struct Column {
+		Encoding encoding;  ///< Storage type.
+		int scaleDigits;    ///< Decimal places for the scaled encodings.
+		double scale;       ///< 10^scaleDigits.
+		size_t offset;      ///< Byte offset of the column in the buffer.
+	};
+
+	/**
+	 * @brief Constructor used by readFrom(). Creates an empty store.
+	 */
+	ColumnStore();
+
+	/**
+	 * @brief Reads and checks the magic tag, row count and column descriptors written by writeTo() or an older version of it.
+	 * @param in The input stream, positioned at the start of the store.
+	 * @param version Receives the layout version.
+	 * @return bool False if the layout is truncated, of an unknown version or inconsistent.
+	 */
+	bool readLayout(std::istream* in, int* version);
+
+	/**
+	 * @brief Frees the heap buffer or unmaps the file.
+	 */
+	void release();
+
+	/**
+	 * @brief Chooses the narrowest exact encoding for a set of values.
+	 * @param values The values.
+	 * @param column Receives the encoding and scale.
+	 */
+	static void chooseEncoding(const std::vector<double>* values, Column* column);
+
+	/**
+	 * @brief Chooses the column encodings and fills the buffer.
+	 * @param keyValues The minute keys, ascending.
+	 * @param values kMetricCount value columns, each as long as keyValues.
+	 */
+	void pack(const std::vector<int32_t>* keyValues, const std::vector<double>* values);
+
+	size_t rowCount;                ///< Number of rows.
+	size_t bufferBytes;             ///< Size of buffer.
+	unsigned char* buffer;          ///< All columns, each starting on an 8 byte boundary.
+	const int32_t* keys;            ///< Key column (points into buffer).
+	Column columns[kMetricCount];   ///< Metric columns.
+	void* mapping;                  ///< Start of the file mapping, or nullptr for a heap buffer.
+	size_t mappingBytes;            ///< Length of the file mapping.
+};
+
+#endif // COLUMNSTORE_H
@@ -0,0 +1,428 @@
+// CompressedSeries.cpp
+
+// Implements CompressedSeries: block-wise delta-of-delta timestamp encoding,
+// scaled-integer or XOR value encoding, and summary-driven range queries.
+
+#include "CompressedSeries.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+	const double kPow10[5] = {1.0, 10.0, 100.0, 1000.0, 10000.0};
+
+	/**
+	 * @class BitWriter
+	 * @brief Appends bit fields, most significant bit first, to a byte vector.
+	 */
+	class BitWriter {
+	public:
+		explicit BitWriter(std::vector<uint8_t>* bytes) : bytes(bytes), used(0) {}
+
+		/**
+		 * @brief Writes the low n bits of value.
+		 *
+		 * @param  value - The bits to write.
+		 * @param  n - Number of bits (0-64).
+		 * @return void
+		 */
+		void write(uint64_t value, int n) {
+			while (n > 0) {
+				if (used == 0) bytes->push_back(0);
+				int space = 8 - used;
+				int take = n < space ? n : space;
+				uint8_t chunk = static_cast<uint8_t>((value >> (n - take)) & ((1u << take) - 1));
+				bytes->back() |= static_cast<uint8_t>(chunk << (space - take));
+				used = (used + take) & 7;
+				n -= take;
+			}
+		}
+
+		/**
+		 * @brief Writes a signed integer in a variable number of bits (small magnitudes are cheapest).
+		 *
+		 * @param  value - The value to write.
+		 * @return void
+		 */
+		void writeSigned(int64_t value) {
+			uint64_t z = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63); // zigzag
+			if (z == 0) {
+				write(0, 1);
+			} else if (z < (1u << 7)) {
+				write(2, 2);
+				write(z, 7);
+			} else if (z < (1u << 12)) {
+				write(6, 3);
+				write(z, 12);
+			} else if (z < (1u << 20)) {
+				write(14, 4);
+				write(z, 20);
+			} else {
+				write(15, 4);
+				write(z, 64);
+			}
+		}
+
+	private:
+		std::vector<uint8_t>* bytes;
+		int used; // Bits used in the last byte (0 means a new byte is needed)
+	};
+
+	/**
+	 * @class BitReader
+	 * @brief Reads back the bit fields written by BitWriter.
+	 */
+	class BitReader {
+	public:
+		explicit BitReader(const std::vector<uint8_t>* bytes) : bytes(bytes), pos(0) {}
+
+		/**
+		 * @brief Reads n bits.
+		 *
+		 * @param  n - Number of bits (0-64).
+		 * @return uint64_t - The bits read, right aligned.
+		 */
+		uint64_t read(int n) {
+			uint64_t value = 0;
+			while (n > 0) {
+				int offset = static_cast<int>(pos & 7);
+				int space = 8 - offset;
+				int take = n < space ? n : space;
+				uint8_t byte = (*bytes)[pos >> 3];
+				value = (value << take) | ((byte >> (space - take)) & ((1u << take) - 1));
+				pos += take;
+				n -= take;
+			}
+			return value;
+		}
+
+		/**
+		 * @brief Reads an integer written by BitWriter::writeSigned.
+		 *
+		 * @return int64_t - The value.
+		 */
+		int64_t readSigned() {
+			uint64_t z;
+			if (read(1) == 0) return 0;
+			if (read(1) == 0) z = read(7);
+			else if (read(1) == 0) z = read(12);
+			else if (read(1) == 0) z = read(20);
+			else z = read(64);
+			return static_cast<int64_t>(z >> 1) ^ -static_cast<int64_t>(z & 1);
+		}
+
+	private:
+		const std::vector<uint8_t>* bytes;
+		size_t pos; // Next bit to read
+	};
+
+	/**
+	 * @brief Reinterprets a double as its IEEE-754 bit pattern.
+	 *
+	 * @param  value - The double.
+	 * @return uint64_t - Its bits.
+	 */
+	uint64_t toBits(double value) {
+		uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	/**
+	 * @brief Reinterprets an IEEE-754 bit pattern as a double.
+	 *
+	 * @param  bits - The bits.
+	 * @return double - The double.
+	 */
+	double fromBits(uint64_t bits) {
+		double value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	/**
+	 * @brief Adds one value to a summary.
+	 *
+	 * @param  summary - The summary to update.
+	 * @param  value - The value.
+	 * @return void
+	 */
+	void addValue(SeriesSummary* summary, double value) {
+		if (summary->count == 0 || value < summary->min) summary->min = value;
+		if (summary->count == 0 || value > summary->max) summary->max = value;
+		summary->count += 1;
+		summary->sum += value;
+		summary->sumSq += value * value;
+	}
+}
+
+	/**
+	 * @brief Constructor for CompressedSeries.
+	 *
+	 * @param  blockSize - Points per block (values below 2 are raised to 2).
+	 * @return void
+	 */
+CompressedSeries::CompressedSeries(size_t blockSize)
+	: blockSize(blockSize < 2 ? 2 : blockSize), pointCount(0), hasLast(false), lastKey(0) {}
+
+	/**
+	 * @brief Appends one point to the open block, compressing it once it is full.
+	 *
+	 * @param  minuteKey - The timestamp of the point.
+	 * @param  value - The value of the point.
+	 * @return bool - False if the timestamp is earlier than the previous one.
+	 */
+bool CompressedSeries::append(int minuteKey, double value) {
+	if (hasLast && minuteKey < lastKey) return false;
+
+	openKeys.push_back(minuteKey);
+	openValues.push_back(value);
+	lastKey = minuteKey;
+	hasLast = true;
+	++pointCount;
+
+	if (openKeys.size() == blockSize) flushOpen();
+	return true;
+}
+
+	/**
+	 * @brief Compresses the open block if it holds any points.
+	 *
+	 * @return void
+	 */
+void CompressedSeries::seal() {
+	if (!openKeys.empty()) flushOpen();
+}
+
+	/**
+	 * @brief Returns the smallest number of decimal places that reproduces every value bit for bit.
+	 *
+	 * @param  values - The values.
+	 * @param  count - Number of values.
+	 * @return int - 0 to 4, or -1 if none fits.
+	 */
+int CompressedSeries::chooseScale(const double* values, size_t count) {
+	for (int digits = 0; digits <= 4; ++digits) {
+		bool exact = true;
+		for (size_t i = 0; i < count && exact; ++i) {
+			double scaled = values[i] * kPow10[digits];
+			if (!(std::fabs(scaled) < 1e15)) {
+				exact = false; // Also rejects NaN and infinities
+			} else {
+				double q = static_cast<double>(std::llround(scaled));
+				exact = (q / kPow10[digits] == values[i]) && !(values[i] == 0.0 && std::signbit(values[i]));
+			}
+		}
+		if (exact) return digits;
+	}
+	return -1;
+}
+
+	/**
+	 * @brief Encodes the open points into a block and records its summary.
+	 *
+	 * Timestamps: the first is kept in the header, then the first delta, then delta-of-deltas.
+	 * Values: deltas of scaled integers, or XOR against the previous value with the
+	 * leading/trailing zero window of the previous XOR reused when it fits.
+	 *
+	 * @return void
+	 */
+void CompressedSeries::flushOpen() {
+	size_t count = openKeys.size();
+
+	Block block;
+	block.firstKey = openKeys.front();
+	block.lastKey = openKeys.back();
+	block.count = static_cast<unsigned>(count);
+	block.scaleDigits = chooseScale(openValues.data(), count);
+
+	SeriesSummary summary = {0, 0.0, 0.0, 0.0, 0.0};
+	for (size_t i = 0; i < count; ++i) addValue(&summary, openValues[i]);
+	block.min = summary.min;
+	block.max = summary.max;
+	block.sum = summary.sum;
+	block.sumSq = summary.sumSq;
+
+	BitWriter writer(&block.bits);
+	int64_t previousDelta = 0;
+	int64_t previousScaled = 0;
+	uint64_t previousBits = 0;
+	int windowLead = -1;
+	int windowTrail = 0;
+
+	for (size_t i = 0; i < count; ++i) {
+		if (i > 0) {
+			int64_t delta = static_cast<int64_t>(openKeys[i]) - openKeys[i - 1];
+			writer.writeSigned(i == 1 ? delta : delta - previousDelta);
+			previousDelta = delta;
+		}
+
+		if (block.scaleDigits >= 0) {
+			int64_t scaled = std::llround(openValues[i] * kPow10[block.scaleDigits]);
+			writer.writeSigned(scaled - previousScaled);
+			previousScaled = scaled;
+		} else {
+			uint64_t bits = toBits(openValues[i]);
+			if (i == 0) {
+				writer.write(bits, 64);
+			} else {
+				uint64_t x = bits ^ previousBits;
+				if (x == 0) {
+					writer.write(0, 1);
+				} else {
+					int lead = __builtin_clzll(x);
+					int trail = __builtin_ctzll(x);
+					if (windowLead >= 0 && lead >= windowLead && trail >= windowTrail) {
+						writer.write(2, 2);
+						writer.write(x >> windowTrail, 64 - windowLead - windowTrail);
+					} else {
+						int length = 64 - lead - trail;
+						writer.write(3, 2);
+						writer.write(static_cast<uint64_t>(lead), 6);
+						writer.write(static_cast<uint64_t>(length - 1), 6);
+						writer.write(x >> trail, length);
+						windowLead = lead;
+						windowTrail = trail;
+					}
+				}
+			}
+			previousBits = bits;
+		}
+	}
+
+	block.bits.shrink_to_fit();
+	blocks.push_back(std::move(block));
+
+	openKeys.clear();
+	openValues.clear();
+}
+
+	/**
+	 * @brief Decodes all points of a block (inverse of flushOpen).
+	 *
+	 * @param  block - The block.
+	 * @param  keys - Receives the timestamps.
+	 * @param  values - Receives the values.
+	 * @return void
+	 */
+void CompressedSeries::decode(const Block& block, std::vector<int>* keys, std::vector<double>* values) {
+	keys->resize(block.count);
+	values->resize(block.count);
+
+	BitReader reader(&block.bits);
+	int64_t key = block.firstKey;
+	int64_t delta = 0;
+	int64_t scaled = 0;
+	uint64_t bits = 0;
+	int windowLead = 0;
+	int windowTrail = 0;
+
+	for (unsigned i = 0; i < block.count; ++i) {
+		if (i == 1) {
+			delta = reader.readSigned();
+			key += delta;
+		} else if (i > 1) {
+			delta += reader.readSigned();
+			key += delta;
+		}
+		(*keys)[i] = static_cast<int>(key);
+
+		if (block.scaleDigits >= 0) {
+			scaled += reader.readSigned();
+			(*values)[i] = static_cast<double>(scaled) / kPow10[block.scaleDigits];
+		} else {
+			if (i == 0) {
+				bits = reader.read(64);
+			} else if (reader.read(1) == 1) {
+				if (reader.read(1) == 1) {
+					windowLead = static_cast<int>(reader.read(6));
+					int length = static_cast<int>(reader.read(6)) + 1;
+					windowTrail = 64 - windowLead - length;
+				}
+				bits ^= reader.read(64 - windowLead - windowTrail) << windowTrail;
+			}
+			(*values)[i] = fromBits(bits);
+		}
+	}
+}
+
+	/**
+	 * @brief Visits the points in [from, to], decoding only blocks that overlap the range.
+	 *
+	 * @param  from - First timestamp of the range.
+	 * @param  to - Last timestamp of the range (inclusive).
+	 * @param  visit - Function called per point.
+	 * @param  context - Opaque pointer passed to visit.
+	 * @return void
+	 */
+void CompressedSeries::forEachInRange(int from, int to, PointVisitor visit, void* context) const {
+	std::vector<int> keys;
+	std::vector<double> values;
+
+	auto first = std::lower_bound(blocks.begin(), blocks.end(), from,
+								  [](const Block& block, int key) { return block.lastKey < key; });
+	for (auto it = first; it != blocks.end() && it->firstKey <= to; ++it) {
+		decode(*it, &keys, &values);
+		for (size_t i = 0; i < keys.size(); ++i) {
+			if (keys[i] >= from && keys[i] <= to) visit(keys[i], values[i], context);
+		}
+	}
+
+	for (size_t i = 0; i < openKeys.size(); ++i) {
+		if (openKeys[i] >= from && openKeys[i] <= to) visit(openKeys[i], openValues[i], context);
+	}
+}
+
+	/**
+	 * @brief Aggregates the points in [from, to].
+	 *
+	 * Blocks entirely inside the range contribute their stored summary without being
+	 * decoded; only the (at most two) boundary blocks are decoded.
+	 *
+	 * @param  from - First timestamp of the range.
+	 * @param  to - Last timestamp of the range (inclusive).
+	 * @return SeriesSummary - The aggregates.
+	 */
+SeriesSummary CompressedSeries::summarize(int from, int to) const {
+	SeriesSummary summary = {0, 0.0, 0.0, 0.0, 0.0};
+	std::vector<int> keys;
+	std::vector<double> values;
+
+	auto first = std::lower_bound(blocks.begin(), blocks.end(), from,
+								  [](const Block& block, int key) { return block.lastKey < key; });
+	for (auto it = first; it != blocks.end() && it->firstKey <= to; ++it) {
+		if (it->firstKey >= from && it->lastKey <= to) {
+			if (summary.count == 0 || it->min < summary.min) summary.min = it->min;
+			if (summary.count == 0 || it->max > summary.max) summary.max = it->max;
+			summary.count += it->count;
+			summary.sum += it->sum;
+			summary.sumSq += it->sumSq;
+			continue;
+		}
+
+		decode(*it, &keys, &values);
+		for (size_t i = 0; i < keys.size(); ++i) {
+			if (keys[i] >= from && keys[i] <= to) addValue(&summary, values[i]);
+		}
+	}
+
+	for (size_t i = 0; i < openKeys.size(); ++i) {
+		if (openKeys[i] >= from && openKeys[i] <= to) addValue(&summary, openValues[i]);
+	}
+
+	return summary;
+}
+
+	/**
+	 * @brief Returns the heap and object memory used by the series.
+	 *
+	 * @return size_t - Size in bytes.
+	 */
+size_t CompressedSeries::getMemoryBytes() const {
+	size_t bytes = sizeof(*this) + blocks.capacity() * sizeof(Block);
+	for (const Block& block : blocks) {
+		bytes += block.bits.capacity();
+	}
+	bytes += openKeys.capacity() * sizeof(int) + openValues.capacity() * sizeof(double);
+	return bytes;
+}
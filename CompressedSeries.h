@@ -0,0 +1,148 @@
+#ifndef COMPRESSEDSERIES_H
+#define COMPRESSEDSERIES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct SeriesSummary
+ * @brief Aggregates of the values of a time range of a CompressedSeries or ColumnStore.
+ */
+struct SeriesSummary {
+	unsigned long count; ///< Number of points.
+	double sum;          ///< Sum of the values.
+	double sumSq;        ///< Sum of the squared values.
+	double min;          ///< Smallest value (undefined when count is 0).
+	double max;          ///< Largest value (undefined when count is 0).
+};
+
+/**
+ * @class CompressedSeries
+ * @brief Compressed in-memory column of (timestamp, value) points in time order.
+ *
+ * Points are grouped into blocks of a fixed number of points. Within a block the
+ * timestamps (minute keys, see Date::toMinuteKey) are stored as delta-of-deltas, so
+ * the regular 10 minute spacing of the data costs one bit per point. Values are
+ * stored as deltas of scaled integers when every value of the block has at most four
+ * decimal places (the case for all recorded sensors), and otherwise as XORs of
+ * consecutive doubles (Gorilla encoding). Both encodings are lossless.
+ *
+ * Every block keeps its time span and the count, min, max, sum and sum of squares of
+ * its values. Range queries skip blocks outside the range, answer fully covered
+ * blocks from their summary, and only decode blocks that straddle a range boundary.
+ *
+ * Points are appended in time order; the last, partially filled block is kept
+ * uncompressed until it fills up or seal() is called.
+ */
+class CompressedSeries {
+public:
+	/**
+	 * @brief Function called for each point visited by forEachInRange.
+	 */
+	typedef void (*PointVisitor)(int minuteKey, double value, void* context);
+
+	/**
+	 * @brief Constructor.
+	 * @param blockSize Number of points per compressed block (at least 2).
+	 */
+	explicit CompressedSeries(size_t blockSize = 1024);
+
+	/**
+	 * @brief Appends a point. Timestamps must not decrease.
+	 * @param minuteKey The timestamp of the point.
+	 * @param value The value of the point.
+	 * @return bool False (and nothing is stored) if the timestamp is earlier than the last one.
+	 */
+	bool append(int minuteKey, double value);
+
+	/**
+	 * @brief Compresses the open block, if any. Appending afterwards starts a new block.
+	 */
+	void seal();
+
+	/**
+	 * @brief Visits the points with from <= minuteKey <= to, in time order.
+	 * @param from The first timestamp of the range.
+	 * @param to The last timestamp of the range (inclusive).
+	 * @param visit The function called for each point.
+	 * @param context Opaque pointer passed to visit.
+	 */
+	void forEachInRange(int from, int to, PointVisitor visit, void* context) const;
+
+	/**
+	 * @brief Aggregates the points with from <= minuteKey <= to.
+	 * @param from The first timestamp of the range.
+	 * @param to The last timestamp of the range (inclusive).
+	 * @return SeriesSummary The aggregates (count 0 if the range is empty).
+	 */
+	SeriesSummary summarize(int from, int to) const;
+
+	/**
+	 * @brief Gets the number of stored points.
+	 * @return size_t The point count.
+	 */
+	size_t size() const { return pointCount; }
+
+	/**
+	 * @brief Gets the number of compressed blocks (the open block is not counted).
+	 * @return size_t The block count.
+	 */
+	size_t getBlockCount() const { return blocks.size(); }
+
+	/**
+	 * @brief Gets the memory held by the series, including block headers and the open block.
+	 * @return size_t The size in bytes.
+	 */
+	size_t getMemoryBytes() const;
+
+	/**
+	 * @brief Picks the number of decimal places that represents every value exactly.
+	 *
+	 * With the result d, value == llround(value * 10^d) / 10^d holds bit for bit for every value.
+	 * @param values The values.
+	 * @param count The number of values.
+	 * @return int 0 to 4, or -1 if no scale represents them all.
+	 */
+	static int chooseScale(const double* values, size_t count);
+
+private:
+	/**
+	 * @struct Block
+	 * @brief One compressed run of points and its summary.
+	 */
+	struct Block {
+		int firstKey;               ///< Timestamp of the first point.
+		int lastKey;                ///< Timestamp of the last point.
+		unsigned count;             ///< Number of points.
+		int scaleDigits;            ///< Decimal places of the scaled integer encoding, or -1 for XOR encoding.
+		double min;                 ///< Smallest value.
+		double max;                 ///< Largest value.
+		double sum;                 ///< Sum of the values.
+		double sumSq;               ///< Sum of the squared values.
+		std::vector<uint8_t> bits;  ///< Encoded timestamps and values.
+	};
+
+	/**
+	 * @brief Encodes the open points into a new block and clears them.
+	 */
+	void flushOpen();
+
+	/**
+	 * @brief Decodes every point of a block.
+	 * @param block The block to decode.
+	 * @param keys Receives the timestamps.
+	 * @param values Receives the values.
+	 */
+	static void decode(const Block& block, std::vector<int>* keys, std::vector<double>* values);
+
+	size_t blockSize;                ///< Points per block.
+	size_t pointCount;               ///< Total stored points.
+	bool hasLast;                    ///< True once a point has been appended.
+	int lastKey;                     ///< Timestamp of the last appended point.
+	std::vector<Block> blocks;       ///< Compressed blocks, in time order.
+	std::vector<int> openKeys;       ///< Timestamps of the open block.
+	std::vector<double> openValues;  ///< Values of the open block.
+};
+
+#endif // COMPRESSEDSERIES_H
@@ -48,6 +48,16 @@ int Date::GetMonth() const { return month; }
 	 */
 int Date::GetYear() const { return year; }
 
+	/**
+	 * @brief Retrieves the zero-based day index within a 366-day year.
+	 *
+	 * @return int - The day index (0-365); February 29 is 59 in every year.
+	 */
+int Date::GetDayOfYear() const {
+	static const int monthStart[12] = {0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335};
+	return monthStart[month - 1] + day - 1;
+}
+
 	/**
 	 * @brief Sets the day component.
 	 *
@@ -85,6 +95,68 @@ std::string* Date::toString() const {
 						   " " + std::to_string(hour) + ":" + std::to_string(minute));
 }
 
+	/**
+	 * @brief Converts the date and time to minutes since 1/1/1970 00:00.
+	 *
+	 * Uses the proleptic Gregorian day count, so the result is valid for any year.
+	 *
+	 * @return int - The minute key.
+	 */
+int Date::toMinuteKey() const {
+	// Shift the year to start in March so the leap day is the last day of the year
+	int y = year - (month <= 2 ? 1 : 0);
+	int era = (y >= 0 ? y : y - 399) / 400;
+	int yearOfEra = y - era * 400;
+	int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+	int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+	int days = era * 146097 + dayOfEra - 719468;
+
+	return days * 1440 + hour * 60 + minute;
+}
+
+	/**
+	 * @brief Creates a Date from a minute key (inverse of toMinuteKey).
+	 *
+	 * @param  key - Minutes since 1/1/1970 00:00.
+	 * @return Date* - Pointer to the new Date object. Caller must delete it.
+	 */
+Date* Date::fromMinuteKey(int key) {
+	Date* date = new Date();
+	date->setMinuteKey(key);
+	return date;
+}
+
+	/**
+	 * @brief Sets the date and time from a minute key (inverse of toMinuteKey).
+	 *
+	 * @param  key - Minutes since 1/1/1970 00:00.
+	 * @return void
+	 */
+void Date::setMinuteKey(int key) {
+	int days = key / 1440;
+	int minutes = key % 1440;
+	if (minutes < 0) {
+		minutes += 1440;
+		--days;
+	}
+
+	int z = days + 719468;
+	int era = (z >= 0 ? z : z - 146096) / 146097;
+	int dayOfEra = z - era * 146097;
+	int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+	int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+	int mp = (5 * dayOfYear + 2) / 153;
+	int d = dayOfYear - (153 * mp + 2) / 5 + 1;
+	int m = mp < 10 ? mp + 3 : mp - 9;
+	int y = yearOfEra + era * 400 + (m <= 2 ? 1 : 0);
+
+	day = d;
+	month = m;
+	year = y;
+	hour = minutes / 60;
+	minute = minutes % 60;
+}
+
 	/**
 	 * @brief Overloads the less-than operator for Date comparison.
 	 *
@@ -66,6 +66,15 @@ public:
 	 */
 	int GetMinute() const { return minute; }
 
+	/**
+	 * @brief Gets the position of the date within a 366-day year.
+	 *
+	 * February 29 always has index 59 and March 1 always index 60, so a given calendar
+	 * day maps to the same index in leap and non-leap years.
+	 * @return int The zero-based day index (0-365).
+	 */
+	int GetDayOfYear() const;
+
 	/**
 	 * @brief Sets the day component of the Date object.
 	 * @param d The new day value.
@@ -102,6 +111,28 @@ public:
 	 */
 	std::string* toString() const;
 
+	/**
+	 * @brief Converts the date and time to a single sortable integer key.
+	 *
+	 * Keys compare exactly like the dates they represent and consecutive observations
+	 * differ by their spacing in minutes, which makes them cheap to delta-encode.
+	 * @return int Minutes elapsed since 1/1/1970 00:00.
+	 */
+	int toMinuteKey() const;
+
+	/**
+	 * @brief Creates a Date from a key produced by toMinuteKey().
+	 * @param key Minutes elapsed since 1/1/1970 00:00.
+	 * @return Date* Pointer to the new Date object. Caller must delete it.
+	 */
+	static Date* fromMinuteKey(int key);
+
+	/**
+	 * @brief Sets this Date to the date and time of a key produced by toMinuteKey().
+	 * @param key Minutes elapsed since 1/1/1970 00:00.
+	 */
+	void setMinuteKey(int key);
+
 	// Comparison operators (reference params so Bst comparisons compile)
 	/**
 	 * @brief Comparison operator to check if this Date is chronologically less than another.
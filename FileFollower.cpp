@@ -0,0 +1,264 @@
+// FileFollower.cpp
+
+// Implements FileFollower: per-file byte offsets, incremental parsing of newly
+// appended complete lines, and change notification through inotify or polling.
+
+#include "FileFollower.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+const long FileFollower::kMaxReadBytes;
+
+	/**
+	 * @brief Constructor for FileFollower. Opens an inotify instance on Linux.
+	 *
+	 * @param  parse - The line parser.
+	 * @param  pollIntervalMs - Interval between checks when polling.
+	 * @return void
+	 */
+FileFollower::FileFollower(ParseFunction parse, int pollIntervalMs)
+	: parse(parse), pollIntervalMs(pollIntervalMs > 0 ? pollIntervalMs : 1), inotifyFd(-1),
+	  bytesConsumed(0), recordsDelivered(0) {
+#ifdef __linux__
+	inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+
+	/**
+	 * @brief Destructor for FileFollower.
+	 *
+	 * @return void
+	 */
+FileFollower::~FileFollower() {
+#ifdef __linux__
+	if (inotifyFd >= 0) close(inotifyFd);
+#endif
+}
+
+	/**
+	 * @brief Watches the directory of a file for writes, creations and renames.
+	 *
+	 * The directory rather than the file is watched so that a file that is replaced or
+	 * created later is still noticed. If the watch cannot be added the follower falls
+	 * back to polling.
+	 *
+	 * @param  path - Pointer to the file path.
+	 * @return void
+	 */
+void FileFollower::watchDirectoryOf(const std::string* path) {
+#ifdef __linux__
+	if (inotifyFd < 0) return;
+
+	size_t slash = path->find_last_of('/');
+	std::string dir = (slash == std::string::npos) ? "." : path->substr(0, slash + 1);
+	if (std::find(watchedDirs.begin(), watchedDirs.end(), dir) != watchedDirs.end()) return;
+
+	if (inotify_add_watch(inotifyFd, dir.c_str(), IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_TO) < 0) {
+		close(inotifyFd);
+		inotifyFd = -1;
+		return;
+	}
+	watchedDirs.push_back(dir);
+#else
+	(void)path;
+#endif
+}
+
+	/**
+	 * @brief Starts following a file.
+	 *
+	 * When not reading from the start, the offset is placed after the last complete line,
+	 * so a line still being written is delivered once it is finished.
+	 *
+	 * @param  path - Pointer to the file path.
+	 * @param  fromStart - True to deliver the existing contents as well.
+	 * @return bool - False if the file could not be opened.
+	 */
+bool FileFollower::follow(std::string* path, bool fromStart) {
+	std::ifstream in(*path, std::ios::binary);
+	if (!in.is_open()) return false;
+
+	FollowedFile file = {*path, 0, true, CsvLayout::standard()};
+	if (!fromStart) {
+		// Lines appended later are laid out as the existing header says
+		std::string header;
+		std::getline(in, header);
+		file.layout = CsvLayout::fromHeader(&header);
+		in.clear();
+
+		in.seekg(0, std::ios::end);
+		long size = static_cast<long>(in.tellg());
+
+		// Walk back from the end to just after the last newline
+		const long kStep = 4096;
+		long end = size;
+		std::string block;
+		while (end > 0) {
+			long begin = std::max(0L, end - kStep);
+			block.resize(end - begin);
+			in.seekg(begin);
+			in.read(&block[0], end - begin);
+			size_t newline = block.rfind('\n');
+			if (newline != std::string::npos) {
+				file.offset = begin + static_cast<long>(newline) + 1;
+				file.headerPending = false;
+				break;
+			}
+			end = begin;
+		}
+	}
+
+	files.push_back(file);
+	watchDirectoryOf(path);
+	return true;
+}
+
+	/**
+	 * @brief Follows each CSV named in a list file.
+	 *
+	 * @param  listFilename - Pointer to the name of the file listing the CSVs (relative to data/).
+	 * @param  fromStart - True to deliver the existing contents as well.
+	 * @return bool - False if the list file could not be opened.
+	 */
+bool FileFollower::followList(std::string* listFilename, bool fromStart) {
+	std::ifstream listFile(*listFilename);
+	if (!listFile.is_open()) return false;
+
+	std::string csvFileName;
+	while (std::getline(listFile, csvFileName)) {
+		csvFileName.erase(std::remove(csvFileName.begin(), csvFileName.end(), '\r'), csvFileName.end());
+		if (csvFileName.empty()) continue;
+
+		std::string fullPath = "data/" + csvFileName;
+		if (!follow(&fullPath, fromStart)) {
+			// Not created yet: follow it from its first line once it appears
+			files.push_back(FollowedFile{fullPath, 0, true, CsvLayout::standard()});
+			watchDirectoryOf(&fullPath);
+		}
+	}
+	return true;
+}
+
+	/**
+	 * @brief Parses the complete lines appended to a file since its offset and advances the offset.
+	 *
+	 * @param  file - Pointer to the followed file.
+	 * @param  records - Pointer to the vector receiving the parsed records.
+	 * @return void
+	 */
+void FileFollower::readNewLines(FollowedFile* file, std::vector<WeatherRecord*>* records) {
+	std::ifstream in(file->path, std::ios::binary);
+	if (!in.is_open()) return;
+
+	in.seekg(0, std::ios::end);
+	long size = static_cast<long>(in.tellg());
+	if (size < file->offset) {
+		// Truncated or replaced: start over
+		file->offset = 0;
+		file->headerPending = true;
+	}
+	if (size == file->offset) return;
+
+	long length = std::min(size - file->offset, kMaxReadBytes);
+	std::string buffer(static_cast<size_t>(length), '\0');
+	in.seekg(file->offset);
+	in.read(&buffer[0], length);
+
+	size_t last = buffer.rfind('\n');
+	if (last == std::string::npos) {
+		// No complete line yet, unless the line is longer than anything we read at once
+		if (length == kMaxReadBytes) file->offset += length;
+		return;
+	}
+
+	size_t begin = 0;
+	while (begin <= last) {
+		size_t end = buffer.find('\n', begin);
+		std::string line = buffer.substr(begin, end - begin);
+		begin = end + 1;
+
+		line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
+		if (file->headerPending) {
+			file->headerPending = false;
+			file->layout = CsvLayout::fromHeader(&line);
+			continue;
+		}
+		if (line.empty()) continue;
+
+		WeatherRecord* record = parse(&line, &file->layout);
+		if (record != nullptr) records->push_back(record);
+	}
+
+	file->offset += static_cast<long>(last) + 1;
+	bytesConsumed += static_cast<unsigned long>(last) + 1;
+}
+
+	/**
+	 * @brief Reads every followed file once and hands the new records to the sink.
+	 *
+	 * @param  sink - The function receiving the records.
+	 * @param  context - Opaque pointer passed to sink.
+	 * @return size_t - The number of records delivered.
+	 */
+size_t FileFollower::poll(BatchSink sink, void* context) {
+	std::vector<WeatherRecord*> records;
+	for (FollowedFile& file : files) {
+		readNewLines(&file, &records);
+	}
+
+	size_t count = records.size();
+	if (count > 0) {
+		recordsDelivered += count;
+		sink(&records, context);
+	}
+	return count;
+}
+
+	/**
+	 * @brief Waits for an inotify event on a watched directory, or sleeps when polling.
+	 *
+	 * All pending events are drained; the caller polls every file anyway.
+	 *
+	 * @param  timeoutMs - The longest wait in milliseconds.
+	 * @return bool - True if a change may have happened.
+	 */
+bool FileFollower::waitForChange(int timeoutMs) {
+#ifdef __linux__
+	if (inotifyFd >= 0) {
+		pollfd descriptor = {inotifyFd, POLLIN, 0};
+		if (::poll(&descriptor, 1, timeoutMs) <= 0) return false;
+
+		char events[4096];
+		while (read(inotifyFd, events, sizeof(events)) > 0) {
+		}
+		return true;
+	}
+#endif
+	std::this_thread::sleep_for(std::chrono::milliseconds(std::min(timeoutMs, pollIntervalMs)));
+	return true;
+}
+
+	/**
+	 * @brief Follows the files until stop is set.
+	 *
+	 * @param  sink - The function receiving the records.
+	 * @param  context - Opaque pointer passed to sink.
+	 * @param  stop - Pointer to the flag ending the loop.
+	 * @return void
+	 */
+void FileFollower::run(BatchSink sink, void* context, const std::atomic<bool>* stop) {
+	poll(sink, context);
+	while (!stop->load()) {
+		// The inotify wait is bounded too, so a file created in an unwatched way is still picked up
+		waitForChange(pollIntervalMs);
+		poll(sink, context);
+	}
+}
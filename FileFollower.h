@@ -0,0 +1,146 @@
+#ifndef FILEFOLLOWER_H
+#define FILEFOLLOWER_H
+
+#include "WeatherRecord.h"
+#include <atomic>
+#include <string>
+#include <vector>
+
+/**
+ * @class FileFollower
+ * @brief Tail-follows growing CSV files and delivers only newly appended records.
+ *
+ * Each followed file remembers the byte offset consumed so far. A poll reads what was
+ * appended since, parses the complete lines, and leaves a trailing partial line for the
+ * next poll. A file that shrinks is assumed truncated or replaced and is read again from
+ * its start, header included.
+ *
+ * On Linux, changes are waited for with inotify on the directories of the followed files,
+ * so an idle follower costs no CPU. Elsewhere, or if inotify is unavailable, waitForChange
+ * falls back to sleeping for the poll interval. Either way, poll() is what reads the files.
+ */
+class FileFollower {
+public:
+	/**
+	 * @brief Line parser (e.g. WeatherDataCollection::parseRecord). Returns nullptr for unusable lines.
+	 */
+	typedef WeatherRecord* (*ParseFunction)(std::string* line, const CsvLayout* layout);
+
+	/**
+	 * @brief Receives the new records of a poll, in file order. Takes ownership of the records.
+	 */
+	typedef void (*BatchSink)(std::vector<WeatherRecord*>* records, void* context);
+
+	/**
+	 * @brief Constructor. Sets up inotify when available.
+	 * @param parse The line parser.
+	 * @param pollIntervalMs Interval between checks when inotify is not used.
+	 */
+	explicit FileFollower(ParseFunction parse, int pollIntervalMs = 1000);
+
+	/**
+	 * @brief Destructor. Closes the inotify descriptor.
+	 */
+	~FileFollower();
+
+	/**
+	 * @brief Follows one file.
+	 * @param path A pointer to the file path.
+	 * @param fromStart True to deliver the existing contents too; false to start after the
+	 * last complete line (e.g. when the file has already been loaded).
+	 * @return bool False if the file could not be opened.
+	 */
+	bool follow(std::string* path, bool fromStart);
+
+	/**
+	 * @brief Follows every file named in a list file (CSV names relative to data/).
+	 * @param listFilename A pointer to the name of the list file.
+	 * @param fromStart As for follow().
+	 * @return bool False if the list file could not be opened.
+	 */
+	bool followList(std::string* listFilename, bool fromStart);
+
+	/**
+	 * @brief Reads what was appended to each file since the last poll and delivers the new records.
+	 * @param sink The function receiving the records (called once if there are any).
+	 * @param context Opaque pointer passed to sink.
+	 * @return size_t The number of records delivered.
+	 */
+	size_t poll(BatchSink sink, void* context);
+
+	/**
+	 * @brief Blocks until a followed file may have changed or the timeout expires.
+	 * @param timeoutMs The longest wait in milliseconds.
+	 * @return bool True if a change was signalled (always true for the polling fallback).
+	 */
+	bool waitForChange(int timeoutMs);
+
+	/**
+	 * @brief Alternates waitForChange() and poll() until stop is set.
+	 * @param sink The function receiving the records.
+	 * @param context Opaque pointer passed to sink.
+	 * @param stop A pointer to the flag that ends the loop (checked at least every poll interval).
+	 */
+	void run(BatchSink sink, void* context, const std::atomic<bool>* stop);
+
+	/**
+	 * @brief Checks whether changes are detected with inotify rather than by polling.
+	 * @return bool True if inotify is in use.
+	 */
+	bool isUsingInotify() const { return inotifyFd >= 0; }
+
+	/**
+	 * @brief Gets the number of bytes consumed by polls (complete lines only).
+	 * @return unsigned long The byte count.
+	 */
+	unsigned long getBytesConsumed() const { return bytesConsumed; }
+
+	/**
+	 * @brief Gets the number of records delivered by polls.
+	 * @return unsigned long The record count.
+	 */
+	unsigned long getRecordsDelivered() const { return recordsDelivered; }
+
+private:
+	/**
+	 * @brief Largest number of bytes read from one file in one poll.
+	 */
+	static const long kMaxReadBytes = 1 << 22;
+
+	/**
+	 * @struct FollowedFile
+	 * @brief Read position of one followed file.
+	 */
+	struct FollowedFile {
+		std::string path;     ///< File path.
+		long offset;          ///< Bytes consumed (always the end of a complete line).
+		bool headerPending;   ///< True until the header line has been read.
+		CsvLayout layout;     ///< Column positions named by the header.
+	};
+
+	/**
+	 * @brief Parses the complete lines appended to a file since its offset.
+	 * @param file The file.
+	 * @param records Receives the parsed records.
+	 */
+	void readNewLines(FollowedFile* file, std::vector<WeatherRecord*>* records);
+
+	/**
+	 * @brief Adds an inotify watch on the directory of a path, once per directory.
+	 * @param path The file path.
+	 */
+	void watchDirectoryOf(const std::string* path);
+
+	ParseFunction parse;                    ///< Line parser.
+	int pollIntervalMs;                     ///< Sleep of the polling fallback.
+	int inotifyFd;                          ///< inotify descriptor, or -1 when polling.
+	std::vector<FollowedFile> files;        ///< Followed files.
+	std::vector<std::string> watchedDirs;   ///< Directories with an inotify watch.
+	unsigned long bytesConsumed;            ///< Bytes consumed by polls.
+	unsigned long recordsDelivered;         ///< Records delivered by polls.
+
+	FileFollower(const FileFollower&) = delete;
+	FileFollower& operator=(const FileFollower&) = delete;
+};
+
+#endif // FILEFOLLOWER_H
@@ -0,0 +1,183 @@
+// IngestPipeline.cpp
+
+// Implements the staged ingest pipeline: a reader thread producing raw line chunks,
+// parse tasks on the shared TaskPool producing record batches, and the calling
+// thread consuming them.
+
+#include "IngestPipeline.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+	/**
+	 * @brief Constructor for IngestPipeline.
+	 *
+	 * @param  parse - The line parser used by the parse tasks.
+	 * @param  chunkLines - Number of raw lines per chunk.
+	 * @param  queueDepth - Maximum number of chunks in flight.
+	 * @param  pool - The task pool parse tasks are submitted to.
+	 * @return void
+	 */
+IngestPipeline::IngestPipeline(ParseFunction parse, size_t chunkLines, size_t queueDepth, TaskPool* pool)
+	: parse(parse), chunkLines(chunkLines), queueDepth(queueDepth), pool(pool) {
+	if (this->chunkLines == 0) this->chunkLines = 1;
+	if (this->queueDepth == 0) this->queueDepth = 1;
+}
+
+	/**
+	 * @brief Reader stage. Reads each listed CSV in chunks of chunkLines lines, tagged with the layout its header names.
+	 *
+	 * Before emitting a chunk the reader sleeps until fewer than queueDepth chunks are in
+	 * flight, which bounds memory and guarantees the queues never fill up. Each file ends
+	 * with a chunk flagged last, empty when the file holds no further lines or failed to open.
+	 *
+	 * @param  files - Pointer to the CSV file names (relative to data/).
+	 * @param  rawQueue - Pointer to the queue receiving raw chunks.
+	 * @param  batchQueue - Pointer to the queue the parse tasks deliver to.
+	 * @param  group - Pointer to the task group for the parse tasks.
+	 * @param  progress - Pointer to the counts shared with the consumer.
+	 * @return void
+	 */
+void IngestPipeline::readFiles(const std::vector<std::string>* files, BoundedQueue<RawChunk*>* rawQueue,
+							   BoundedQueue<RecordBatch*>* batchQueue, TaskGroup* group, Progress* progress) const {
+	long emitted = 0;
+
+	auto emit = [&](RawChunk* chunk) {
+		{
+			std::unique_lock<std::mutex> lock(progress->mutex);
+			progress->changed.wait(lock, [&] { return progress->inFlight < static_cast<long>(queueDepth); });
+			++progress->inFlight;
+		}
+		rawQueue->push(chunk);
+		group->run([this, rawQueue, batchQueue, progress] { parseChunk(rawQueue, batchQueue, progress); }, "ingest.parse");
+		++emitted;
+	};
+
+	for (size_t f = 0; f < files->size(); ++f) {
+		std::string fullPath = "data/" + (*files)[f];
+		std::ifstream csvFile(fullPath);
+
+		if (!csvFile.is_open()) {
+			std::cerr << "Failed to open CSV file: " << fullPath << std::endl;
+			emit(new RawChunk{std::vector<std::string>(), static_cast<int>(f), 0, CsvLayout(), true});
+			continue;
+		}
+
+		std::string line;
+		// The header names the columns; files differ in their order
+		std::getline(csvFile, line);
+		CsvLayout layout = CsvLayout::fromHeader(&line);
+
+		long sequence = 0;
+		RawChunk* chunk = new RawChunk{std::vector<std::string>(), static_cast<int>(f), sequence, layout, false};
+		chunk->lines.reserve(chunkLines);
+
+		while (std::getline(csvFile, line)) {
+			chunk->lines.push_back(line);
+			if (chunk->lines.size() == chunkLines) {
+				emit(chunk);
+				chunk = new RawChunk{std::vector<std::string>(), static_cast<int>(f), ++sequence, layout, false};
+				chunk->lines.reserve(chunkLines);
+			}
+		}
+
+		chunk->last = true;
+		emit(chunk);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(progress->mutex);
+		progress->totalChunks = emitted;
+	}
+	progress->changed.notify_all();
+}
+
+	/**
+	 * @brief Parser stage. Parses one chunk into a record batch.
+	 *
+	 * Exactly one chunk is queued for every parse task submitted, so the pop never waits.
+	 *
+	 * @param  rawQueue - Pointer to the queue of raw chunks.
+	 * @param  batchQueue - Pointer to the queue receiving record batches.
+	 * @param  progress - Pointer to the counts shared with the consumer.
+	 * @return void
+	 */
+void IngestPipeline::parseChunk(BoundedQueue<RawChunk*>* rawQueue, BoundedQueue<RecordBatch*>* batchQueue, Progress* progress) const {
+	RawChunk* chunk = rawQueue->pop();
+
+	RecordBatch* batch = new RecordBatch{std::vector<WeatherRecord*>(), chunk->fileIndex, chunk->sequence, chunk->last};
+	batch->records.reserve(chunk->lines.size());
+	for (std::string& line : chunk->lines) {
+		WeatherRecord* record = parse(&line, &chunk->layout);
+		if (record != nullptr) batch->records.push_back(record);
+	}
+	delete chunk;
+
+	batchQueue->push(batch);
+	{
+		std::lock_guard<std::mutex> lock(progress->mutex);
+		++progress->ready;
+	}
+	progress->changed.notify_all();
+}
+
+	/**
+	 * @brief Runs all stages to completion over the files named in the list file.
+	 *
+	 * The reader runs on its own thread and parsing on the task pool; the sink runs on
+	 * the calling thread, which runs pending pool tasks whenever no batch is ready and
+	 * sleeps once there are none. A batch is popped only after it was counted as ready
+	 * or is already in the queue, so the ready count can dip below zero for a moment
+	 * but the consumer never sleeps past a delivered batch.
+	 *
+	 * @param  listFilename - Pointer to the name of the list file.
+	 * @param  sink - Consumer called once per parsed batch.
+	 * @param  context - Opaque pointer forwarded to the sink.
+	 * @return bool - False if the list file could not be opened, true otherwise.
+	 */
+bool IngestPipeline::run(std::string* listFilename, BatchSink sink, void* context) {
+	std::ifstream listFile(*listFilename);
+	if (!listFile.is_open()) {
+		return false;
+	}
+
+	std::vector<std::string> files;
+	std::string csvFileName;
+	while (std::getline(listFile, csvFileName)) {
+		csvFileName.erase(std::remove(csvFileName.begin(), csvFileName.end(), '\r'), csvFileName.end());
+		if (!csvFileName.empty()) files.push_back(csvFileName);
+	}
+	listFile.close();
+
+	BoundedQueue<RawChunk*> rawQueue(queueDepth);
+	BoundedQueue<RecordBatch*> batchQueue(queueDepth);
+	TaskGroup group(pool);
+	Progress progress;
+
+	std::thread reader(&IngestPipeline::readFiles, this, &files, &rawQueue, &batchQueue, &group, &progress);
+
+	long consumed = 0;
+	for (;;) {
+		RecordBatch* batch = nullptr;
+		if (batchQueue.tryPop(batch)) {
+			sink(batch, context);
+			delete batch;
+			++consumed;
+			{
+				std::lock_guard<std::mutex> lock(progress.mutex);
+				--progress.inFlight;
+				--progress.ready;
+			}
+			progress.changed.notify_all();
+		} else if (!pool->runPendingTask()) {
+			std::unique_lock<std::mutex> lock(progress.mutex);
+			if (progress.totalChunks == consumed) break;
+			progress.changed.wait(lock, [&] { return progress.ready > 0 || progress.totalChunks == consumed; });
+		}
+	}
+
+	reader.join();
+	group.wait();
+	return true;
+}
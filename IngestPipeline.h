@@ -0,0 +1,121 @@
+#ifndef INGESTPIPELINE_H
+#define INGESTPIPELINE_H
+
+#include "BoundedQueue.h"
+#include "TaskPool.h"
+#include "WeatherRecord.h"
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @struct RawChunk
+ * @brief A run of consecutive CSV lines read from one data file.
+ */
+struct RawChunk {
+	std::vector<std::string> lines; ///< Raw data lines (header already skipped).
+	int fileIndex;                  ///< Position of the source file in the list file.
+	long sequence;                  ///< Chunk number within its file, starting at 0.
+	CsvLayout layout;               ///< Column positions, from the source file's header.
+	bool last;                      ///< True for the file's final chunk, which may be empty.
+};
+
+/**
+ * @struct RecordBatch
+ * @brief The records parsed from one RawChunk.
+ */
+struct RecordBatch {
+	std::vector<WeatherRecord*> records; ///< Parsed records, in file order.
+	int fileIndex;                       ///< Position of the source file in the list file.
+	long sequence;                       ///< Sequence number of the chunk the batch came from.
+	bool last;                           ///< True if the chunk was its file's final one.
+};
+
+/**
+ * @class IngestPipeline
+ * @brief Staged reader -> parser -> consumer pipeline for loading the data files.
+ *
+ * One reader thread reads the files named in the list file and emits fixed-size
+ * chunks of raw lines, submitting one parse task per chunk to the shared TaskPool.
+ * Parse tasks turn chunks into record batches, and the calling thread hands each
+ * batch to a sink as it arrives (helping with parse tasks while it waits). Stages are
+ * connected by bounded lock-free queues and the reader never has more than
+ * queueDepth chunks in flight, so I/O, parsing and consumption overlap while the
+ * amount of raw text held in memory stays bounded. A stage with nothing to do sleeps
+ * on a condition variable rather than spinning.
+ */
+class IngestPipeline {
+public:
+	/**
+	 * @brief Function that parses one CSV line laid out as its file's header says, returning nullptr for lines to skip.
+	 */
+	typedef WeatherRecord* (*ParseFunction)(std::string* line, const CsvLayout* layout);
+
+	/**
+	 * @brief Function that receives each parsed batch. It takes ownership of the records (not the batch).
+	 */
+	typedef void (*BatchSink)(RecordBatch* batch, void* context);
+
+	/**
+	 * @brief Constructor.
+	 * @param parse The line parser run by the parse tasks.
+	 * @param chunkLines Number of lines per raw chunk.
+	 * @param queueDepth Maximum number of chunks in flight between the reader and the consumer.
+	 * @param pool The task pool parse tasks are submitted to.
+	 */
+	IngestPipeline(ParseFunction parse, size_t chunkLines = 4096, size_t queueDepth = 8, TaskPool* pool = &TaskPool::instance());
+
+	/**
+	 * @brief Runs the pipeline over every file named in the list file.
+	 *
+	 * Batches reach the sink in completion order, which may differ from file order
+	 * when several parse tasks run at once; fileIndex and sequence identify them. Every
+	 * listed file ends with a batch flagged last (empty for a file that failed to open),
+	 * so the sink can tell when it has all of a file.
+	 * @param listFilename A pointer to the name of the file listing the CSVs (relative to data/).
+	 * @param sink The consumer called on the calling thread for every batch.
+	 * @param context Opaque pointer passed through to the sink.
+	 * @return bool False if the list file could not be opened.
+	 */
+	bool run(std::string* listFilename, BatchSink sink, void* context);
+
+private:
+	/**
+	 * @struct Progress
+	 * @brief Chunk counts shared by the stages, with the condition variable the reader and consumer sleep on.
+	 */
+	struct Progress {
+		std::mutex mutex;                 ///< Guards the counts.
+		std::condition_variable changed;  ///< Signalled when a batch is ready or consumed, and when reading ends.
+		long inFlight = 0;                ///< Chunks emitted but not yet consumed.
+		long ready = 0;                   ///< Batches delivered but not yet consumed.
+		long totalChunks = -1;            ///< Chunks emitted in total, or -1 while reading.
+	};
+
+	/**
+	 * @brief Reader stage: reads every listed file into chunks and submits a parse task per chunk.
+	 * @param files The CSV file names, in list order.
+	 * @param rawQueue Destination queue for raw chunks.
+	 * @param batchQueue Queue the parse tasks deliver batches to.
+	 * @param group Task group the parse tasks are submitted to.
+	 * @param progress Shared counts; the reader sleeps while queueDepth chunks are in flight and sets totalChunks at the end.
+	 */
+	void readFiles(const std::vector<std::string>* files, BoundedQueue<RawChunk*>* rawQueue,
+				   BoundedQueue<RecordBatch*>* batchQueue, TaskGroup* group, Progress* progress) const;
+
+	/**
+	 * @brief Parser stage: converts one raw chunk into a record batch.
+	 * @param rawQueue Source queue of raw chunks.
+	 * @param batchQueue Destination queue for parsed batches.
+	 * @param progress Shared counts; the batch is counted as ready once delivered.
+	 */
+	void parseChunk(BoundedQueue<RawChunk*>* rawQueue, BoundedQueue<RecordBatch*>* batchQueue, Progress* progress) const;
+
+	ParseFunction parse;  ///< Line parser.
+	size_t chunkLines;    ///< Lines per raw chunk.
+	size_t queueDepth;    ///< Maximum chunks in flight.
+	TaskPool* pool;       ///< Pool running the parse tasks.
+};
+
+#endif // INGESTPIPELINE_H
@@ -1,7 +1,9 @@
 #ifndef MAP_H
 #define MAP_H
 
+#include <cstddef>
 #include <map>
+#include <vector>
 
 /**
  * @class Map
@@ -80,6 +82,15 @@ public:
 		(*internalMap)[*key] = *value;
 	}
 
+	/**
+	 * @brief Removes a key and its value from the map.
+	 * @param key A constant pointer to the key to remove.
+	 * @return bool True if the key was present.
+	 */
+	bool erase(const K* key) {
+		return internalMap->erase(*key) > 0;
+	}
+
 	/**
 	 * @brief Checks if the map contains the specified key.
 	 * @param key A constant pointer to the key to search for.
@@ -112,6 +123,18 @@ public:
 		return &internalMap->at(*key);
 	}
 
+	/**
+	 * @brief Copies the keys into a vector, in ascending order.
+	 * @param keys A pointer to the destination vector (overwritten).
+	 */
+	void keys(std::vector<K>* keys) const {
+		keys->clear();
+		keys->reserve(internalMap->size());
+		for (const auto& entry : *internalMap) {
+			keys->push_back(entry.first);
+		}
+	}
+
 	/**
 	 * @brief Returns the number of key-value pairs in the map.
 	 * @return size_t The size of the map.
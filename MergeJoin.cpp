@@ -0,0 +1,203 @@
+// MergeJoin.cpp
+
+// Implements MergeJoin: lockstep alignment of two sorted series within a
+// timestamp tolerance, and one-pass difference and correlation statistics.
+
+#include "MergeJoin.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+	/**
+	 * @brief Running moments of the aligned pairs (Welford's method, with a co-moment for the correlation).
+	 */
+	struct PairMoments {
+		size_t count;
+		double meanLeft, meanRight, m2Left, m2Right, coMoment;
+		double meanDiff, m2Diff, sumAbsDiff, sumSqDiff, maxAbsDiff;
+	};
+
+	/**
+	 * @brief Folds one pair into the running moments.
+	 *
+	 * @param  pair - Pointer to the pair.
+	 * @param  context - Pointer to the PairMoments.
+	 * @return void
+	 */
+	void accumulatePair(const AlignedPair* pair, void* context) {
+		PairMoments* m = static_cast<PairMoments*>(context);
+		m->count += 1;
+		double n = static_cast<double>(m->count);
+
+		double dLeft = pair->left - m->meanLeft;
+		double dRight = pair->right - m->meanRight;
+		m->meanLeft += dLeft / n;
+		m->meanRight += dRight / n;
+		m->m2Left += dLeft * (pair->left - m->meanLeft);
+		m->m2Right += dRight * (pair->right - m->meanRight);
+		m->coMoment += dLeft * (pair->right - m->meanRight);
+
+		double diff = pair->right - pair->left;
+		double dDiff = diff - m->meanDiff;
+		m->meanDiff += dDiff / n;
+		m->m2Diff += dDiff * (diff - m->meanDiff);
+		m->sumAbsDiff += std::fabs(diff);
+		m->sumSqDiff += diff * diff;
+		m->maxAbsDiff = std::max(m->maxAbsDiff, std::fabs(diff));
+	}
+
+	/**
+	 * @brief Appends a pair's values to two vectors.
+	 *
+	 * @param  pair - Pointer to the pair.
+	 * @param  context - Pointer to an array of two std::vector<double>*.
+	 * @return void
+	 */
+	void appendPair(const AlignedPair* pair, void* context) {
+		std::vector<double>** columns = static_cast<std::vector<double>**>(context);
+		columns[0]->push_back(pair->left);
+		columns[1]->push_back(pair->right);
+	}
+}
+
+	/**
+	 * @brief Constructor for MergeJoin.
+	 *
+	 * @param  toleranceMinutes - Largest key difference of a pair (negative values count as 0).
+	 * @return void
+	 */
+MergeJoin::MergeJoin(int toleranceMinutes) : tolerance(std::max(0, toleranceMinutes)) {}
+
+	/**
+	 * @brief Walks both series forward together, pairing readings within the tolerance.
+	 *
+	 * At each step the earlier reading is dropped if it is out of reach of the other side's
+	 * current reading. When both are in reach, the pair is emitted unless the next reading
+	 * on either side would be strictly closer to its counterpart, in which case that side
+	 * advances first. Each reading is looked at a bounded number of times.
+	 *
+	 * @param  leftKeys - Pointer to the left keys, ascending.
+	 * @param  leftValues - Pointer to the left values.
+	 * @param  rightKeys - Pointer to the right keys, ascending.
+	 * @param  rightValues - Pointer to the right values.
+	 * @param  visit - Function applied to each pair.
+	 * @param  context - Opaque pointer passed to visit.
+	 * @return size_t - The number of pairs.
+	 */
+size_t MergeJoin::join(const std::vector<int>* leftKeys, const std::vector<double>* leftValues,
+					   const std::vector<int>* rightKeys, const std::vector<double>* rightValues,
+					   PairVisitor visit, void* context) const {
+	const int* lk = leftKeys->data();
+	const int* rk = rightKeys->data();
+	size_t leftCount = std::min(leftKeys->size(), leftValues->size());
+	size_t rightCount = std::min(rightKeys->size(), rightValues->size());
+
+	size_t pairs = 0;
+	size_t i = 0;
+	size_t j = 0;
+	while (i < leftCount && j < rightCount) {
+		long long gap = static_cast<long long>(rk[j]) - lk[i];
+		if (gap < -tolerance) {
+			++j;
+			continue;
+		}
+		if (gap > tolerance) {
+			++i;
+			continue;
+		}
+
+		long long distance = std::llabs(gap);
+		if (i + 1 < leftCount && std::llabs(static_cast<long long>(rk[j]) - lk[i + 1]) < distance) {
+			++i;
+			continue;
+		}
+		if (j + 1 < rightCount && std::llabs(static_cast<long long>(rk[j + 1]) - lk[i]) < distance) {
+			++j;
+			continue;
+		}
+
+		AlignedPair pair = {lk[i], rk[j], (*leftValues)[i], (*rightValues)[j]};
+		visit(&pair, context);
+		++pairs;
+		++i;
+		++j;
+	}
+	return pairs;
+}
+
+	/**
+	 * @brief Copies both collections' series over the range and joins them.
+	 *
+	 * @param  left - Pointer to the left collection.
+	 * @param  leftMetric - The left metric.
+	 * @param  right - Pointer to the right collection.
+	 * @param  rightMetric - The right metric.
+	 * @param  from - First minute key.
+	 * @param  to - Last minute key (inclusive).
+	 * @param  visit - Function applied to each pair.
+	 * @param  context - Opaque pointer passed to visit.
+	 * @return size_t - The number of pairs.
+	 */
+size_t MergeJoin::join(const WeatherDataCollection* left, Metric leftMetric,
+					   const WeatherDataCollection* right, Metric rightMetric,
+					   int from, int to, PairVisitor visit, void* context) const {
+	std::vector<int> leftKeys, rightKeys;
+	std::vector<double> leftValues, rightValues;
+	left->copySeries(leftMetric, from, to, &leftKeys, &leftValues);
+	right->copySeries(rightMetric, from, to, &rightKeys, &rightValues);
+	return join(&leftKeys, &leftValues, &rightKeys, &rightValues, visit, context);
+}
+
+	/**
+	 * @brief Joins two collections into paired value vectors.
+	 *
+	 * @param  left - Pointer to the left collection.
+	 * @param  leftMetric - The left metric.
+	 * @param  right - Pointer to the right collection.
+	 * @param  rightMetric - The right metric.
+	 * @param  from - First minute key.
+	 * @param  to - Last minute key (inclusive).
+	 * @param  x - Receives the left values.
+	 * @param  y - Receives the right values.
+	 * @return size_t - The number of pairs.
+	 */
+size_t MergeJoin::align(const WeatherDataCollection* left, Metric leftMetric,
+						const WeatherDataCollection* right, Metric rightMetric,
+						int from, int to, std::vector<double>* x, std::vector<double>* y) const {
+	x->clear();
+	y->clear();
+	std::vector<double>* columns[2] = {x, y};
+	return join(left, leftMetric, right, rightMetric, from, to, appendPair, columns);
+}
+
+	/**
+	 * @brief Joins two collections on one metric and accumulates the difference statistics as pairs arrive.
+	 *
+	 * @param  left - Pointer to the left collection.
+	 * @param  right - Pointer to the right collection.
+	 * @param  metric - The metric compared.
+	 * @param  from - First minute key.
+	 * @param  to - Last minute key (inclusive).
+	 * @return DifferenceStats - The statistics of right - left.
+	 */
+DifferenceStats MergeJoin::compare(const WeatherDataCollection* left, const WeatherDataCollection* right,
+								   Metric metric, int from, int to) const {
+	PairMoments moments = {0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+	join(left, metric, right, metric, from, to, accumulatePair, &moments);
+
+	DifferenceStats stats = {0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+	if (moments.count == 0) return stats;
+
+	double n = static_cast<double>(moments.count);
+	stats.count = moments.count;
+	stats.meanDifference = moments.meanDiff;
+	stats.stdDifference = moments.count < 2 ? 0.0 : std::sqrt(moments.m2Diff / (n - 1.0));
+	stats.meanAbsDifference = moments.sumAbsDiff / n;
+	stats.rmsDifference = std::sqrt(moments.sumSqDiff / n);
+	stats.maxAbsDifference = moments.maxAbsDiff;
+
+	double spread = std::sqrt(moments.m2Left * moments.m2Right);
+	stats.spcc = (moments.count < 2 || spread == 0.0) ? 0.0 : moments.coMoment / spread;
+	return stats;
+}
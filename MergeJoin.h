@@ -0,0 +1,126 @@
+#ifndef MERGEJOIN_H
+#define MERGEJOIN_H
+
+#include "Metric.h"
+#include "WeatherDataCollection.h"
+#include <cstddef>
+#include <vector>
+
+/**
+ * @struct AlignedPair
+ * @brief One reading of the left series matched with one reading of the right series.
+ */
+struct AlignedPair {
+	int leftKey;   ///< Minute key of the left reading.
+	int rightKey;  ///< Minute key of the right reading.
+	double left;   ///< Left value.
+	double right;  ///< Right value.
+};
+
+/**
+ * @struct DifferenceStats
+ * @brief Agreement of two aligned series: statistics of right - left, and their correlation.
+ */
+struct DifferenceStats {
+	size_t count;              ///< Number of aligned pairs.
+	double meanDifference;     ///< Mean of right - left (the bias).
+	double stdDifference;      ///< Sample standard deviation of right - left (0 if count < 2).
+	double meanAbsDifference;  ///< Mean of |right - left|.
+	double rmsDifference;      ///< Root mean square of right - left.
+	double maxAbsDifference;   ///< Largest |right - left|.
+	double spcc;               ///< Sample Pearson correlation of the pairs (0 if undefined).
+};
+
+/**
+ * @class MergeJoin
+ * @brief Aligns two time-ordered series by timestamp in a single lockstep pass.
+ *
+ * Used to compare stations, or a raw dataset against its quality-controlled copy. Both
+ * series are walked forward together, so a join costs O(left + right) instead of one
+ * lookup per reading. Readings are paired one to one: a left and a right reading are
+ * paired when their keys differ by at most the tolerance and neither has a closer partner
+ * among its neighbours on the other side; unpaired readings are skipped. With a tolerance
+ * of 0 this is an equi-join on the timestamp.
+ */
+class MergeJoin {
+public:
+	/**
+	 * @brief Function applied to each aligned pair, in time order.
+	 */
+	typedef void (*PairVisitor)(const AlignedPair* pair, void* context);
+
+	/**
+	 * @brief Constructor.
+	 * @param toleranceMinutes The largest key difference at which two readings are still paired.
+	 */
+	explicit MergeJoin(int toleranceMinutes = 0);
+
+	/**
+	 * @brief Joins two series given as parallel key and value vectors.
+	 * @param leftKeys A constant pointer to the left keys, ascending.
+	 * @param leftValues A constant pointer to the left values.
+	 * @param rightKeys A constant pointer to the right keys, ascending.
+	 * @param rightValues A constant pointer to the right values.
+	 * @param visit The function applied to each pair.
+	 * @param context Opaque pointer passed to visit.
+	 * @return size_t The number of pairs.
+	 */
+	size_t join(const std::vector<int>* leftKeys, const std::vector<double>* leftValues,
+				const std::vector<int>* rightKeys, const std::vector<double>* rightValues,
+				PairVisitor visit, void* context) const;
+
+	/**
+	 * @brief Joins one metric of two collections over a minute-key range.
+	 * @param left A constant pointer to the left collection.
+	 * @param leftMetric The left metric.
+	 * @param right A constant pointer to the right collection.
+	 * @param rightMetric The right metric.
+	 * @param from The first minute key of the range.
+	 * @param to The last minute key of the range (inclusive).
+	 * @param visit The function applied to each pair.
+	 * @param context Opaque pointer passed to visit.
+	 * @return size_t The number of pairs.
+	 */
+	size_t join(const WeatherDataCollection* left, Metric leftMetric,
+				const WeatherDataCollection* right, Metric rightMetric,
+				int from, int to, PairVisitor visit, void* context) const;
+
+	/**
+	 * @brief Joins one metric of two collections into paired vectors, ready for Statistics::calculateSPCC.
+	 * @param left A constant pointer to the left collection.
+	 * @param leftMetric The left metric.
+	 * @param right A constant pointer to the right collection.
+	 * @param rightMetric The right metric.
+	 * @param from The first minute key of the range.
+	 * @param to The last minute key of the range (inclusive).
+	 * @param x Receives the left values of the pairs (overwritten).
+	 * @param y Receives the right values of the pairs (overwritten).
+	 * @return size_t The number of pairs.
+	 */
+	size_t align(const WeatherDataCollection* left, Metric leftMetric,
+				 const WeatherDataCollection* right, Metric rightMetric,
+				 int from, int to, std::vector<double>* x, std::vector<double>* y) const;
+
+	/**
+	 * @brief Joins one metric of two collections and summarizes their agreement in the same pass.
+	 * @param left A constant pointer to the left collection.
+	 * @param right A constant pointer to the right collection.
+	 * @param metric The metric compared.
+	 * @param from The first minute key of the range.
+	 * @param to The last minute key of the range (inclusive).
+	 * @return DifferenceStats The statistics of right - left (all zero if nothing aligns).
+	 */
+	DifferenceStats compare(const WeatherDataCollection* left, const WeatherDataCollection* right,
+							Metric metric, int from, int to) const;
+
+	/**
+	 * @brief Gets the pairing tolerance.
+	 * @return int The tolerance in minutes.
+	 */
+	int getTolerance() const { return tolerance; }
+
+private:
+	int tolerance; ///< Largest key difference of a pair, in minutes.
+};
+
+#endif // MERGEJOIN_H
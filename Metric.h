@@ -0,0 +1,139 @@
+#ifndef METRIC_H
+#define METRIC_H
+
+#include "WeatherRecord.h"
+#include <string>
+#include <vector>
+
+/**
+ * @enum Metric
+ * @brief Identifies one numeric column of a WeatherRecord.
+ *
+ * Used as a template argument so that column selection is resolved at compile time;
+ * adding a column means adding an enumerator and a MetricColumn specialization.
+ */
+enum class Metric {
+	WindSpeed,      ///< WeatherRecord::windSpeed
+	Temperature,    ///< WeatherRecord::temperature
+	SolarRadiation, ///< WeatherRecord::solarRadiation
+	WindDirection   ///< WeatherRecord::windDirection
+};
+
+/**
+ * @brief Number of Metric enumerators (size of runtime dispatch tables).
+ */
+const int kMetricCount = 4;
+
+/**
+ * @struct MetricColumn
+ * @brief Compile-time accessor for the column identified by M.
+ *
+ * Each specialization provides a static get() returning the column value of a record,
+ * which the compiler inlines into the extraction loops below.
+ * @tparam M The metric to access.
+ */
+template <Metric M>
+struct MetricColumn;
+
+/**
+ * @brief Accessor for wind speed.
+ */
+template <>
+struct MetricColumn<Metric::WindSpeed> {
+	static double get(const WeatherRecord* record) { return record->windSpeed; }
+};
+
+/**
+ * @brief Accessor for air temperature.
+ */
+template <>
+struct MetricColumn<Metric::Temperature> {
+	static double get(const WeatherRecord* record) { return record->temperature; }
+};
+
+/**
+ * @brief Accessor for solar radiation.
+ */
+template <>
+struct MetricColumn<Metric::SolarRadiation> {
+	static double get(const WeatherRecord* record) { return record->solarRadiation; }
+};
+
+/**
+ * @brief Accessor for wind direction.
+ */
+template <>
+struct MetricColumn<Metric::WindDirection> {
+	static double get(const WeatherRecord* record) { return record->windDirection; }
+};
+
+/**
+ * @brief Reads the column of a record chosen at run time.
+ * @param record A constant pointer to the record.
+ * @param metric The column to read.
+ * @return double The column value.
+ */
+inline double metricValue(const WeatherRecord* record, Metric metric) {
+	switch (metric) {
+		case Metric::WindSpeed: return MetricColumn<Metric::WindSpeed>::get(record);
+		case Metric::Temperature: return MetricColumn<Metric::Temperature>::get(record);
+		case Metric::SolarRadiation: return MetricColumn<Metric::SolarRadiation>::get(record);
+		default: return MetricColumn<Metric::WindDirection>::get(record);
+	}
+}
+
+/**
+ * @brief Tells whether a metric can be averaged on a linear scale.
+ *
+ * Wind direction is an angle: 350 and 10 degrees are 20 degrees apart, yet their
+ * arithmetic mean is 180. Means, spreads and z-scores of it are meaningless, so the
+ * normals, anomaly scans and mean estimates do not support it (see WindRose instead).
+ * @param metric The metric.
+ * @return bool False for wind direction.
+ */
+inline bool isLinearMetric(Metric metric) {
+	return metric != Metric::WindDirection;
+}
+
+/**
+ * @brief Copies one column of a set of records into a vector of doubles.
+ * @tparam M The column to extract.
+ * @param records A constant pointer to the source records.
+ * @param values A pointer to the destination vector (overwritten).
+ */
+template <Metric M>
+void extractColumn(const std::vector<WeatherRecord*>* records, std::vector<double>* values) {
+	values->resize(records->size());
+	double* out = values->data();
+	for (size_t i = 0; i < records->size(); ++i) {
+		out[i] = MetricColumn<M>::get((*records)[i]);
+	}
+}
+
+/**
+ * @brief Maps a legacy correlation type string to its metric pair.
+ *
+ * Recognised types are "S_T" (solar radiation vs temperature), "S_R" (solar
+ * radiation vs wind speed) and "T_R" (temperature vs wind speed).
+ * @param type A constant pointer to the type string.
+ * @param x Receives the first metric.
+ * @param y Receives the second metric.
+ * @return bool False if the type is not recognised.
+ */
+inline bool parseCorrelationType(const std::string* type, Metric* x, Metric* y) {
+	if (*type == "S_T") {
+		*x = Metric::SolarRadiation;
+		*y = Metric::Temperature;
+	} else if (*type == "S_R") {
+		*x = Metric::SolarRadiation;
+		*y = Metric::WindSpeed;
+	} else if (*type == "T_R") {
+		*x = Metric::Temperature;
+		*y = Metric::WindSpeed;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+#endif // METRIC_H
@@ -0,0 +1,692 @@
+#ifndef PERSISTENTBST_H
+#define PERSISTENTBST_H
+
+#include "TaskPool.h"
+#include "TreeSlices.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+template <class T>
+class PersistentBst;
+
+/// @class PersistentNode
+/// @brief Reference-counted node of a PersistentBst, shared by every tree that reaches it.
+template <class T>
+class PersistentNode {
+public:
+	T* data;  ///< Pointer to the data element, shared by every copy of this node.
+	PersistentNode<T>* left;  ///< Pointer to the left child node.
+	PersistentNode<T>* right;  ///< Pointer to the right child node.
+	int subtreeSize;  ///< Number of nodes in the subtree rooted here, this one included.
+
+	/**
+	 * @brief Constructs a leaf, taking ownership of the provided data pointer.
+	 * @param value The pointer to the data element.
+	 */
+	PersistentNode(T* value)
+		: data(value), left(nullptr), right(nullptr), subtreeSize(1), priority(priorityOf(value)), refs(1),
+		  dataRefs(new std::atomic<int>(1)) {}
+
+	/**
+	 * @brief Constructs a copy of a node that shares its data and its children.
+	 * @param other A constant pointer to the node to copy.
+	 */
+	explicit PersistentNode(const PersistentNode<T>* other)
+		: data(other->data), left(other->left), right(other->right), subtreeSize(other->subtreeSize),
+		  priority(other->priority), refs(1), dataRefs(other->dataRefs) {
+		dataRefs->fetch_add(1, std::memory_order_relaxed);
+		if (left) left->refs.fetch_add(1, std::memory_order_relaxed);
+		if (right) right->refs.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Destructor. Deletes the data element once no node shares it. Children are released by the tree.
+	 */
+	~PersistentNode() {
+		if (dataRefs->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			delete data;
+			delete dataRefs;
+		}
+	}
+
+	PersistentNode(const PersistentNode<T>&) = delete;
+	PersistentNode<T>& operator=(const PersistentNode<T>&) = delete;
+
+private:
+	friend class PersistentBst<T>;
+
+	/**
+	 * @brief Hashes a value's address into a treap priority (splitmix64 finalizer).
+	 * @param value The pointer to the data element.
+	 * @return uint32_t The priority.
+	 */
+	static uint32_t priorityOf(const T* value) {
+		uint64_t bits = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+		bits = (bits ^ (bits >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		bits = (bits ^ (bits >> 27)) * 0x94d049bb133111ebULL;
+		return static_cast<uint32_t>(bits ^ (bits >> 31));
+	}
+
+	uint32_t priority;           ///< Treap priority; no child's is greater.
+	std::atomic<int> refs;       ///< Trees and parent nodes pointing at this node.
+	std::atomic<int>* dataRefs;  ///< Nodes sharing data.
+};
+
+/// @class PersistentBst
+/// @brief Balanced Binary Search Tree whose copies share structure (persistent, path-copying).
+///
+/// Copying a tree only takes a reference to its root, so a snapshot costs O(1) however
+/// large the tree. Nodes are reference-counted and never modified while shared: an update
+/// copies the nodes on the path from the root to the change (O(height) nodes), points
+/// the copies at the untouched subtrees of the originals, and leaves every other tree as
+/// it was.
+///
+/// The tree is a treap: each node carries a priority hashed from its value's address and
+/// no node has a greater priority than its parent. The shape is then that of keys inserted
+/// in random order whatever the real order, so the height is O(log n) expected even for
+/// time-ordered appends, and updates, lookups and the recursive traversals stay shallow. A node that only this tree reaches is updated in place, so a tree that is never
+/// copied behaves, and allocates, like Bst. Values are shared between copies of a node
+/// and deleted with the last of them; they must not be modified once inserted.
+///
+/// Reference counts are atomic, so trees sharing nodes may be updated, read and destroyed
+/// on different threads; a single tree is not itself thread-safe.
+template <class T>
+class PersistentBst {
+public:
+	/**
+	 * @brief The node type returned by lookups.
+	 */
+	typedef PersistentNode<T> NodeType;
+
+	/**
+	 * @brief Default constructor. Initializes an empty tree.
+	 */
+	PersistentBst();
+
+	/**
+	 * @brief Destructor. Releases the root; nodes no other tree shares are freed.
+	 */
+	~PersistentBst();
+
+	/**
+	 * @brief Copy constructor. Shares the other tree's nodes in O(1).
+	 * @param other The tree to copy.
+	 */
+	PersistentBst(const PersistentBst<T>& other);
+
+	/**
+	 * @brief Assignment operator. Shares the other tree's nodes in O(1).
+	 * @param other The tree to assign from.
+	 * @return PersistentBst<T>& Reference to the updated tree.
+	 */
+	PersistentBst<T>& operator=(const PersistentBst<T>& other);
+
+	/**
+	 * @brief Inserts a data value, copying the shared nodes on its path. Takes ownership of the pointer if inserted.
+	 * @param value The pointer to the data value to insert.
+	 * @return bool True if inserted, false if an equal value was already present (the pointer is not taken).
+	 */
+	bool insert(T* value);
+
+	/**
+	 * @brief Searches for a data value.
+	 * @param value The pointer to the data value (used for comparison key).
+	 * @return NodeType* The node containing the value, or nullptr if not found.
+	 */
+	NodeType* search(const T* value) const;
+
+	/**
+	 * @brief Removes every value between two monotone predicates, copying only the shared nodes on the two split paths.
+	 * @param below Predicate that is true for values ordered before the range.
+	 * @param above Predicate that is true for values ordered after the range.
+	 * @param onErase Function applied to each removed value (may be nullptr). Values still shared with another tree stay alive.
+	 * @param context Opaque pointer passed to onErase.
+	 * @return int The number of values removed.
+	 */
+	template <class Below, class Above>
+	int eraseRange(Below below, Above above, void (*onErase)(const T*, void*) = nullptr, void* context = nullptr);
+
+	/**
+	 * @brief Finds the node with the largest key not greater than key.
+	 * @param key The key.
+	 * @param keyOf Function returning the key of a value.
+	 * @return NodeType* The floor node, or nullptr if none.
+	 */
+	template <class K, class KeyOf>
+	NodeType* floor(const K& key, KeyOf keyOf) const;
+
+	/**
+	 * @brief Finds the node with the smallest key not less than key.
+	 * @param key The key.
+	 * @param keyOf Function returning the key of a value.
+	 * @return NodeType* The ceiling node, or nullptr if none.
+	 */
+	template <class K, class KeyOf>
+	NodeType* ceil(const K& key, KeyOf keyOf) const;
+
+	/**
+	 * @brief Finds the floor of each of a sorted array of keys in one shared descent.
+	 * @param keys The keys, ascending.
+	 * @param count The number of keys.
+	 * @param keyOf Function returning the key of a value.
+	 * @param out Receives count nodes (nullptr where a key has no floor).
+	 */
+	template <class K, class KeyOf>
+	void floorBatch(const K* keys, size_t count, KeyOf keyOf, NodeType** out) const;
+
+	/**
+	 * @brief Initiates an in-order traversal, applying the visit function to each value.
+	 * @param visit The function pointer to apply to each node's data.
+	 */
+	void inOrder(void (*visit)(const T*)) const;
+
+	/**
+	 * @brief Initiates an in-order traversal that uses a context pointer for collection.
+	 * @param visit The function pointer to apply (accepts data pointer and context pointer).
+	 * @param context Opaque pointer to the context/collector struct.
+	 */
+	void inOrder(void (*visit)(const T*, void*), void* context) const;
+
+	/**
+	 * @brief Visits every value in key order, split into equal slices visited in parallel (see Bst::parallelInOrder).
+	 * @tparam Result The per-slice result type.
+	 * @param visit The function applied to each value with its slice's result.
+	 * @param results The per-slice results (if empty, sized to one slice per thread).
+	 * @param pool The pool, or nullptr to visit on the calling thread.
+	 */
+	template <class Result>
+	void parallelInOrder(void (*visit)(const T*, Result*), std::vector<Result>* results,
+						 TaskPool* pool = &TaskPool::instance()) const;
+
+	/**
+	 * @brief Checks if the tree is empty.
+	 * @return bool True if the root is null.
+	 */
+	bool isEmpty() const { return root == nullptr; }
+
+	/**
+	 * @brief Gets the number of values, from the root's subtree size.
+	 * @return int The size of the tree.
+	 */
+	int size() const { return root ? root->subtreeSize : 0; }
+
+	/**
+	 * @brief Gets the height of the tree.
+	 * @return int The height of the tree, or -1 if the tree is empty.
+	 */
+	int height() const;
+
+private:
+	NodeType* root; ///< Pointer to the root node of the tree.
+
+	/**
+	 * @brief Takes one more reference to a node.
+	 * @param node The node (may be nullptr).
+	 * @return NodeType* The node.
+	 */
+	static NodeType* retain(NodeType* node);
+
+	/**
+	 * @brief Drops one reference to a node, freeing it and releasing its children when it was the last.
+	 * @param node The node (may be nullptr).
+	 */
+	static void release(NodeType* node);
+
+	/**
+	 * @brief Turns a held reference into a reference to a node only the holder reaches.
+	 *
+	 * A node with one reference is returned as it is; a shared node is copied (sharing its
+	 * data and children) and the held reference to it dropped.
+	 * @param node The node, of which the caller holds one reference.
+	 * @return NodeType* A node the caller may modify.
+	 */
+	static NodeType* own(NodeType* node);
+
+	/**
+	 * @brief Recursively splits a subtree along a monotone predicate, copying shared nodes on the split path.
+	 * @param node The root of the subtree, of which the caller holds one reference (transferred).
+	 * @param goesLeft Predicate that is true for a prefix of the in-order sequence.
+	 * @param right Receives the root of the nodes for which goesLeft is false.
+	 * @return NodeType* The root of the nodes for which goesLeft is true.
+	 */
+	template <class Pred>
+	static NodeType* splitRec(NodeType* node, Pred goesLeft, NodeType** right);
+
+	/**
+	 * @brief Recursively joins two trees, merging the right spine of the left one with the left spine of the right one by priority.
+	 * @param left The root of the tree holding the smaller values (reference transferred).
+	 * @param right The root of the tree holding the larger values (reference transferred).
+	 * @return NodeType* The root of the joined tree.
+	 */
+	static NodeType* join(NodeType* left, NodeType* right);
+
+	/**
+	 * @brief Recursively applies a function to each value of a subtree and counts them.
+	 * @param node The root of the subtree.
+	 * @param visit Function applied to each value (may be nullptr).
+	 * @param context Opaque pointer passed to visit.
+	 * @return int The number of values.
+	 */
+	static int visitRec(const NodeType* node, void (*visit)(const T*, void*), void* context);
+
+	/**
+	 * @brief Recursively performs an in-order traversal.
+	 * @param node The current node being examined.
+	 * @param visit The function pointer to apply to each node's data.
+	 */
+	static void inOrderRec(const NodeType* node, void (*visit)(const T*));
+
+	/**
+	 * @brief Recursively performs an in-order traversal with a context pointer.
+	 * @param node The current node being examined.
+	 * @param visit The function pointer to apply (accepts data pointer and context pointer).
+	 * @param context Opaque pointer to the context/collector struct.
+	 */
+	static void inOrderRec(const NodeType* node, void (*visit)(const T*, void*), void* context);
+
+	/**
+	 * @brief Recursively resolves the floors of keys[begin, end).
+	 * @param node The current node being examined.
+	 * @param keys The keys, ascending.
+	 * @param begin The first key handled by this subtree.
+	 * @param end One past the last key handled by this subtree.
+	 * @param keyOf Function returning the key of a value.
+	 * @param best The floor found on the path so far (nullptr if none).
+	 * @param out Receives the floor node of each key.
+	 */
+	template <class K, class KeyOf>
+	static void floorBatchRec(NodeType* node, const K* keys, size_t begin, size_t end, KeyOf keyOf,
+							  NodeType* best, NodeType** out);
+
+	/**
+	 * @brief Recursively calculates the height of the subtree rooted at node.
+	 * @param node The root of the subtree.
+	 * @return int The height of the subtree.
+	 */
+	static int heightRec(const NodeType* node);
+};
+
+// Template implementation
+
+/**
+ * @brief Default constructor implementation.
+ */
+template <class T>
+PersistentBst<T>::PersistentBst() : root(nullptr) {}
+
+/**
+ * @brief Destructor implementation. Releases the root.
+ */
+template <class T>
+PersistentBst<T>::~PersistentBst() {
+	release(root);
+}
+
+/**
+ * @brief Copy constructor implementation. Takes a reference to the other root.
+ * @param other The tree to copy.
+ */
+template <class T>
+PersistentBst<T>::PersistentBst(const PersistentBst<T>& other) : root(retain(other.root)) {}
+
+/**
+ * @brief Assignment operator implementation. Takes a reference to the other root before releasing this one.
+ * @param other The tree to assign from.
+ * @return PersistentBst<T>& Reference to the updated tree.
+ */
+template <class T>
+PersistentBst<T>& PersistentBst<T>::operator=(const PersistentBst<T>& other) {
+	NodeType* shared = retain(other.root);
+	release(root);
+	root = shared;
+	return *this;
+}
+
+/**
+ * @brief Increments a node's reference count.
+ * @param node The node (may be nullptr).
+ * @return NodeType* The node.
+ */
+template <class T>
+PersistentNode<T>* PersistentBst<T>::retain(NodeType* node) {
+	if (node) node->refs.fetch_add(1, std::memory_order_relaxed);
+	return node;
+}
+
+/**
+ * @brief Decrements reference counts, freeing every node that reaches zero.
+ *
+ * Uses an explicit stack rather than recursion, so releasing a degenerate (list-shaped)
+ * tree cannot overflow the call stack.
+ * @param node The node (may be nullptr).
+ */
+template <class T>
+void PersistentBst<T>::release(NodeType* node) {
+	std::vector<NodeType*> pending;
+	if (node) pending.push_back(node);
+	while (!pending.empty()) {
+		NodeType* current = pending.back();
+		pending.pop_back();
+		if (current->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) continue;
+		if (current->left) pending.push_back(current->left);
+		if (current->right) pending.push_back(current->right);
+		delete current;
+	}
+}
+
+/**
+ * @brief Returns the node itself if the caller's reference is its only one, else a private copy.
+ * @param node The node, of which the caller holds one reference.
+ * @return NodeType* A node the caller may modify.
+ */
+template <class T>
+PersistentNode<T>* PersistentBst<T>::own(NodeType* node) {
+	if (node->refs.load(std::memory_order_acquire) == 1) return node;
+	NodeType* copy = new NodeType(node);
+	release(node);
+	return copy;
+}
+
+/**
+ * @brief Inserts a value where its priority places it, copying the shared nodes on the way.
+ *
+ * The tree is searched first, so a duplicate costs no copies. The descent stops at the
+ * first node whose priority is lower than the new node's; that subtree is split around
+ * the value and becomes the new node's children.
+ * @param value The pointer to the data value to insert.
+ * @return bool True if inserted, false if an equal value was already present.
+ */
+template <class T>
+bool PersistentBst<T>::insert(T* value) {
+	if (search(value) != nullptr) return false;
+
+	NodeType* inserted = new NodeType(value);
+	NodeType** link = &root;
+	while (*link != nullptr && (*link)->priority >= inserted->priority) {
+		NodeType* node = own(*link);
+		*link = node;
+		node->subtreeSize += 1;
+		link = (*value < *(node->data)) ? &node->left : &node->right;
+	}
+	inserted->left = splitRec(*link, [value](const T* other) { return *other < *value; }, &inserted->right);
+	inserted->subtreeSize = 1 + TreeSlices::sizeOf(inserted->left) + TreeSlices::sizeOf(inserted->right);
+	*link = inserted;
+	return true;
+}
+
+/**
+ * @brief Searches for a value, descending from the root.
+ * @param value The pointer to the data value to search for.
+ * @return NodeType* The node containing the value, or nullptr if not found.
+ */
+template <class T>
+PersistentNode<T>* PersistentBst<T>::search(const T* value) const {
+	NodeType* node = root;
+	while (node != nullptr) {
+		if (*value < *(node->data)) {
+			node = node->left;
+		} else if (*value > *(node->data)) {
+			node = node->right;
+		} else {
+			return node;
+		}
+	}
+	return nullptr;
+}
+
+/**
+ * @brief Recursively splits a subtree, owning each node on the split path before relinking it.
+ * @param node The root of the subtree (reference transferred).
+ * @param goesLeft Predicate that is true for a prefix of the in-order sequence.
+ * @param right Receives the root of the nodes for which goesLeft is false.
+ * @return NodeType* The root of the nodes for which goesLeft is true.
+ */
+template <class T>
+template <class Pred>
+PersistentNode<T>* PersistentBst<T>::splitRec(NodeType* node, Pred goesLeft, NodeType** right) {
+	if (node == nullptr) {
+		*right = nullptr;
+		return nullptr;
+	}
+
+	node = own(node);
+	if (goesLeft(node->data)) {
+		// The node and its whole left subtree stay on the left
+		node->right = splitRec(node->right, goesLeft, right);
+		node->subtreeSize = 1 + TreeSlices::sizeOf(node->left) + TreeSlices::sizeOf(node->right);
+		return node;
+	}
+	NodeType* left = splitRec(node->left, goesLeft, &node->left);
+	node->subtreeSize = 1 + TreeSlices::sizeOf(node->left) + TreeSlices::sizeOf(node->right);
+	*right = node;
+	return left;
+}
+
+/**
+ * @brief Joins two trees, keeping the root with the higher priority and owning it before relinking.
+ * @param left The root of the tree holding the smaller values.
+ * @param right The root of the tree holding the larger values.
+ * @return NodeType* The root of the joined tree.
+ */
+template <class T>
+PersistentNode<T>* PersistentBst<T>::join(NodeType* left, NodeType* right) {
+	if (left == nullptr) return right;
+	if (right == nullptr) return left;
+
+	if (left->priority >= right->priority) {
+		left = own(left);
+		left->subtreeSize += right->subtreeSize;
+		left->right = join(left->right, right);
+		return left;
+	}
+	right = own(right);
+	right->subtreeSize += left->subtreeSize;
+	right->left = join(left, right->left);
+	return right;
+}
+
+/**
+ * @brief Counts a subtree's values, applying a function to each.
+ * @param node The root of the subtree.
+ * @param visit Function applied to each value (may be nullptr).
+ * @param context Opaque pointer passed to visit.
+ * @return int The number of values.
+ */
+template <class T>
+int PersistentBst<T>::visitRec(const NodeType* node, void (*visit)(const T*, void*), void* context) {
+	if (node == nullptr) return 0;
+
+	int visited = 1 + visitRec(node->left, visit, context) + visitRec(node->right, visit, context);
+	if (visit != nullptr) visit(node->data, context);
+	return visited;
+}
+
+/**
+ * @brief Removes every value inside a range: split, report and release the middle, join.
+ * @param below Predicate that is true for values ordered before the range.
+ * @param above Predicate that is true for values ordered after the range.
+ * @param onErase Function applied to each removed value (may be nullptr).
+ * @param context Opaque pointer passed to onErase.
+ * @return int The number of values removed.
+ */
+template <class T>
+template <class Below, class Above>
+int PersistentBst<T>::eraseRange(Below below, Above above, void (*onErase)(const T*, void*), void* context) {
+	NodeType* rest = nullptr;
+	NodeType* before = splitRec(root, below, &rest);
+
+	NodeType* after = nullptr;
+	NodeType* inside = splitRec(rest, [&above](const T* value) { return !above(value); }, &after);
+
+	root = join(before, after);
+	int removed = visitRec(inside, onErase, context);
+	release(inside);
+	return removed;
+}
+
+/**
+ * @brief Finds the largest value whose key is not greater than a key, descending from the root.
+ * @param key The key.
+ * @param keyOf Function returning the key of a value.
+ * @return NodeType* The floor node, or nullptr if none.
+ */
+template <class T>
+template <class K, class KeyOf>
+PersistentNode<T>* PersistentBst<T>::floor(const K& key, KeyOf keyOf) const {
+	NodeType* best = nullptr;
+	NodeType* node = root;
+	while (node != nullptr) {
+		if (key < keyOf(node->data)) {
+			node = node->left;
+		} else {
+			best = node;
+			node = node->right;
+		}
+	}
+	return best;
+}
+
+/**
+ * @brief Finds the smallest value whose key is not less than a key, descending from the root.
+ * @param key The key.
+ * @param keyOf Function returning the key of a value.
+ * @return NodeType* The ceiling node, or nullptr if none.
+ */
+template <class T>
+template <class K, class KeyOf>
+PersistentNode<T>* PersistentBst<T>::ceil(const K& key, KeyOf keyOf) const {
+	NodeType* best = nullptr;
+	NodeType* node = root;
+	while (node != nullptr) {
+		if (keyOf(node->data) < key) {
+			node = node->right;
+		} else {
+			best = node;
+			node = node->left;
+		}
+	}
+	return best;
+}
+
+/**
+ * @brief Recursively resolves the floors of keys[begin, end), as Bst::floorBatchRec.
+ * @param node The current node being examined.
+ * @param keys The keys, ascending.
+ * @param begin The first key handled by this subtree.
+ * @param end One past the last key handled by this subtree.
+ * @param keyOf Function returning the key of a value.
+ * @param best The floor found on the path so far (nullptr if none).
+ * @param out Receives the floor node of each key.
+ */
+template <class T>
+template <class K, class KeyOf>
+void PersistentBst<T>::floorBatchRec(NodeType* node, const K* keys, size_t begin, size_t end, KeyOf keyOf,
+									 NodeType* best, NodeType** out) {
+	if (begin == end) return;
+	if (node == nullptr) {
+		std::fill(out + begin, out + end, best);
+		return;
+	}
+
+	size_t split = static_cast<size_t>(std::lower_bound(keys + begin, keys + end, keyOf(node->data)) - keys);
+	floorBatchRec(node->left, keys, begin, split, keyOf, best, out);
+	floorBatchRec(node->right, keys, split, end, keyOf, node, out);
+}
+
+/**
+ * @brief Finds the floor of each of a sorted array of keys in one shared descent.
+ * @param keys The keys, ascending.
+ * @param count The number of keys.
+ * @param keyOf Function returning the key of a value.
+ * @param out Receives count nodes (nullptr where a key has no floor).
+ */
+template <class T>
+template <class K, class KeyOf>
+void PersistentBst<T>::floorBatch(const K* keys, size_t count, KeyOf keyOf, NodeType** out) const {
+	floorBatchRec(root, keys, 0, count, keyOf, nullptr, out);
+}
+
+/**
+ * @brief Performs recursive in-order traversal and applies the visit function.
+ * @param node The current node being examined.
+ * @param visit The function pointer to apply to each node's data.
+ */
+template <class T>
+void PersistentBst<T>::inOrderRec(const NodeType* node, void (*visit)(const T*)) {
+	if (node != nullptr) {
+		inOrderRec(node->left, visit);
+		visit(node->data);
+		inOrderRec(node->right, visit);
+	}
+}
+
+/**
+ * @brief Initiates an in-order traversal, applying the visit function to each node.
+ * @param visit The function pointer to apply to each node's data.
+ */
+template <class T>
+void PersistentBst<T>::inOrder(void (*visit)(const T*)) const {
+	inOrderRec(root, visit);
+}
+
+/**
+ * @brief Performs recursive in-order traversal, applying the visit function with a context pointer.
+ * @param node The current node being examined.
+ * @param visit The function pointer to apply (accepts data pointer and context pointer).
+ * @param context Opaque pointer to the context/collector struct.
+ */
+template <class T>
+void PersistentBst<T>::inOrderRec(const NodeType* node, void (*visit)(const T*, void*), void* context) {
+	if (node != nullptr) {
+		inOrderRec(node->left, visit, context);
+		visit(node->data, context);
+		inOrderRec(node->right, visit, context);
+	}
+}
+
+/**
+ * @brief Initiates an in-order traversal that uses a context pointer for collection.
+ * @param visit The function pointer to apply (accepts data pointer and context pointer).
+ * @param context Opaque pointer to the context/collector struct.
+ */
+template <class T>
+void PersistentBst<T>::inOrder(void (*visit)(const T*, void*), void* context) const {
+	inOrderRec(root, visit, context);
+}
+
+/**
+ * @brief Slices the in-order sequence by rank and visits the slices on the pool (see TreeSlices).
+ * @param visit The function applied to each value with its slice's result.
+ * @param results The per-slice results.
+ * @param pool The pool, or nullptr.
+ */
+template <class T>
+template <class Result>
+void PersistentBst<T>::parallelInOrder(void (*visit)(const T*, Result*), std::vector<Result>* results, TaskPool* pool) const {
+	TreeSlices::parallelInOrder(root, visit, results, pool);
+}
+
+/**
+ * @brief Recursively calculates the height of the subtree rooted at node.
+ * @param node The root of the subtree.
+ * @return int The height of the subtree.
+ */
+template <class T>
+int PersistentBst<T>::heightRec(const NodeType* node) {
+	if (node == nullptr) return -1;
+	return 1 + std::max(heightRec(node->left), heightRec(node->right));
+}
+
+/**
+ * @brief Gets the height of the tree.
+ * @return int The height of the tree, or -1 if the tree is empty.
+ */
+template <class T>
+int PersistentBst<T>::height() const {
+	return heightRec(root);
+}
+
+#endif // PERSISTENTBST_H
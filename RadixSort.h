@@ -0,0 +1,157 @@
+#ifndef RADIXSORT_H
+#define RADIXSORT_H
+
+#include "TaskPool.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Namespace for least-significant-digit radix sorting on packed integer keys.
+ *
+ * Keys are unsigned 32 or 64 bit integers (see packKey for minute keys) sorted one byte
+ * at a time, lowest byte first, each pass a stable counting scatter. A payload travels
+ * with each key: a record pointer, or a row index whose final order is the permutation
+ * to apply to column arrays. Passes in which every key has the same byte (the high bytes
+ * of timestamps from a few years, for instance) are skipped.
+ *
+ * The sort is stable, so of several items with one key the earliest keeps its place. With
+ * a TaskPool, each pass is split into one slice per thread: the slices count their bytes
+ * in parallel, the counts are turned into per-slice write offsets, and the slices scatter
+ * in parallel into disjoint positions, which keeps the result identical to the sequential one.
+ */
+namespace RadixSort {
+	/**
+	 * @brief Inputs shorter than this are sorted on the calling thread.
+	 */
+	const size_t kParallelThreshold = 1 << 16;
+
+	/**
+	 * @brief Maps a signed minute key (see Date::toMinuteKey) to an unsigned key with the same order.
+	 * @param key The signed key.
+	 * @return uint32_t The packed key.
+	 */
+	inline uint32_t packKey(int key) {
+		return static_cast<uint32_t>(key) ^ 0x80000000u;
+	}
+
+	/**
+	 * @brief Sorts keys ascending, moving each payload with its key. Stable.
+	 * @tparam Key uint32_t or uint64_t.
+	 * @tparam Payload Any copyable type (a pointer or an index).
+	 * @param keys A pointer to the keys.
+	 * @param payloads A pointer to the payloads, as many as keys.
+	 * @param pool The pool for the parallel passes, or nullptr to sort on the calling thread.
+	 */
+	template <class Key, class Payload>
+	void sortPairs(std::vector<Key>* keys, std::vector<Payload>* payloads, TaskPool* pool = nullptr) {
+		const size_t n = keys->size();
+		if (n < 2) return;
+
+		size_t slices = 1;
+		if (pool != nullptr && n >= kParallelThreshold) {
+			slices = static_cast<size_t>(pool->getThreadCount()) + 1;
+		}
+		const size_t sliceLength = (n + slices - 1) / slices;
+
+		std::vector<Key> keyBuffer(n);
+		std::vector<Payload> payloadBuffer(n);
+		Key* keyIn = keys->data();
+		Key* keyOut = keyBuffer.data();
+		Payload* payloadIn = payloads->data();
+		Payload* payloadOut = payloadBuffer.data();
+
+		// counts[s * 256 + b]: items of slice s whose current byte is b; then its write offset
+		std::vector<size_t> counts(slices * 256);
+
+		for (unsigned shift = 0; shift < sizeof(Key) * 8; shift += 8) {
+			std::fill(counts.begin(), counts.end(), 0);
+
+			auto countSlices = [&](size_t first, size_t last) {
+				for (size_t s = first; s < last; ++s) {
+					size_t* sliceCounts = &counts[s * 256];
+					size_t end = std::min(n, (s + 1) * sliceLength);
+					for (size_t i = s * sliceLength; i < end; ++i) {
+						sliceCounts[(keyIn[i] >> shift) & 0xFF] += 1;
+					}
+				}
+			};
+			if (slices > 1) {
+				pool->parallelFor(slices, 1, countSlices, "radix.count");
+			} else {
+				countSlices(0, 1);
+			}
+
+			// A byte shared by every key leaves the order unchanged
+			bool trivial = false;
+			for (size_t b = 0; b < 256 && !trivial; ++b) {
+				size_t total = 0;
+				for (size_t s = 0; s < slices; ++s) {
+					total += counts[s * 256 + b];
+				}
+				if (total == n) trivial = true;
+				else if (total != 0) break;
+			}
+			if (trivial) continue;
+
+			// Byte-major, slice-minor offsets keep equal bytes in input order
+			size_t offset = 0;
+			for (size_t b = 0; b < 256; ++b) {
+				for (size_t s = 0; s < slices; ++s) {
+					size_t count = counts[s * 256 + b];
+					counts[s * 256 + b] = offset;
+					offset += count;
+				}
+			}
+
+			auto scatterSlices = [&](size_t first, size_t last) {
+				for (size_t s = first; s < last; ++s) {
+					size_t* next = &counts[s * 256];
+					size_t end = std::min(n, (s + 1) * sliceLength);
+					for (size_t i = s * sliceLength; i < end; ++i) {
+						size_t to = next[(keyIn[i] >> shift) & 0xFF]++;
+						keyOut[to] = keyIn[i];
+						payloadOut[to] = payloadIn[i];
+					}
+				}
+			};
+			if (slices > 1) {
+				pool->parallelFor(slices, 1, scatterSlices, "radix.scatter");
+			} else {
+				scatterSlices(0, 1);
+			}
+
+			std::swap(keyIn, keyOut);
+			std::swap(payloadIn, payloadOut);
+		}
+
+		// After an odd number of scattering passes the result sits in the buffers
+		if (keyIn != keys->data()) {
+			std::copy(keyIn, keyIn + n, keys->data());
+			std::copy(payloadIn, payloadIn + n, payloads->data());
+		}
+	}
+
+	/**
+	 * @brief Computes the stable ascending order of a set of keys as a permutation of row indices.
+	 *
+	 * Use it to reorder several parallel column arrays by the same keys: row order[i] of each
+	 * column belongs at position i.
+	 * @tparam Key uint32_t or uint64_t.
+	 * @param keys A constant pointer to the keys (left unchanged).
+	 * @param order Receives the permutation (overwritten).
+	 * @param pool The pool for the parallel passes, or nullptr.
+	 */
+	template <class Key>
+	void sortedOrder(const std::vector<Key>* keys, std::vector<uint32_t>* order, TaskPool* pool = nullptr) {
+		std::vector<Key> work(*keys);
+		order->resize(keys->size());
+		for (size_t i = 0; i < order->size(); ++i) {
+			(*order)[i] = static_cast<uint32_t>(i);
+		}
+		sortPairs(&work, order, pool);
+	}
+}
+
+#endif // RADIXSORT_H
@@ -0,0 +1,311 @@
+// ReservoirSampler.cpp
+
+// Implements ReservoirSampler: per-(year, month) reservoirs maintained on insert and
+// removal, and stratified estimates of means and correlations with confidence intervals.
+
+#include "ReservoirSampler.h"
+#include "Statistics.h"
+#include <algorithm>
+#include <cmath>
+
+const int ReservoirSampler::kDefaultCapacity;
+
+	/**
+	 * @brief Constructor for ReservoirSampler.
+	 *
+	 * @param  capacity - Reservoir size per stratum (values below 1 count as 1).
+	 * @param  seed - Seed of the random replacement choices.
+	 * @return void
+	 */
+ReservoirSampler::ReservoirSampler(int capacity, uint64_t seed)
+	: capacity(std::max(1, capacity)), state(seed) {}
+
+	/**
+	 * @brief Returns the next splitmix64 number.
+	 *
+	 * @return uint64_t - The number.
+	 */
+uint64_t ReservoirSampler::nextRandom() {
+	uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+	/**
+	 * @brief Counts a record and offers it to the reservoir.
+	 *
+	 * While removals are unmatched, the record pairs with one of them: it joins the
+	 * reservoir with probability removedKept / (removedKept + removedOther), and the
+	 * matching counter drops. Otherwise algorithm R applies: kept if the reservoir has room,
+	 * else in place of a random sample with probability capacity / population.
+	 *
+	 * @param  record - Pointer to the record.
+	 * @return void
+	 */
+void ReservoirSampler::add(const WeatherRecord* record) {
+	int key = stratumKey(record->date->GetYear(), record->date->GetMonth());
+	Shared<Stratum>* handle = strata.at(&key);
+	if (!*handle) handle->reset(new Stratum());
+	Stratum* stratum = handle->edit();
+	stratum->population += 1;
+
+	Sample sample;
+	sample.key = record->date->toMinuteKey();
+	for (int m = 0; m < kMetricCount; ++m) {
+		sample.values[m] = metricValue(record, static_cast<Metric>(m));
+	}
+
+	unsigned long unmatched = stratum->removedKept + stratum->removedOther;
+	if (unmatched > 0) {
+		if (nextRandom() % unmatched < stratum->removedKept) {
+			stratum->removedKept -= 1;
+			stratum->samples.push_back(sample);
+		} else {
+			stratum->removedOther -= 1;
+		}
+		return;
+	}
+
+	if (stratum->samples.size() < static_cast<size_t>(capacity)) {
+		stratum->samples.push_back(sample);
+		return;
+	}
+	uint64_t slot = nextRandom() % stratum->population;
+	if (slot < static_cast<uint64_t>(capacity)) {
+		stratum->samples[static_cast<size_t>(slot)] = sample;
+	}
+}
+
+	/**
+	 * @brief Uncounts a record, drops it from the reservoir if it was kept and records the unmatched removal; an emptied stratum is removed.
+	 *
+	 * @param  record - Pointer to the record.
+	 * @return void
+	 */
+void ReservoirSampler::remove(const WeatherRecord* record) {
+	int key = stratumKey(record->date->GetYear(), record->date->GetMonth());
+	if (!strata.contains(&key)) return;
+
+	Shared<Stratum>* handle = strata.at(&key);
+	if (handle->get()->population <= 1) {
+		strata.erase(&key);
+		return;
+	}
+	Stratum* stratum = handle->edit();
+	stratum->population -= 1;
+
+	int minuteKey = record->date->toMinuteKey();
+	std::vector<Sample>& samples = stratum->samples;
+	for (size_t i = 0; i < samples.size(); ++i) {
+		if (samples[i].key == minuteKey) {
+			samples[i] = samples.back();
+			samples.pop_back();
+			stratum->removedKept += 1;
+			return;
+		}
+	}
+	stratum->removedOther += 1;
+}
+
+	/**
+	 * @brief Removes every stratum.
+	 *
+	 * @return void
+	 */
+void ReservoirSampler::clear() {
+	strata = Map<int, Shared<Stratum>>();
+}
+
+	/**
+	 * @brief Lists the years with a stratum in a month.
+	 *
+	 * @param  month - The month (1-12).
+	 * @param  years - Pointer to the vector receiving the years.
+	 * @return void
+	 */
+void ReservoirSampler::years(int month, std::vector<int>* years) const {
+	std::vector<int> keys;
+	strata.keys(&keys);
+	years->clear();
+	for (int key : keys) {
+		if (key % 12 == month - 1) years->push_back(key / 12);
+	}
+}
+
+	/**
+	 * @brief Collects the strata with readings of a year and month, or of a month in every year.
+	 *
+	 * A stratum whose reservoir was emptied by removals is still selected, so the
+	 * estimators can see that part of the population has no samples.
+	 *
+	 * @param  year - The year (0 for all years).
+	 * @param  month - The month.
+	 * @param  selected - Pointer to the vector receiving the strata.
+	 * @return void
+	 */
+void ReservoirSampler::select(int year, int month, std::vector<const Stratum*>* selected) const {
+	selected->clear();
+	if (month < 1 || month > 12) return;
+
+	std::vector<int> matching;
+	if (year == 0) {
+		years(month, &matching);
+	} else {
+		matching.push_back(year);
+	}
+	for (int y : matching) {
+		int key = stratumKey(y, month);
+		if (!strata.contains(&key)) continue;
+		const Stratum* stratum = strata.at(&key)->get();
+		if (stratum->population > 0) selected->push_back(stratum);
+	}
+}
+
+	/**
+	 * @brief Stratified estimate of a mean.
+	 *
+	 * The estimate is sum(W_h * mean_h) with W_h = N_h / N, and its variance
+	 * sum(W_h^2 * (1 - n_h / N_h) * s_h^2 / n_h), for stratum sizes N_h and sample sizes n_h.
+	 * If a stratum has readings but no samples the mean cannot be estimated, and the
+	 * estimate is returned empty: inexact, with sampled 0 and the full population. Wind
+	 * direction has no linear mean, so it matches nothing.
+	 *
+	 * @param  metric - The metric.
+	 * @param  year - The year (0 for all years).
+	 * @param  month - The month.
+	 * @param  confidence - The confidence level.
+	 * @return Estimate - The estimate and its interval.
+	 */
+Estimate ReservoirSampler::mean(Metric metric, int year, int month, double confidence) const {
+	Estimate estimate = {0.0, 0.0, 0.0, 0.0, 0, 0, true};
+	if (!isLinearMetric(metric)) return estimate;
+	std::vector<const Stratum*> selected;
+	select(year, month, &selected);
+
+	bool unsampled = false;
+	for (const Stratum* stratum : selected) {
+		estimate.population += stratum->population;
+		if (stratum->samples.empty()) unsampled = true;
+	}
+	if (estimate.population == 0) return estimate;
+	if (unsampled) {
+		estimate.exact = false;
+		return estimate;
+	}
+
+	const int m = static_cast<int>(metric);
+	double variance = 0.0;
+	for (const Stratum* stratum : selected) {
+		double n = static_cast<double>(stratum->samples.size());
+		double sum = 0.0;
+		for (const Sample& sample : stratum->samples) {
+			sum += sample.values[m];
+		}
+		double stratumMean = sum / n;
+
+		double squares = 0.0;
+		for (const Sample& sample : stratum->samples) {
+			double d = sample.values[m] - stratumMean;
+			squares += d * d;
+		}
+
+		double weight = static_cast<double>(stratum->population) / estimate.population;
+		double fpc = 1.0 - n / stratum->population;
+		estimate.value += weight * stratumMean;
+		if (n > 1.0) variance += weight * weight * fpc * (squares / (n - 1.0)) / n;
+		estimate.sampled += stratum->samples.size();
+		if (stratum->samples.size() < stratum->population) estimate.exact = false;
+	}
+
+	estimate.standardError = estimate.exact ? 0.0 : std::sqrt(std::max(0.0, variance));
+	double margin = Statistics::normalCriticalValue(confidence) * estimate.standardError;
+	estimate.lower = estimate.value - margin;
+	estimate.upper = estimate.value + margin;
+	return estimate;
+}
+
+	/**
+	 * @brief Stratified estimate of a Pearson correlation.
+	 *
+	 * Each sample stands for N_h / n_h readings of its stratum, and r is computed from the
+	 * weighted moments. The interval is tanh(atanh(r) +- z * se) with
+	 * se = sqrt(1 - n / N) / sqrt(n - 3) (Fisher), and [-1, 1] with fewer than 4 samples.
+	 * A stratum with readings but no samples makes the estimate empty, as in mean().
+	 *
+	 * @param  x - The first metric.
+	 * @param  y - The second metric.
+	 * @param  year - The year (0 for all years).
+	 * @param  month - The month.
+	 * @param  confidence - The confidence level.
+	 * @return Estimate - The estimate and its interval.
+	 */
+Estimate ReservoirSampler::correlation(Metric x, Metric y, int year, int month, double confidence) const {
+	Estimate estimate = {0.0, 0.0, 0.0, 0.0, 0, 0, true};
+	std::vector<const Stratum*> selected;
+	select(year, month, &selected);
+
+	bool unsampled = false;
+	for (const Stratum* stratum : selected) {
+		estimate.population += stratum->population;
+		if (stratum->samples.empty()) unsampled = true;
+	}
+	if (estimate.population == 0) return estimate;
+	if (unsampled) {
+		estimate.exact = false;
+		return estimate;
+	}
+
+	const int mx = static_cast<int>(x);
+	const int my = static_cast<int>(y);
+	double sumX = 0.0, sumY = 0.0;
+	for (const Stratum* stratum : selected) {
+		double weight = static_cast<double>(stratum->population) / stratum->samples.size();
+		double sx = 0.0, sy = 0.0;
+		for (const Sample& sample : stratum->samples) {
+			sx += sample.values[mx];
+			sy += sample.values[my];
+		}
+		sumX += weight * sx;
+		sumY += weight * sy;
+		estimate.sampled += stratum->samples.size();
+		if (stratum->samples.size() < stratum->population) estimate.exact = false;
+	}
+
+	double meanX = sumX / estimate.population;
+	double meanY = sumY / estimate.population;
+	double sxx = 0.0, syy = 0.0, sxy = 0.0;
+	for (const Stratum* stratum : selected) {
+		double weight = static_cast<double>(stratum->population) / stratum->samples.size();
+		for (const Sample& sample : stratum->samples) {
+			double dx = sample.values[mx] - meanX;
+			double dy = sample.values[my] - meanY;
+			sxx += weight * dx * dx;
+			syy += weight * dy * dy;
+			sxy += weight * dx * dy;
+		}
+	}
+
+	double spread = std::sqrt(sxx * syy);
+	estimate.value = spread < 1e-10 ? 0.0 : std::max(-1.0, std::min(1.0, sxy / spread));
+
+	if (estimate.exact) {
+		estimate.lower = estimate.upper = estimate.value;
+		return estimate;
+	}
+	if (estimate.sampled < 4) {
+		estimate.lower = -1.0;
+		estimate.upper = 1.0;
+		estimate.standardError = 1.0;
+		return estimate;
+	}
+
+	double n = static_cast<double>(estimate.sampled);
+	double fisherError = std::sqrt(std::max(0.0, 1.0 - n / estimate.population)) / std::sqrt(n - 3.0);
+	double z = std::atanh(std::max(-0.999999, std::min(0.999999, estimate.value)));
+	double margin = Statistics::normalCriticalValue(confidence) * fisherError;
+	estimate.lower = std::tanh(z - margin);
+	estimate.upper = std::tanh(z + margin);
+	estimate.standardError = fisherError * (1.0 - estimate.value * estimate.value);
+	return estimate;
+}
@@ -0,0 +1,163 @@
+#ifndef RESERVOIRSAMPLER_H
+#define RESERVOIRSAMPLER_H
+
+#include "Map.h"
+#include "Metric.h"
+#include "Shared.h"
+#include "WeatherRecord.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct Estimate
+ * @brief A statistic with its confidence interval.
+ */
+struct Estimate {
+	double value;              ///< The estimate (0 if nothing matched).
+	double lower;              ///< Lower end of the confidence interval.
+	double upper;              ///< Upper end of the confidence interval.
+	double standardError;      ///< Standard error of the estimate (0 when exact).
+	unsigned long sampled;     ///< Readings the estimate was computed from (0 with a nonzero population if it could not be estimated).
+	unsigned long population;  ///< Readings the estimate stands for.
+	bool exact;                ///< True if every reading was used, so the interval is the value itself.
+};
+
+/**
+ * @class ReservoirSampler
+ * @brief Uniform random samples of the readings of every (year, month), kept up to date on insert.
+ *
+ * Each (year, month) stratum holds its reading count and a reservoir of at most capacity
+ * readings (Vitter's algorithm R): the first capacity readings are kept, and the n-th
+ * reading after that replaces a random kept one with probability capacity / n, so the
+ * reservoir is always a uniform sample of the stratum. A removed reading leaves the count
+ * and, if it was kept, the reservoir, which stays a uniform sample of what is left.
+ *
+ * Removals are compensated by random pairing (Gemulla et al.): each stratum counts the
+ * removals not yet matched by an insert, split by whether the reading was kept, and the
+ * next inserts pair with them, joining the reservoir with probability kept / unmatched,
+ * before algorithm R takes over again. Refilling a shrunken reservoir with every new
+ * reading would over-weight the latest ones; pairing keeps the sample uniform.
+ *
+ * Strata sit behind Shared handles, so a copy of a sampler shares them and copies only
+ * the strata it later changes.
+ *
+ * Queries combine strata with the usual stratified estimators: means are weighted by the
+ * strata's shares of the population with a finite population correction, so a stratum
+ * sampled in full contributes no error; correlations use the weighted sample moments and a
+ * Fisher z interval. Answers cost O(samples), independent of the archive size.
+ */
+class ReservoirSampler {
+public:
+	/**
+	 * @brief Default reservoir size per stratum.
+	 */
+	static const int kDefaultCapacity = 512;
+
+	/**
+	 * @brief Constructor. Creates an empty sampler.
+	 * @param capacity The reservoir size per stratum (at least 1).
+	 * @param seed The seed of the replacement choices, so runs are reproducible.
+	 */
+	explicit ReservoirSampler(int capacity = kDefaultCapacity, uint64_t seed = 0x5eed5eed5eedULL);
+
+	/**
+	 * @brief Counts a record in its stratum and offers it to the stratum's reservoir.
+	 * @param record A constant pointer to the record.
+	 */
+	void add(const WeatherRecord* record);
+
+	/**
+	 * @brief Takes a record that was added earlier out of its stratum.
+	 * @param record A constant pointer to the record.
+	 */
+	void remove(const WeatherRecord* record);
+
+	/**
+	 * @brief Empties every stratum.
+	 */
+	void clear();
+
+	/**
+	 * @brief Estimates the mean of a metric on a linear scale (wind direction is not supported; see isLinearMetric).
+	 * @param metric The metric.
+	 * @param year The year (0 for all years).
+	 * @param month The month (1-12).
+	 * @param confidence The confidence level of the interval (e.g. 0.95).
+	 * @return Estimate The estimate (all zero with population 0 if nothing matched or for wind direction; empty with sampled 0 if a stratum with readings has no samples).
+	 */
+	Estimate mean(Metric metric, int year, int month, double confidence) const;
+
+	/**
+	 * @brief Estimates the Pearson correlation of two metrics.
+	 * @param x The first metric.
+	 * @param y The second metric.
+	 * @param year The year (0 for all years).
+	 * @param month The month (1-12).
+	 * @param confidence The confidence level of the interval (e.g. 0.95).
+	 * @return Estimate The estimate (all zero with population 0 if nothing matched; empty with sampled 0 if a stratum with readings has no samples).
+	 */
+	Estimate correlation(Metric x, Metric y, int year, int month, double confidence) const;
+
+	/**
+	 * @brief Lists the years that have readings in a month.
+	 * @param month The month (1-12).
+	 * @param years Receives the years, ascending (overwritten).
+	 */
+	void years(int month, std::vector<int>* years) const;
+
+	/**
+	 * @brief Gets the reservoir size per stratum.
+	 * @return int The capacity.
+	 */
+	int getCapacity() const { return capacity; }
+
+private:
+	/**
+	 * @struct Sample
+	 * @brief One kept reading.
+	 */
+	struct Sample {
+		int key;                      ///< Minute key of the reading.
+		double values[kMetricCount];  ///< The reading's metrics.
+	};
+
+	/**
+	 * @struct Stratum
+	 * @brief The readings of one (year, month).
+	 */
+	struct Stratum {
+		unsigned long population;     ///< Readings in the stratum.
+		unsigned long removedKept;    ///< Unmatched removals of readings that were in the reservoir.
+		unsigned long removedOther;   ///< Unmatched removals of readings that were not.
+		std::vector<Sample> samples;  ///< The reservoir.
+	};
+
+	/**
+	 * @brief Collects the strata a query covers.
+	 * @param year The year (0 for all years).
+	 * @param month The month.
+	 * @param strata Receives the strata.
+	 */
+	void select(int year, int month, std::vector<const Stratum*>* strata) const;
+
+	/**
+	 * @brief Returns the next pseudo-random number (splitmix64).
+	 * @return uint64_t The number.
+	 */
+	uint64_t nextRandom();
+
+	/**
+	 * @brief Returns the key of the stratum of a year and month.
+	 * @param year The year.
+	 * @param month The month (1-12).
+	 * @return int The stratum key.
+	 */
+	static int stratumKey(int year, int month) { return year * 12 + (month - 1); }
+
+	int capacity;               ///< Reservoir size per stratum.
+	uint64_t state;             ///< Random number generator state.
+	Map<int, Shared<Stratum>> strata; ///< Strata by stratumKey, shared between copies until changed.
+};
+
+#endif // RESERVOIRSAMPLER_H
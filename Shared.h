@@ -0,0 +1,137 @@
+#ifndef SHARED_H
+#define SHARED_H
+
+#include <atomic>
+
+/// @class Shared
+/// @brief Reference-counted handle to a heap value, shared by copies and copied on write.
+///
+/// Copying a handle only takes a reference, so a structure that keeps its parts behind
+/// handles copies in time proportional to the number of parts, not their size. Reading
+/// goes through the const accessors; edit() first gives this handle its own copy of the
+/// value if any other handle still refers to it, so a change never shows through another
+/// copy. A handle may be empty (nullptr).
+///
+/// Reference counts are atomic, as in PersistentNode, so handles sharing a value may be
+/// copied, edited and destroyed on different threads; a single handle is not itself
+/// thread-safe.
+template <class T>
+class Shared {
+public:
+	/**
+	 * @brief Default constructor. Creates an empty handle.
+	 */
+	Shared() : block(nullptr) {}
+
+	/**
+	 * @brief Constructs a handle that takes ownership of a value.
+	 * @param value The pointer to the value (may be nullptr).
+	 */
+	explicit Shared(T* value) : block(value ? new Block(value) : nullptr) {}
+
+	/**
+	 * @brief Copy constructor. Shares the other handle's value.
+	 * @param other The handle to copy.
+	 */
+	Shared(const Shared<T>& other) : block(retain(other.block)) {}
+
+	/**
+	 * @brief Assignment operator. Shares the other handle's value and releases this one's.
+	 * @param other The handle to assign from.
+	 * @return Shared<T>& Reference to this handle.
+	 */
+	Shared<T>& operator=(const Shared<T>& other) {
+		Block* shared = retain(other.block);
+		release(block);
+		block = shared;
+		return *this;
+	}
+
+	/**
+	 * @brief Destructor. Deletes the value once no handle refers to it.
+	 */
+	~Shared() { release(block); }
+
+	/**
+	 * @brief Replaces the value, taking ownership of the new one.
+	 * @param value The pointer to the new value (may be nullptr).
+	 */
+	void reset(T* value = nullptr) {
+		Block* replacement = value ? new Block(value) : nullptr;
+		release(block);
+		block = replacement;
+	}
+
+	/**
+	 * @brief Gets the value for reading.
+	 * @return const T* The value, or nullptr if the handle is empty.
+	 */
+	const T* get() const { return block ? block->value : nullptr; }
+
+	/**
+	 * @brief Accesses a member of the value for reading.
+	 * @return const T* The value.
+	 */
+	const T* operator->() const { return block->value; }
+
+	/**
+	 * @brief Checks whether the handle holds a value.
+	 * @return bool True if not empty.
+	 */
+	explicit operator bool() const { return block != nullptr; }
+
+	/**
+	 * @brief Gets the value for writing, first copying it if another handle shares it.
+	 * @return T* The value this handle alone refers to, or nullptr if the handle is empty.
+	 */
+	T* edit() {
+		if (!block) return nullptr;
+		if (block->refs.load(std::memory_order_acquire) != 1) {
+			Block* copy = new Block(new T(*block->value));
+			release(block);
+			block = copy;
+		}
+		return block->value;
+	}
+
+private:
+	/**
+	 * @struct Block
+	 * @brief The value and its reference count.
+	 */
+	struct Block {
+		T* value;               ///< The shared value.
+		std::atomic<int> refs;  ///< Handles referring to the value.
+
+		/**
+		 * @brief Constructs a block with one reference.
+		 * @param value The value (ownership is taken).
+		 */
+		explicit Block(T* value) : value(value), refs(1) {}
+	};
+
+	/**
+	 * @brief Takes a reference to a block.
+	 * @param block The block (may be nullptr).
+	 * @return Block* The same block.
+	 */
+	static Block* retain(Block* block) {
+		if (block) block->refs.fetch_add(1, std::memory_order_relaxed);
+		return block;
+	}
+
+	/**
+	 * @brief Drops a reference to a block, deleting it and its value with the last one.
+	 * @param block The block (may be nullptr).
+	 */
+	static void release(Block* block) {
+		if (block && block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			delete block->value;
+			delete block;
+		}
+	}
+
+	Block* block; ///< The shared block, or nullptr.
+};
+
+#endif // SHARED_H
@@ -2,10 +2,10 @@
 
 // Implements various statistical calculation functions, including mean,
 // standard deviation, mean absolute deviation (MAD), and Sample Pearson
-// Correlation Coefficient (SPCC).
+// Correlation Coefficient (SPCC) on vectors of doubles, through the view templates
+// of Statistics.h, and the normal critical value.
 
 #include "Statistics.h"
-#include <cmath>
 
 namespace Statistics {
 	/**
@@ -15,12 +15,7 @@ namespace Statistics {
 	 * @return double - The calculated mean, or 0.0 if the vector is empty.
 	 */
 	double calculateMean(const std::vector<double>* values) {
-		if (values->empty()) return 0.0;
-		double sum = 0.0;
-		for (double val : *values) {
-			sum += val;
-		}
-		return sum / values->size();
+		return calculateMean<std::vector<double>>(values);
 	}
 
 	/**
@@ -32,13 +27,7 @@ namespace Statistics {
 	 * @return double - The calculated standard deviation, or 0.0 if there is less than two values.
 	 */
 	double calculateStdDev(const std::vector<double>* values) {
-		if (values->size() < 2) return 0.0;
-		double mean = calculateMean(values);
-		double sumSq = 0.0;
-		for (double val : *values) {
-			sumSq += (val - mean) * (val - mean);
-		}
-		return std::sqrt(sumSq / (values->size() - 1));
+		return calculateStdDev<std::vector<double>>(values);
 	}
 
 	/**
@@ -50,13 +39,7 @@ namespace Statistics {
 	 * @return double - The calculated MAD, or 0.0 if the vector is empty.
 	 */
 	double calculateMAD(const std::vector<double>* values) {
-		if (values->empty()) return 0.0;
-		double mean = calculateMean(values);
-		double sumAbs = 0.0;
-		for (double val : *values) {
-			sumAbs += std::abs(val - mean);
-		}
-		return sumAbs / values->size();
+		return calculateMAD<std::vector<double>>(values);
 	}
 
 	/**
@@ -67,24 +50,24 @@ namespace Statistics {
 	 * @return double - The calculated SPCC (range [-1, 1]), or 0.0 if datasets are too small or unequal size.
 	 */
 	double calculateSPCC(const std::vector<double>* x, const std::vector<double>* y) {
-		if (x->size() != y->size() || x->size() < 2) return 0.0;
-
-		int n = x->size();
-		double sum_x = 0.0, sum_y = 0.0;
-		double sum_xy = 0.0, sum_x2 = 0.0, sum_y2 = 0.0;
-
-		for (int i = 0; i < n; ++i) {
-			sum_x += (*x)[i];
-			sum_y += (*y)[i];
-			sum_xy += (*x)[i] * (*y)[i];
-			sum_x2 += (*x)[i] * (*x)[i];
-			sum_y2 += (*y)[i] * (*y)[i];
-		}
+		return calculateSPCC<std::vector<double>, std::vector<double>>(x, y);
+	}
 
-		double numerator = n * sum_xy - sum_x * sum_y;
-		double denominator = std::sqrt((n * sum_x2 - sum_x * sum_x) * (n * sum_y2 - sum_y * sum_y));
+	/**
+	 * @brief Calculates the two-sided standard normal critical value for a confidence level.
+	 *
+	 * With p = (1 - confidence) / 2 and t = sqrt(-2 ln p), the upper p-quantile is
+	 * t - (c0 + c1 t + c2 t^2) / (1 + d1 t + d2 t^2 + d3 t^3) (Abramowitz and Stegun 26.2.23).
+	 *
+	 * @param  confidence - The confidence level, in (0, 1).
+	 * @return double - The critical value, or 0.0 for levels outside (0, 1).
+	 */
+	double normalCriticalValue(double confidence) {
+		if (!(confidence > 0.0 && confidence < 1.0)) return 0.0;
 
-		if (std::abs(denominator) < 1e-10) return 0.0;
-		return numerator / denominator;
+		double p = (1.0 - confidence) / 2.0;
+		double t = std::sqrt(-2.0 * std::log(p));
+		return t - (2.515517 + 0.802853 * t + 0.010328 * t * t) /
+				   (1.0 + 1.432788 * t + 0.189269 * t * t + 0.001308 * t * t * t);
 	}
 }
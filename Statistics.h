@@ -1,6 +1,10 @@
 #ifndef STATISTICS_H
 #define STATISTICS_H
 
+#include "TaskPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <vector>
 
 /**
@@ -9,8 +13,245 @@
  * This namespace provides several static functions for common statistical
  * calculations, specifically designed to accept constant pointers to
  * standard C++ vectors of doubles.
+ *
+ * Each calculation is also a template over a view: any type with size() and an
+ * operator[](size_t) whose result converts to double. A std::vector<float> works as it
+ * is; Span, StridedView and ProjectedView read a contiguous array, one field of an array
+ * of structs, or a value computed from each element of a container (a record's column,
+ * for instance), and ConcatView reads one view after another (ColumnStore::ColumnView
+ * followed by the delta records, for instance), so the kernels run where the data
+ * already is instead of on a gathered copy. Values are widened to double as they are read, and the sums are the same
+ * chunked reductions as for vectors, so a view over the values of a vector gives
+ * exactly the vector's result.
  */
 namespace Statistics {
+	/**
+	 * @brief Values per reduction chunk.
+	 */
+	const size_t kChunk = 1 << 14;
+
+	/**
+	 * @brief Inputs shorter than this are reduced on the calling thread.
+	 */
+	const size_t kParallelThreshold = 1 << 15;
+
+	/**
+	 * @class Span
+	 * @brief View of a contiguous array.
+	 * @tparam T The element type (e.g. float or double).
+	 */
+	template <class T>
+	class Span {
+	public:
+		/**
+		 * @brief Constructor.
+		 * @param values A constant pointer to the first element.
+		 * @param count The number of elements.
+		 */
+		Span(const T* values, size_t count) : values(values), count(count) {}
+
+		/**
+		 * @brief Gets the number of elements.
+		 * @return size_t The count.
+		 */
+		size_t size() const { return count; }
+
+		/**
+		 * @brief Reads an element.
+		 * @param i The index.
+		 * @return const T& The element.
+		 */
+		const T& operator[](size_t i) const { return values[i]; }
+
+	private:
+		const T* values; ///< First element.
+		size_t count;    ///< Number of elements.
+	};
+
+	/**
+	 * @class StridedView
+	 * @brief View of elements a fixed number of bytes apart, such as one field of an array of structs.
+	 * @tparam T The element type.
+	 */
+	template <class T>
+	class StridedView {
+	public:
+		/**
+		 * @brief Constructor.
+		 * @param first A constant pointer to the first element (e.g. &records[0].temperature).
+		 * @param count The number of elements.
+		 * @param strideBytes The distance between consecutive elements, in bytes (e.g. sizeof(WeatherRecord)).
+		 */
+		StridedView(const T* first, size_t count, size_t strideBytes)
+			: first(reinterpret_cast<const unsigned char*>(first)), count(count), stride(strideBytes) {}
+
+		/**
+		 * @brief Gets the number of elements.
+		 * @return size_t The count.
+		 */
+		size_t size() const { return count; }
+
+		/**
+		 * @brief Reads an element.
+		 * @param i The index.
+		 * @return const T& The element.
+		 */
+		const T& operator[](size_t i) const { return *reinterpret_cast<const T*>(first + i * stride); }
+
+	private:
+		const unsigned char* first; ///< Address of the first element.
+		size_t count;               ///< Number of elements.
+		size_t stride;              ///< Bytes between elements.
+	};
+
+	/**
+	 * @class ProjectedView
+	 * @brief View of a value computed from each element of a container.
+	 * @tparam Source The container (any type with size() and operator[]).
+	 * @tparam Projection Callable applied to each element (e.g. MetricColumn<M>::get).
+	 */
+	template <class Source, class Projection>
+	class ProjectedView {
+	public:
+		/**
+		 * @brief Constructor.
+		 * @param source A constant pointer to the container (must outlive the view).
+		 * @param projection The callable.
+		 */
+		ProjectedView(const Source* source, Projection projection) : source(source), projection(projection) {}
+
+		/**
+		 * @brief Gets the number of elements.
+		 * @return size_t The count.
+		 */
+		size_t size() const { return source->size(); }
+
+		/**
+		 * @brief Computes the value of an element.
+		 * @param i The index.
+		 * @return double The projected value.
+		 */
+		double operator[](size_t i) const { return static_cast<double>(projection((*source)[i])); }
+
+	private:
+		const Source* source;  ///< The container.
+		Projection projection; ///< The callable.
+	};
+
+	/**
+	 * @class ConcatView
+	 * @brief View of the elements of one view followed by those of another.
+	 * @tparam Head The first view.
+	 * @tparam Tail The second view.
+	 */
+	template <class Head, class Tail>
+	class ConcatView {
+	public:
+		/**
+		 * @brief Constructor.
+		 * @param head A constant pointer to the first view (must outlive this one).
+		 * @param tail A constant pointer to the second view (must outlive this one).
+		 */
+		ConcatView(const Head* head, const Tail* tail) : head(head), tail(tail), split(head->size()) {}
+
+		/**
+		 * @brief Gets the number of elements.
+		 * @return size_t The sum of the two sizes.
+		 */
+		size_t size() const { return split + tail->size(); }
+
+		/**
+		 * @brief Reads an element from whichever view holds it.
+		 * @param i The index.
+		 * @return double The value.
+		 */
+		double operator[](size_t i) const {
+			return i < split ? static_cast<double>((*head)[i]) : static_cast<double>((*tail)[i - split]);
+		}
+
+	private:
+		const Head* head; ///< The first view.
+		const Tail* tail; ///< The second view.
+		size_t split;     ///< Size of the first view.
+	};
+
+	/**
+	 * @brief Makes a ConcatView, deducing its types.
+	 * @param head A constant pointer to the first view.
+	 * @param tail A constant pointer to the second view.
+	 * @return ConcatView<Head, Tail> The view.
+	 */
+	template <class Head, class Tail>
+	ConcatView<Head, Tail> concat(const Head* head, const Tail* tail) {
+		return ConcatView<Head, Tail>(head, tail);
+	}
+
+	/**
+	 * @brief Makes a ProjectedView, deducing its types.
+	 * @param source A constant pointer to the container.
+	 * @param projection The callable applied to each element.
+	 * @return ProjectedView<Source, Projection> The view.
+	 */
+	template <class Source, class Projection>
+	ProjectedView<Source, Projection> project(const Source* source, Projection projection) {
+		return ProjectedView<Source, Projection>(source, projection);
+	}
+
+	/**
+	 * @brief Reduces [0, n) chunk by chunk into an array of partial results, in parallel for large n.
+	 *
+	 * Chunk boundaries depend only on n and the partials are combined in order by the
+	 * caller, so results do not depend on the thread count.
+	 * @param n The number of values.
+	 * @param partials A pointer to the vector receiving one partial per chunk.
+	 * @param reduceChunk Called as reduceChunk(begin, end), returns the partial for that range.
+	 */
+	template <class Partial, class ReduceChunk>
+	void reduceChunks(size_t n, std::vector<Partial>* partials, ReduceChunk reduceChunk) {
+		size_t chunks = (n + kChunk - 1) / kChunk;
+		partials->assign(chunks, Partial());
+
+		auto body = [&](size_t first, size_t last) {
+			for (size_t c = first; c < last; ++c) {
+				(*partials)[c] = reduceChunk(c * kChunk, std::min(n, (c + 1) * kChunk));
+			}
+		};
+
+		if (n >= kParallelThreshold) {
+			TaskPool::instance().parallelFor(chunks, 1, body, "statistics.reduce");
+		} else {
+			body(0, chunks);
+		}
+	}
+
+	/**
+	 * @brief Sums term(i) over [0, n) using chunked (and for large n, parallel) reduction.
+	 * @param n The number of values.
+	 * @param term Called with each index, returns the value to add.
+	 * @return double The sum.
+	 */
+	template <class Term>
+	double sumTerms(size_t n, Term term) {
+		std::vector<double> partials;
+		reduceChunks(n, &partials, [&term](size_t begin, size_t end) {
+			double sum = 0.0;
+			for (size_t i = begin; i < end; ++i) sum += term(i);
+			return sum;
+		});
+
+		double total = 0.0;
+		for (double p : partials) total += p;
+		return total;
+	}
+
+	/**
+	 * @struct PairSums
+	 * @brief Partial sums needed for the Pearson correlation.
+	 */
+	struct PairSums {
+		double x = 0.0, y = 0.0, xy = 0.0, x2 = 0.0, y2 = 0.0;
+	};
+
 	/**
 	 * @brief Calculates the arithmetic mean (average) of a set of values.
 	 * @param values A constant pointer to the vector of double values.
@@ -18,6 +259,19 @@ namespace Statistics {
 	 */
 	double calculateMean(const std::vector<double>* values);
 
+	/**
+	 * @brief Calculates the arithmetic mean of the values of a view.
+	 * @param values A constant pointer to the view.
+	 * @return double The calculated mean. Returns 0.0 if the view is empty.
+	 */
+	template <class View>
+	double calculateMean(const View* values) {
+		size_t n = values->size();
+		if (n == 0) return 0.0;
+		const View& v = *values;
+		return sumTerms(n, [&v](size_t i) { return static_cast<double>(v[i]); }) / n;
+	}
+
 	/**
 	 * @brief Calculates the sample standard deviation of a set of values.
 	 * @param values A constant pointer to the vector of double values.
@@ -25,6 +279,24 @@ namespace Statistics {
 	 */
 	double calculateStdDev(const std::vector<double>* values);
 
+	/**
+	 * @brief Calculates the sample standard deviation of the values of a view.
+	 * @param values A constant pointer to the view.
+	 * @return double The calculated standard deviation. Returns 0.0 if size < 2.
+	 */
+	template <class View>
+	double calculateStdDev(const View* values) {
+		size_t n = values->size();
+		if (n < 2) return 0.0;
+		double mean = calculateMean(values);
+		const View& v = *values;
+		double sumSq = sumTerms(n, [&v, mean](size_t i) {
+			double d = static_cast<double>(v[i]) - mean;
+			return d * d;
+		});
+		return std::sqrt(sumSq / (n - 1));
+	}
+
 	/**
 	 * @brief Calculates the Median Absolute Deviation (MAD) of a set of values.
 	 *
@@ -34,6 +306,20 @@ namespace Statistics {
 	 */
 	double calculateMAD(const std::vector<double>* values);
 
+	/**
+	 * @brief Calculates the mean absolute deviation of the values of a view (as calculateMAD on a vector).
+	 * @param values A constant pointer to the view.
+	 * @return double The calculated deviation. Returns 0.0 if the view is empty.
+	 */
+	template <class View>
+	double calculateMAD(const View* values) {
+		size_t n = values->size();
+		if (n == 0) return 0.0;
+		double mean = calculateMean(values);
+		const View& v = *values;
+		return sumTerms(n, [&v, mean](size_t i) { return std::abs(static_cast<double>(v[i]) - mean); }) / n;
+	}
+
 	/**
 	 * @brief Calculates the Sample Pearson Correlation Coefficient (SPCC) between two data sets.
 	 * @param x A constant pointer to the vector of double values for the X variable.
@@ -41,6 +327,61 @@ namespace Statistics {
 	 * @return double The calculated SPCC. Returns 0.0 if the vectors are not the same size or size < 2.
 	 */
 	double calculateSPCC(const std::vector<double>* x, const std::vector<double>* y);
+
+	/**
+	 * @brief Calculates the SPCC between the values of two views, which may be of different types.
+	 * @param x A constant pointer to the view of the X variable.
+	 * @param y A constant pointer to the view of the Y variable.
+	 * @return double The calculated SPCC. Returns 0.0 if the views are not the same size or size < 2.
+	 */
+	template <class ViewX, class ViewY>
+	double calculateSPCC(const ViewX* x, const ViewY* y) {
+		if (x->size() != y->size() || x->size() < 2) return 0.0;
+
+		double n = static_cast<double>(x->size());
+		const ViewX& xs = *x;
+		const ViewY& ys = *y;
+
+		std::vector<PairSums> partials;
+		reduceChunks(x->size(), &partials, [&xs, &ys](size_t begin, size_t end) {
+			PairSums p;
+			for (size_t i = begin; i < end; ++i) {
+				double xi = static_cast<double>(xs[i]);
+				double yi = static_cast<double>(ys[i]);
+				p.x += xi;
+				p.y += yi;
+				p.xy += xi * yi;
+				p.x2 += xi * xi;
+				p.y2 += yi * yi;
+			}
+			return p;
+		});
+
+		double sum_x = 0.0, sum_y = 0.0;
+		double sum_xy = 0.0, sum_x2 = 0.0, sum_y2 = 0.0;
+		for (const PairSums& p : partials) {
+			sum_x += p.x;
+			sum_y += p.y;
+			sum_xy += p.xy;
+			sum_x2 += p.x2;
+			sum_y2 += p.y2;
+		}
+
+		double numerator = n * sum_xy - sum_x * sum_y;
+		double denominator = std::sqrt((n * sum_x2 - sum_x * sum_x) * (n * sum_y2 - sum_y * sum_y));
+
+		if (std::abs(denominator) < 1e-10) return 0.0;
+		return numerator / denominator;
+	}
+
+	/**
+	 * @brief Calculates the two-sided critical value of the standard normal distribution for a confidence level.
+	 *
+	 * Uses the rational approximation of Abramowitz and Stegun (26.2.23), accurate to about 5e-4.
+	 * @param confidence The confidence level, between 0 and 1 (e.g. 0.95 gives 1.96).
+	 * @return double The z value such that P(|Z| <= z) = confidence (0 for levels outside (0, 1)).
+	 */
+	double normalCriticalValue(double confidence);
 }
 
 #endif // STATISTICS_H
@@ -0,0 +1,176 @@
+// StreamingAggregator.cpp
+
+// Implements the two-pass, constant-memory monthly aggregation over the raw CSV
+// files used for archives too large to load into a WeatherDataCollection.
+
+#include "StreamingAggregator.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+	/**
+	 * @brief Default constructor for StreamingAggregator.
+	 *
+	 * @return void
+	 */
+StreamingAggregator::StreamingAggregator() : recordCount(0) {}
+
+	/**
+	 * @brief Reads each file line by line and applies a visitor to every parsed record.
+	 *
+	 * Only one line and one record are held at a time. A record with the same timestamp
+	 * as the previous record (in this or the previous file) is skipped.
+	 *
+	 * @param  files - Pointer to the CSV file names (relative to data/).
+	 * @param  visit - Function applied to each record.
+	 * @param  context - Opaque pointer passed to visit.
+	 * @return void
+	 */
+void StreamingAggregator::scanFiles(const std::vector<std::string>* files, RecordVisitor visit, void* context) {
+	bool havePrevious = false;
+	int previousKey = 0;
+
+	for (const std::string& name : *files) {
+		std::string fullPath = "data/" + name;
+		std::ifstream csvFile(fullPath);
+
+		if (!csvFile.is_open()) {
+			std::cerr << "Failed to open CSV file: " << fullPath << std::endl;
+			continue;
+		}
+
+		std::string line;
+		// The header names the columns; files differ in their order
+		std::getline(csvFile, line);
+		CsvLayout layout = CsvLayout::fromHeader(&line);
+
+		while (std::getline(csvFile, line)) {
+			WeatherRecord* record = WeatherDataCollection::parseRecord(&line, &layout);
+			if (record == nullptr) continue;
+
+			int key = record->date->toMinuteKey();
+			if (!havePrevious || key != previousKey) {
+				visit(record, context);
+			}
+			havePrevious = true;
+			previousKey = key;
+			delete record;
+		}
+	}
+}
+
+	/**
+	 * @brief Pass 1: adds a record to its bucket's count and sums.
+	 *
+	 * @param  record - Pointer to the record.
+	 * @param  context - Pointer to the StreamingAggregator.
+	 * @return void
+	 */
+void StreamingAggregator::accumulateSums(const WeatherRecord* record, void* context) {
+	StreamingAggregator* self = static_cast<StreamingAggregator*>(context);
+	int key = bucketKey(record->date->GetYear(), record->date->GetMonth());
+
+	Accumulator* acc = self->buckets.at(&key);
+	acc->count += 1;
+	acc->windSum += record->windSpeed;
+	acc->tempSum += record->temperature;
+	acc->solarSum += record->solarRadiation;
+	self->recordCount += 1;
+}
+
+	/**
+	 * @brief Pass 2: adds a record's squared and absolute deviations from its bucket's means.
+	 *
+	 * @param  record - Pointer to the record.
+	 * @param  context - Pointer to the StreamingAggregator.
+	 * @return void
+	 */
+void StreamingAggregator::accumulateDeviations(const WeatherRecord* record, void* context) {
+	StreamingAggregator* self = static_cast<StreamingAggregator*>(context);
+	int key = bucketKey(record->date->GetYear(), record->date->GetMonth());
+
+	Accumulator* acc = self->buckets.at(&key);
+	double windMean = acc->windSum / acc->count;
+	double tempMean = acc->tempSum / acc->count;
+	double windDev = record->windSpeed - windMean;
+	double tempDev = record->temperature - tempMean;
+
+	acc->windSqDev += windDev * windDev;
+	acc->windAbsDev += std::abs(windDev);
+	acc->tempSqDev += tempDev * tempDev;
+	acc->tempAbsDev += std::abs(tempDev);
+}
+
+	/**
+	 * @brief Aggregates the listed files in two sequential passes.
+	 *
+	 * @param  listFilename - Pointer to the name of the file listing the CSVs.
+	 * @return bool - False if the list file could not be opened.
+	 */
+bool StreamingAggregator::aggregateFiles(std::string* listFilename) {
+	std::ifstream listFile(*listFilename);
+	if (!listFile.is_open()) {
+		return false;
+	}
+
+	std::vector<std::string> files;
+	std::string csvFileName;
+	while (std::getline(listFile, csvFileName)) {
+		csvFileName.erase(std::remove(csvFileName.begin(), csvFileName.end(), '\r'), csvFileName.end());
+		if (!csvFileName.empty()) files.push_back(csvFileName);
+	}
+	listFile.close();
+
+	buckets = Map<int, Accumulator>();
+	recordCount = 0;
+
+	scanFiles(&files, accumulateSums, this);
+	scanFiles(&files, accumulateDeviations, this);
+	return true;
+}
+
+	/**
+	 * @brief Fills the twelve report rows of a year from the bucket accumulators.
+	 *
+	 * @param  year - Pointer to the year.
+	 * @param  rows - Array of 12 rows to fill.
+	 * @return void
+	 */
+void StreamingAggregator::getMonthlyStats(int* year, MonthlyStatsRow* rows) const {
+	for (int m = 1; m <= 12; ++m) {
+		MonthlyStatsRow& row = rows[m-1];
+		row = MonthlyStatsRow();
+
+		int key = bucketKey(*year, m);
+		if (!buckets.contains(&key)) continue;
+
+		const Accumulator* acc = buckets.at(&key);
+		double n = static_cast<double>(acc->count);
+		row.hasData = true;
+		row.meanWind = acc->windSum / n;
+		row.stdWind = acc->count < 2 ? 0.0 : std::sqrt(acc->windSqDev / (n - 1));
+		row.madWind = acc->windAbsDev / n;
+		row.meanTemp = acc->tempSum / n;
+		row.stdTemp = acc->count < 2 ? 0.0 : std::sqrt(acc->tempSqDev / (n - 1));
+		row.madTemp = acc->tempAbsDev / n;
+		row.totalSolar = acc->solarSum;
+	}
+}
+
+	/**
+	 * @brief Writes the monthly statistics report of a year.
+	 *
+	 * @param  year - Pointer to the year.
+	 * @param  filename - Pointer to the output filename.
+	 * @return bool - False if the file could not be opened.
+	 */
+bool StreamingAggregator::writeMonthlyStats(int* year, std::string* filename) const {
+	std::ofstream out(*filename);
+	if (!out.is_open()) return false;
+
+	MonthlyStatsRow rows[12];
+	getMonthlyStats(year, rows);
+	WeatherDataCollection::writeMonthlyStats(&out, year, rows);
+	return true;
+}
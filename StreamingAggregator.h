@@ -0,0 +1,121 @@
+#ifndef STREAMINGAGGREGATOR_H
+#define STREAMINGAGGREGATOR_H
+
+#include "Map.h"
+#include "WeatherDataCollection.h"
+#include "WeatherRecord.h"
+#include <string>
+#include <vector>
+
+/**
+ * @class StreamingAggregator
+ * @brief Out-of-core monthly aggregation that never keeps records in memory.
+ *
+ * The data files are read sequentially, one line at a time, and each record only
+ * updates the accumulator of its (year, month) bucket before it is discarded; no
+ * Bst or month map is built. Memory use therefore depends on the number of months
+ * covered, not on the number of records, so archives larger than RAM can be reported on.
+ *
+ * Two passes are made over the files: the first accumulates counts and sums (giving
+ * the means), the second accumulates squared and absolute deviations from those
+ * means, so standard deviation and mean absolute deviation are computed exactly as
+ * the in-memory report does rather than from numerically fragile running sums.
+ *
+ * A record whose timestamp equals that of the record read just before it (e.g. the
+ * reading repeated at the end of one yearly file and the start of the next) is
+ * skipped, matching the Bst, which stores each timestamp once.
+ */
+class StreamingAggregator {
+public:
+	/**
+	 * @brief Default constructor. Starts with no data.
+	 */
+	StreamingAggregator();
+
+	/**
+	 * @brief Aggregates every file named in a list file (CSV names relative to data/).
+	 *
+	 * Replaces any previously aggregated data.
+	 * @param listFilename A pointer to the name of the list file.
+	 * @return bool False if the list file could not be opened.
+	 */
+	bool aggregateFiles(std::string* listFilename);
+
+	/**
+	 * @brief Computes the twelve rows of the monthly statistics report for a year.
+	 * @param year A pointer to the year.
+	 * @param rows An array of 12 rows to fill, January first.
+	 */
+	void getMonthlyStats(int* year, MonthlyStatsRow* rows) const;
+
+	/**
+	 * @brief Writes the monthly statistics report for a year, in the same format as
+	 * WeatherDataCollection::generateMonthlyStats.
+	 * @param year A pointer to the year.
+	 * @param filename A pointer to the output filename.
+	 * @return bool False if the file could not be written.
+	 */
+	bool writeMonthlyStats(int* year, std::string* filename) const;
+
+	/**
+	 * @brief Gets the number of records aggregated (duplicates excluded).
+	 * @return unsigned long The record count.
+	 */
+	unsigned long getRecordCount() const { return recordCount; }
+
+private:
+	/**
+	 * @struct Accumulator
+	 * @brief Running totals of one (year, month) bucket.
+	 */
+	struct Accumulator {
+		unsigned long count;   ///< Records in the bucket.
+		double windSum;        ///< Sum of wind speeds (pass 1).
+		double tempSum;        ///< Sum of temperatures (pass 1).
+		double solarSum;       ///< Sum of solar radiation (pass 1).
+		double windSqDev;      ///< Sum of squared wind deviations from the mean (pass 2).
+		double windAbsDev;     ///< Sum of absolute wind deviations from the mean (pass 2).
+		double tempSqDev;      ///< Sum of squared temperature deviations from the mean (pass 2).
+		double tempAbsDev;     ///< Sum of absolute temperature deviations from the mean (pass 2).
+	};
+
+	/**
+	 * @brief Function applied to each record of a scan.
+	 */
+	typedef void (*RecordVisitor)(const WeatherRecord* record, void* context);
+
+	/**
+	 * @brief Reads the files in order and applies visit to each record, skipping repeated timestamps.
+	 * @param files The CSV file names (relative to data/).
+	 * @param visit The function applied to each record.
+	 * @param context Opaque pointer passed to visit.
+	 */
+	static void scanFiles(const std::vector<std::string>* files, RecordVisitor visit, void* context);
+
+	/**
+	 * @brief Pass 1 visitor: adds a record to the count and sums of its bucket.
+	 * @param record The record.
+	 * @param context Pointer to the StreamingAggregator.
+	 */
+	static void accumulateSums(const WeatherRecord* record, void* context);
+
+	/**
+	 * @brief Pass 2 visitor: adds a record's deviations from its bucket means.
+	 * @param record The record.
+	 * @param context Pointer to the StreamingAggregator.
+	 */
+	static void accumulateDeviations(const WeatherRecord* record, void* context);
+
+	/**
+	 * @brief Computes the bucket key of a year and month.
+	 * @param year The year.
+	 * @param month The month (1-12).
+	 * @return int The key (year * 12 + month - 1).
+	 */
+	static int bucketKey(int year, int month) { return year * 12 + month - 1; }
+
+	Map<int, Accumulator> buckets;  ///< Accumulators by bucketKey.
+	unsigned long recordCount;      ///< Records aggregated.
+};
+
+#endif // STREAMINGAGGREGATOR_H
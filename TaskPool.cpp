@@ -0,0 +1,378 @@
+// TaskPool.cpp
+
+// Implements the work-stealing TaskPool shared by the loader, the reports and the
+// statistics reductions, plus TaskGroup for fork/join style waiting.
+
+#include "TaskPool.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+	thread_local const TaskPool* tlsOwner = nullptr;  // Pool the current thread works for, if any
+	thread_local int tlsWorker = -1;                  // Index of the current thread within tlsOwner
+
+	std::atomic<int> configuredThreads(0);
+	std::atomic<bool> instanceCreated(false);
+
+	/**
+	 * @brief Adds one run time to a timing table.
+	 *
+	 * @param  stats - The table to update.
+	 * @param  name - The task name.
+	 * @param  ms - The run time in milliseconds.
+	 * @return void
+	 */
+	template <class Table>
+	void addTiming(Table& stats, const char* name, double ms) {
+		auto& entry = stats[name];
+		entry.count += 1;
+		entry.totalMs += ms;
+		if (ms > entry.maxMs) entry.maxMs = ms;
+	}
+}
+
+	/**
+	 * @brief Constructor for TaskPool. Starts the worker threads.
+	 *
+	 * @param  threads - Number of workers, or 0 for one less than the hardware thread count.
+	 * @return void
+	 */
+TaskPool::TaskPool(int threads) : queued(0), stopping(false) {
+	if (threads <= 0) {
+		// The thread waiting on a group also runs tasks, so leave it a hardware thread
+		threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+	}
+	for (int i = 0; i < threads; ++i) {
+		workers.push_back(new Worker());
+	}
+	for (int i = 0; i < threads; ++i) {
+		workers[i]->thread = std::thread(&TaskPool::workerLoop, this, i);
+	}
+}
+
+	/**
+	 * @brief Destructor for TaskPool. Lets workers drain the queues, then joins them.
+	 *
+	 * @return void
+	 */
+TaskPool::~TaskPool() {
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopping.store(true);
+	}
+	sleepCv.notify_all();
+	for (Worker* worker : workers) {
+		worker->thread.join();
+		delete worker;
+	}
+}
+
+	/**
+	 * @brief Returns the process-wide pool, creating it on first use with the configured size.
+	 *
+	 * @return TaskPool& - The shared pool.
+	 */
+TaskPool& TaskPool::instance() {
+	static TaskPool pool((instanceCreated.store(true), configuredThreads.load()));
+	return pool;
+}
+
+	/**
+	 * @brief Sets the worker count used when the shared pool is created.
+	 *
+	 * @param  threads - Number of workers, or 0 for the hardware default.
+	 * @return bool - True if applied, false if the shared pool already exists.
+	 */
+bool TaskPool::configure(int threads) {
+	if (instanceCreated.load()) return false;
+	configuredThreads.store(threads);
+	return true;
+}
+
+	/**
+	 * @brief Returns the index of the calling thread within this pool.
+	 *
+	 * @return int - Worker index, or -1 for threads that are not workers of this pool.
+	 */
+int TaskPool::currentWorker() const {
+	return tlsOwner == this ? tlsWorker : -1;
+}
+
+	/**
+	 * @brief Queues a task on the caller's own deque (workers) or the injection queue (outside threads).
+	 *
+	 * @param  item - The task to queue.
+	 * @return void
+	 */
+void TaskPool::enqueue(TaskItem item) {
+	int self = currentWorker();
+	if (self >= 0) {
+		std::lock_guard<std::mutex> lock(workers[self]->queueMutex);
+		workers[self]->tasks.push_back(std::move(item));
+	} else {
+		std::lock_guard<std::mutex> lock(injectionMutex);
+		injection.push_back(std::move(item));
+	}
+	queued.fetch_add(1);
+
+	// Taking the sleep mutex orders the increment before any idle worker's re-check
+	{ std::lock_guard<std::mutex> lock(sleepMutex); }
+	sleepCv.notify_one();
+}
+
+	/**
+	 * @brief Finds the next task for a thread: own deque (back), injection queue, then steal (front).
+	 *
+	 * @param  self - Index of the calling worker, or -1.
+	 * @param  item - Receives the task.
+	 * @return bool - True if a task was taken.
+	 */
+bool TaskPool::findTask(int self, TaskItem& item) {
+	if (queued.load() <= 0) return false;
+
+	if (self >= 0) {
+		std::lock_guard<std::mutex> lock(workers[self]->queueMutex);
+		if (!workers[self]->tasks.empty()) {
+			item = std::move(workers[self]->tasks.back());
+			workers[self]->tasks.pop_back();
+			queued.fetch_sub(1);
+			return true;
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(injectionMutex);
+		if (!injection.empty()) {
+			item = std::move(injection.front());
+			injection.pop_front();
+			queued.fetch_sub(1);
+			return true;
+		}
+	}
+
+	size_t count = workers.size();
+	size_t start = self >= 0 ? static_cast<size_t>(self) + 1 : 0;
+	for (size_t i = 0; i < count; ++i) {
+		Worker* victim = workers[(start + i) % count];
+		std::lock_guard<std::mutex> lock(victim->queueMutex);
+		if (!victim->tasks.empty()) {
+			item = std::move(victim->tasks.front());
+			victim->tasks.pop_front();
+			queued.fetch_sub(1);
+			return true;
+		}
+	}
+	return false;
+}
+
+	/**
+	 * @brief Runs a task, records its run time and marks it finished in its group.
+	 *
+	 * @param  self - Index of the calling worker, or -1.
+	 * @param  item - The task to run.
+	 * @return void
+	 */
+void TaskPool::execute(int self, TaskItem& item) {
+	auto start = std::chrono::steady_clock::now();
+	try {
+		item.fn();
+	} catch (...) {
+		std::lock_guard<std::mutex> lock(item.group->errorMutex);
+		if (!item.group->error) item.group->error = std::current_exception();
+	}
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	if (self >= 0) {
+		std::lock_guard<std::mutex> lock(workers[self]->statsMutex);
+		addTiming(workers[self]->stats, item.name, ms);
+	} else {
+		std::lock_guard<std::mutex> lock(externalStatsMutex);
+		addTiming(externalStats, item.name, ms);
+	}
+
+	// Release the closure before the group can observe completion
+	item.fn = nullptr;
+	item.group->finishTask();
+}
+
+	/**
+	 * @brief Runs one pending task on the calling thread.
+	 *
+	 * @return bool - True if a task was found and run.
+	 */
+bool TaskPool::runPendingTask() {
+	int self = currentWorker();
+	TaskItem item;
+	if (!findTask(self, item)) return false;
+	execute(self, item);
+	return true;
+}
+
+	/**
+	 * @brief Worker main loop: run tasks while any can be found, otherwise sleep until woken.
+	 *
+	 * @param  self - Index of this worker.
+	 * @return void
+	 */
+void TaskPool::workerLoop(int self) {
+	tlsOwner = this;
+	tlsWorker = self;
+
+	for (;;) {
+		TaskItem item;
+		if (findTask(self, item)) {
+			execute(self, item);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		if (stopping.load() && queued.load() <= 0) break;
+		sleepCv.wait(lock, [this] { return stopping.load() || queued.load() > 0; });
+	}
+}
+
+	/**
+	 * @brief Runs body over [0, count) in ranges of grain items and waits for completion.
+	 *
+	 * @param  count - Number of items.
+	 * @param  grain - Maximum items per task.
+	 * @param  body - Range function called as body(begin, end).
+	 * @param  name - Task name used for timing.
+	 * @return void
+	 */
+void TaskPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body, const char* name) {
+	if (count == 0) return;
+	if (grain == 0) grain = 1;
+
+	if (count <= grain) {
+		body(0, count);
+		return;
+	}
+
+	TaskGroup group(this);
+	for (size_t begin = 0; begin < count; begin += grain) {
+		size_t end = std::min(count, begin + grain);
+		group.run([&body, begin, end] { body(begin, end); }, name);
+	}
+	group.wait();
+}
+
+	/**
+	 * @brief Merges the per-thread timing tables into one entry per task name.
+	 *
+	 * @return std::vector<TaskTiming> - Timings sorted by task name.
+	 */
+std::vector<TaskTiming> TaskPool::getTimings() const {
+	std::map<std::string, TaskTiming> merged;
+
+	auto mergeTable = [&merged](const std::map<const char*, Stats>& table) {
+		for (const auto& entry : table) {
+			TaskTiming& t = merged[entry.first];
+			t.name = entry.first;
+			t.count += entry.second.count;
+			t.totalMs += entry.second.totalMs;
+			if (entry.second.maxMs > t.maxMs) t.maxMs = entry.second.maxMs;
+		}
+	};
+
+	for (Worker* worker : workers) {
+		std::lock_guard<std::mutex> lock(worker->statsMutex);
+		mergeTable(worker->stats);
+	}
+	{
+		std::lock_guard<std::mutex> lock(externalStatsMutex);
+		mergeTable(externalStats);
+	}
+
+	std::vector<TaskTiming> result;
+	for (const auto& entry : merged) {
+		result.push_back(entry.second);
+	}
+	return result;
+}
+
+	/**
+	 * @brief Clears all accumulated task timings.
+	 *
+	 * @return void
+	 */
+void TaskPool::resetTimings() {
+	for (Worker* worker : workers) {
+		std::lock_guard<std::mutex> lock(worker->statsMutex);
+		worker->stats.clear();
+	}
+	std::lock_guard<std::mutex> lock(externalStatsMutex);
+	externalStats.clear();
+}
+
+	/**
+	 * @brief Constructor for TaskGroup.
+	 *
+	 * @param  pool - The pool the group's tasks run on.
+	 * @return void
+	 */
+TaskGroup::TaskGroup(TaskPool* pool) : pool(pool), pending(0) {}
+
+	/**
+	 * @brief Destructor for TaskGroup. Waits for outstanding tasks, discarding any exception.
+	 *
+	 * @return void
+	 */
+TaskGroup::~TaskGroup() {
+	try {
+		wait();
+	} catch (...) {
+	}
+}
+
+	/**
+	 * @brief Submits a task as part of this group.
+	 *
+	 * @param  task - The work to run.
+	 * @param  name - Task name used for timing.
+	 * @return void
+	 */
+void TaskGroup::run(TaskPool::Task task, const char* name) {
+	pending.fetch_add(1);
+	pool->enqueue(TaskPool::TaskItem{std::move(task), name, this});
+}
+
+	/**
+	 * @brief Decrements pending under doneMutex and wakes the waiters when it reaches 0.
+	 *
+	 * Holding the mutex until the notification is made keeps the group alive for it: a
+	 * waiter takes the same mutex before it returns.
+	 *
+	 * @return void
+	 */
+void TaskGroup::finishTask() {
+	std::lock_guard<std::mutex> lock(doneMutex);
+	if (pending.fetch_sub(1) == 1) done.notify_all();
+}
+
+	/**
+	 * @brief Waits until every task in the group has finished, helping with pool work meanwhile.
+	 *
+	 * Runs pool tasks while any can be found; once none can, the remaining tasks of the
+	 * group are running on other threads and the caller sleeps until the last one signals.
+	 * Rethrows the first exception raised by a task of the group.
+	 *
+	 * @return void
+	 */
+void TaskGroup::wait() {
+	while (pending.load() > 0) {
+		if (pool->runPendingTask()) continue;
+
+		std::unique_lock<std::mutex> lock(doneMutex);
+		done.wait(lock, [this] { return pending.load() == 0; });
+	}
+	// The task that finished last may still hold doneMutex while it signals
+	{ std::lock_guard<std::mutex> lock(doneMutex); }
+
+	std::exception_ptr failure;
+	{
+		std::lock_guard<std::mutex> lock(errorMutex);
+		std::swap(failure, error);
+	}
+	if (failure) std::rethrow_exception(failure);
+}
@@ -0,0 +1,242 @@
+#ifndef TASKPOOL_H
+#define TASKPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TaskGroup;
+
+/**
+ * @struct TaskTiming
+ * @brief Accumulated execution time of all tasks submitted under one name.
+ */
+struct TaskTiming {
+	std::string name;        ///< Task name given at submission.
+	unsigned long count;     ///< Number of completed tasks.
+	double totalMs;          ///< Sum of task run times in milliseconds.
+	double maxMs;            ///< Longest single task in milliseconds.
+};
+
+/**
+ * @class TaskPool
+ * @brief Work-stealing thread pool shared by the loader, the report engines and the statistics reductions.
+ *
+ * Each worker owns a deque: it pushes and pops its own tasks at the back (LIFO, cache
+ * friendly) while idle workers steal from the front of other deques. Tasks submitted
+ * from outside the pool go to a shared injection queue. A thread waiting on a
+ * TaskGroup runs pending tasks instead of blocking, so nested parallelism (a report
+ * task that runs a parallel reduction) cannot deadlock or oversubscribe the machine;
+ * once no task is left to take it sleeps until the group's last task finishes.
+ *
+ * Every task carries a name; run times are accumulated per name and can be read back
+ * with getTimings().
+ */
+class TaskPool {
+public:
+	/**
+	 * @brief Type of a unit of work.
+	 */
+	typedef std::function<void()> Task;
+
+	/**
+	 * @brief Constructor. Starts the worker threads.
+	 * @param threads Number of workers (0 picks one less than the hardware thread count, minimum 1).
+	 */
+	explicit TaskPool(int threads = 0);
+
+	/**
+	 * @brief Destructor. Finishes queued tasks and joins the workers.
+	 */
+	~TaskPool();
+
+	/**
+	 * @brief Gets the process-wide pool, creating it on first use.
+	 * @return TaskPool& The shared pool.
+	 */
+	static TaskPool& instance();
+
+	/**
+	 * @brief Sets the worker count of the shared pool. Only effective before the first call to instance().
+	 * @param threads Number of workers (0 for the hardware default).
+	 * @return bool True if applied, false if the shared pool already exists.
+	 */
+	static bool configure(int threads);
+
+	/**
+	 * @brief Runs body over [0, count) split into ranges of at most grain items, and waits for all of them.
+	 *
+	 * The calling thread takes part in the work.
+	 * @param count Number of items.
+	 * @param grain Maximum items per task (at least 1).
+	 * @param body Called as body(begin, end) for each range.
+	 * @param name Task name used for timing.
+	 */
+	void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body, const char* name);
+
+	/**
+	 * @brief Runs one pending task on the calling thread, if any.
+	 *
+	 * Lets a thread that is waiting for pool work to finish help instead of idling.
+	 * @return bool True if a task was run.
+	 */
+	bool runPendingTask();
+
+	/**
+	 * @brief Gets the number of worker threads.
+	 * @return int The worker count.
+	 */
+	int getThreadCount() const { return static_cast<int>(workers.size()); }
+
+	/**
+	 * @brief Gets the accumulated timings of all completed tasks, grouped by name.
+	 * @return std::vector<TaskTiming> One entry per task name, sorted by name.
+	 */
+	std::vector<TaskTiming> getTimings() const;
+
+	/**
+	 * @brief Clears the accumulated task timings.
+	 */
+	void resetTimings();
+
+private:
+	friend class TaskGroup;
+
+	/**
+	 * @struct TaskItem
+	 * @brief A queued task with its name and owning group.
+	 */
+	struct TaskItem {
+		Task fn;              ///< The work.
+		const char* name;     ///< Timing key (must outlive the pool, e.g. a string literal).
+		TaskGroup* group;     ///< Group notified on completion.
+	};
+
+	/**
+	 * @struct Stats
+	 * @brief Raw timing totals for one task name.
+	 */
+	struct Stats {
+		unsigned long count;  ///< Completed tasks.
+		double totalMs;       ///< Summed run time.
+		double maxMs;         ///< Longest run time.
+	};
+
+	/**
+	 * @struct Worker
+	 * @brief Per-thread deque and timing totals.
+	 */
+	struct Worker {
+		std::mutex queueMutex;                 ///< Guards tasks (owner and thieves).
+		std::deque<TaskItem> tasks;            ///< Owner works at the back, thieves at the front.
+		std::mutex statsMutex;                 ///< Guards stats.
+		std::map<const char*, Stats> stats;    ///< Timings of tasks run by this thread.
+		std::thread thread;                    ///< The worker thread.
+	};
+
+	/**
+	 * @brief Queues a task: onto the calling worker's deque, or the injection queue for outside threads.
+	 * @param item The task to queue.
+	 */
+	void enqueue(TaskItem item);
+
+	/**
+	 * @brief Finds a task: own deque first, then the injection queue, then stealing.
+	 * @param self Index of the calling worker, or -1 for an outside thread.
+	 * @param item Receives the task.
+	 * @return bool True if a task was found.
+	 */
+	bool findTask(int self, TaskItem& item);
+
+	/**
+	 * @brief Runs a task, records its timing and signals its group.
+	 * @param self Index of the calling worker, or -1 for an outside thread.
+	 * @param item The task to run.
+	 */
+	void execute(int self, TaskItem& item);
+
+	/**
+	 * @brief Main loop of a worker thread.
+	 * @param self Index of this worker.
+	 */
+	void workerLoop(int self);
+
+	/**
+	 * @brief Gets the index of the calling thread within this pool.
+	 * @return int The worker index, or -1 if the caller is not one of this pool's workers.
+	 */
+	int currentWorker() const;
+
+	std::vector<Worker*> workers;                ///< Worker states.
+	std::mutex injectionMutex;                   ///< Guards injection.
+	std::deque<TaskItem> injection;              ///< Tasks submitted from outside the pool.
+	mutable std::mutex externalStatsMutex;       ///< Guards externalStats.
+	std::map<const char*, Stats> externalStats;  ///< Timings of tasks run by helping outside threads.
+	std::atomic<long> queued;                    ///< Number of queued, not yet started tasks.
+	std::atomic<bool> stopping;                  ///< Set when the pool shuts down.
+	std::mutex sleepMutex;                       ///< Guards idle waits.
+	std::condition_variable sleepCv;             ///< Wakes idle workers.
+
+	TaskPool(const TaskPool&) = delete;
+	TaskPool& operator=(const TaskPool&) = delete;
+};
+
+/**
+ * @class TaskGroup
+ * @brief A set of tasks submitted to a TaskPool that can be waited on together.
+ *
+ * The first exception thrown by a task in the group is rethrown by wait().
+ */
+class TaskGroup {
+public:
+	/**
+	 * @brief Constructor.
+	 * @param pool The pool to run tasks on (the shared pool by default).
+	 */
+	explicit TaskGroup(TaskPool* pool = &TaskPool::instance());
+
+	/**
+	 * @brief Destructor. Waits for outstanding tasks (exceptions are discarded).
+	 */
+	~TaskGroup();
+
+	/**
+	 * @brief Submits a task to the pool as part of this group.
+	 * @param task The work to run.
+	 * @param name Task name used for timing (must outlive the pool, e.g. a string literal).
+	 */
+	void run(TaskPool::Task task, const char* name);
+
+	/**
+	 * @brief Waits for every task in the group, running pending pool tasks meanwhile and sleeping when there are none.
+	 */
+	void wait();
+
+private:
+	friend class TaskPool;
+
+	/**
+	 * @brief Marks one task finished, waking the waiters when it was the last.
+	 */
+	void finishTask();
+
+	TaskPool* pool;                ///< Pool the tasks run on.
+	std::atomic<long> pending;     ///< Tasks submitted but not yet finished (decremented under doneMutex).
+	std::mutex doneMutex;          ///< Orders the last decrement of pending before a waiter's wake-up.
+	std::condition_variable done;  ///< Signalled when pending reaches 0.
+	std::mutex errorMutex;         ///< Guards error.
+	std::exception_ptr error;      ///< First exception thrown by a task.
+
+	TaskGroup(const TaskGroup&) = delete;
+	TaskGroup& operator=(const TaskGroup&) = delete;
+};
+
+#endif // TASKPOOL_H
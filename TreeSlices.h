@@ -0,0 +1,101 @@
+#ifndef TREESLICES_H
+#define TREESLICES_H
+
+#include "TaskPool.h"
+#include <cstddef>
+#include <vector>
+
+/**
+ * @namespace TreeSlices
+ * @brief In-order traversal of size-augmented binary trees by rank ranges, in parallel.
+ *
+ * Works on any node type with data, left, right and subtreeSize members (Node and
+ * PersistentNode). Because every node knows the size of its subtree, the in-order
+ * sequence can be cut into slices of equal length whatever the tree's shape: a slice
+ * starts with one O(height) descent to its first rank and then walks on with an explicit
+ * stack. A degenerate (list-shaped) tree, as time-ordered appends produce, splits as
+ * evenly as a balanced one.
+ */
+namespace TreeSlices {
+	/**
+	 * @brief Gets the number of nodes in a subtree.
+	 * @param node The root of the subtree (may be nullptr).
+	 * @return size_t The node count.
+	 */
+	template <class NodeType>
+	size_t sizeOf(const NodeType* node) {
+		return node ? static_cast<size_t>(node->subtreeSize) : 0;
+	}
+
+	/**
+	 * @brief Visits the values of in-order ranks [first, last) of a tree, in order.
+	 * @param root The root of the tree.
+	 * @param first The rank of the first value to visit.
+	 * @param last One past the rank of the last value to visit.
+	 * @param visit The function applied to each value.
+	 * @param result Passed to visit.
+	 */
+	template <class NodeType, class T, class Result>
+	void visitRange(const NodeType* root, size_t first, size_t last, void (*visit)(const T*, Result*), Result* result) {
+		// Descend to rank first, keeping the ancestors whose left subtree we entered:
+		// they are exactly the values that follow, in order
+		std::vector<const NodeType*> pending;
+		const NodeType* node = root;
+		size_t skip = first;
+		while (node != nullptr) {
+			size_t leftSize = sizeOf(node->left);
+			if (skip < leftSize) {
+				pending.push_back(node);
+				node = node->left;
+			} else if (skip == leftSize) {
+				pending.push_back(node);
+				break;
+			} else {
+				skip -= leftSize + 1;
+				node = node->right;
+			}
+		}
+
+		for (size_t remaining = last - first; remaining > 0 && !pending.empty(); --remaining) {
+			const NodeType* current = pending.back();
+			pending.pop_back();
+			visit(current->data, result);
+			for (const NodeType* next = current->right; next != nullptr; next = next->left) {
+				pending.push_back(next);
+			}
+		}
+	}
+
+	/**
+	 * @brief Visits every value of a tree, slice by slice in parallel, each slice into its own result.
+	 *
+	 * Slice s covers the s-th of results->size() equal runs of the in-order sequence, so
+	 * reading the results front to back gives the values in key order. An empty results
+	 * vector is sized to one slice per thread (or one without a pool).
+	 * @param root The root of the tree.
+	 * @param visit The function applied to each value, with its slice's result.
+	 * @param results The per-slice results.
+	 * @param pool The pool, or nullptr to visit on the calling thread.
+	 */
+	template <class NodeType, class T, class Result>
+	void parallelInOrder(const NodeType* root, void (*visit)(const T*, Result*), std::vector<Result>* results, TaskPool* pool) {
+		if (results->empty()) results->resize(pool ? static_cast<size_t>(pool->getThreadCount()) + 1 : 1);
+
+		const size_t total = sizeOf(root);
+		const size_t slices = results->size();
+		if (pool == nullptr || slices == 1) {
+			for (size_t s = 0; s < slices; ++s) {
+				visitRange(root, s * total / slices, (s + 1) * total / slices, visit, &(*results)[s]);
+			}
+			return;
+		}
+
+		pool->parallelFor(slices, 1, [&](size_t begin, size_t end) {
+			for (size_t s = begin; s < end; ++s) {
+				visitRange(root, s * total / slices, (s + 1) * total / slices, visit, &(*results)[s]);
+			}
+		}, "tree.inorder");
+	}
+}
+
+#endif // TREESLICES_H
@@ -1,82 +1,112 @@
 // WeatherDataCollection.cpp
 
-// Implements the WeatherDataCollection class, which manages the storage (using BST and Map),
+// Implements the WeatherDataCollection class, which manages the storage (a columnar base plus a BST delta, and Maps),
 // loading, and analysis of all weather records. It provides methods for statistical
 // calculations and report generation.
 
 #include "WeatherDataCollection.h"
 #include "Statistics.h"
+#include "IngestPipeline.h"
+#include "RadixSort.h"
+#include "TaskPool.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
-#include <numeric> // for std::accumulate
-#include <algorithm> // for std::remove
-#include <random>    // for std::default_random_engine
-#include <chrono>    // for seed
+#include <algorithm> // for std::remove, std::make_heap
+#include <limits>
+#include <map>
 
 	/**
 	 * @brief Default constructor for WeatherDataCollection.
 	 *
-	 * Initializes the Binary Search Tree (BST) and the Map used for monthly lookups.
+	 * Starts with no base, an empty delta Binary Search Tree (BST) and empty indexes.
 	 *
 	 * @return void
 	 */
 WeatherDataCollection::WeatherDataCollection()
-    : weatherDataBST(new Bst<WeatherRecord>()),
-      dataByMonth(new Map<int, std::vector<WeatherRecord*>>()) {}
+    : base(),
+      weatherDataBST(new PersistentBst<WeatherRecord>()),
+      frozenDelta(nullptr),
+      compactedBase(),
+      compaction(nullptr),
+      compactionDone(false),
+      deltaCount(0),
+      compactionThreshold(kDefaultCompactionThreshold),
+      presenceByYear(new Map<int, YearPresence>()),
+      climatology(new ClimatologyIndex()),
+      samples(new ReservoirSampler()) {}
 
 	/**
 	 * @brief Destructor for WeatherDataCollection.
 	 *
-	 * Deletes the dynamically allocated BST and Map structures. The BST is assumed
-	 * to handle the deletion of the contained WeatherRecord objects and their associated Date objects.
+	 * Waits for a running compaction, whose task reads the base and the frozen delta,
+	 * then deletes both tiers and the index structures. The delta trees delete the
+	 * WeatherRecord objects (and their Date objects) no copy still shares.
 	 *
 	 * @return void
 	 */
 WeatherDataCollection::~WeatherDataCollection() {
-	// Note: The BST destructor handles deleting the WeatherRecord* objects,
-	// which in turn delete the Date* objects.
-
-	// We must clean up the pointers stored in the map's vectors,
-	// BUT ONLY IF they are not already cleaned up by the BST (i.e., if they were duplicates).
-	// Given the current structure where both the BST and Map hold the same pointers,
-	// this destructor is dangerous. If BST is the owner, we should clear the Map vectors
-	// without deleting the content, but the Map uses V* as data type for values.
-	// Assuming the BST handles deletion of all data, we only need to delete the Map structure itself.
-
-	// If the map was only holding pointers for faster lookup, we must clear the vectors
-	// to avoid double deletion or leakage.
-	// For simplicity, we stick to the original logic and trust the BST's dtor to clean up everything.
+	waitForCompaction();
+	delete compaction;
+	delete frozenDelta;
 	delete weatherDataBST;
-	delete dataByMonth;
+	delete presenceByYear;
+	delete climatology;
+	delete samples;
 }
 
 	/**
 	 * @brief Copy constructor for WeatherDataCollection.
 	 *
-	 * Performs a deep copy of the BST and the monthly lookup Map.
+	 * Shares the base and the delta tree's nodes (O(1); see Shared and PersistentBst),
+	 * copies the presence map, and copies the climatology and sample indexes, which
+	 * share their days and strata until changed. If other has a compaction
+	 * running it is waited for and its result becomes the copy's base, so the copy never
+	 * inherits a frozen delta.
 	 *
 	 * @param  other - The WeatherDataCollection object to copy from.
 	 * @return void
 	 */
 WeatherDataCollection::WeatherDataCollection(const WeatherDataCollection& other)
-    : weatherDataBST(new Bst<WeatherRecord>(*other.weatherDataBST)),
-      dataByMonth(new Map<int, std::vector<WeatherRecord*>>(*other.dataByMonth)) {}
+    : base(),
+      weatherDataBST(new PersistentBst<WeatherRecord>(*other.weatherDataBST)),
+      frozenDelta(nullptr),
+      compactedBase(),
+      compaction(nullptr),
+      compactionDone(false),
+      deltaCount(other.deltaCount),
+      compactionThreshold(other.compactionThreshold),
+      presenceByYear(new Map<int, YearPresence>(*other.presenceByYear)),
+      climatology(new ClimatologyIndex(*other.climatology)),
+      samples(new ReservoirSampler(*other.samples)) {
+	other.waitForCompaction();
+	base = other.compaction ? other.compactedBase : other.base;
+}
 
 	/**
 	 * @brief Assignment operator for WeatherDataCollection.
 	 *
-	 * Cleans up existing resources and performs a deep copy assignment.
+	 * Finishes any compaction of this collection, cleans up existing resources and
+	 * copies other as the copy constructor does.
 	 *
 	 * @param  other - The WeatherDataCollection object to assign from.
 	 * @return WeatherDataCollection& - Reference to the updated object.
 	 */
 WeatherDataCollection& WeatherDataCollection::operator=(const WeatherDataCollection& other) {
 	if (this != &other) {
+		finishCompaction(true);
+		other.waitForCompaction();
+
 		delete weatherDataBST;
-		delete dataByMonth;
-		weatherDataBST = new Bst<WeatherRecord>(*other.weatherDataBST);
-		dataByMonth = new Map<int, std::vector<WeatherRecord*>>(*other.dataByMonth);
+		delete presenceByYear;
+
+		base = other.compaction ? other.compactedBase : other.base;
+		weatherDataBST = new PersistentBst<WeatherRecord>(*other.weatherDataBST);
+		deltaCount = other.deltaCount;
+		compactionThreshold = other.compactionThreshold;
+		presenceByYear = new Map<int, YearPresence>(*other.presenceByYear);
+		*climatology = *other.climatology;
+		*samples = *other.samples;
 	}
 	return *this;
 }
@@ -84,142 +114,1094 @@ WeatherDataCollection& WeatherDataCollection::operator=(const WeatherDataCollect
 	/**
 	 * @brief Adds a new WeatherRecord to the collection.
 	 *
-	 * Inserts the record into the BST for ordered storage and also adds its pointer
-	 * to the corresponding monthly vector in the Map for fast lookup.
+	 * Inserts the record into the delta BST, then files it in the presence bitmap, the
+	 * climatology and the samples. A record with the same date and time as one already stored
+	 * in either tier is deleted here. A finished background compaction is installed first,
+	 * and a new one is started when the delta reaches the compaction threshold.
+	 *
+	 * @param  record - Pointer to the WeatherRecord to be added. Ownership passes to this class.
+	 * @return bool - True if added, false if it was a duplicate.
+	 */
+bool WeatherDataCollection::addWeatherRecord(WeatherRecord* record) {
+	finishCompaction(false);
+
+	if (containsDate(record) || !weatherDataBST->insert(record)) {
+		delete record;
+		return false;
+	}
+	deltaCount += 1;
+	indexRecord(record);
+
+	if (compactionThreshold > 0 && deltaCount >= compactionThreshold) {
+		startCompaction();
+	}
+	return true;
+}
+
+	/**
+	 * @brief Adds many records at once by merging them straight into the base.
+	 *
+	 * The records are put in time order by merging their ascending stretches (input that is
+	 * already sorted costs one pass), keeping the first of several readings with one
+	 * timestamp, and then bulk-added by addSortedRecords.
+	 *
+	 * @param  records - Pointer to the records (ownership is taken; the vector is cleared).
+	 * @return int - The number of records added.
+	 */
+int WeatherDataCollection::addWeatherRecords(std::vector<WeatherRecord*>* records) {
+	std::vector<std::vector<WeatherRecord*>> runs(1);
+	runs[0].swap(*records);
+
+	std::vector<WeatherRecord*> ordered;
+	mergeSortedRuns(&runs, &ordered);
+	return addSortedRecords(&ordered);
+}
+
+	/**
+	 * @brief Adds strictly ascending records by merging them straight into the base.
+	 *
+	 * The delta is compacted first so every stored timestamp is in the base; the new records
+	 * are then indexed and merged into a new base in one pass.
+	 *
+	 * @param  records - Pointer to the records, strictly ascending (ownership is taken; the vector is cleared).
+	 * @return int - The number of records added.
+	 */
+int WeatherDataCollection::addSortedRecords(std::vector<WeatherRecord*>* records) {
+	compact();
+
+	std::vector<WeatherRecord*> added;
+	added.reserve(records->size());
+	for (WeatherRecord* record : *records) {
+		if (containsDate(record)) {
+			delete record;
+			continue;
+		}
+		indexRecord(record);
+		added.push_back(record);
+	}
+	records->clear();
+	if (added.empty()) return 0;
+
+	base.reset(new ColumnStore(base.get(), &added));
+
+	for (WeatherRecord* record : added) {
+		delete record; // Now held by the base
+	}
+	return static_cast<int>(added.size());
+}
+
+	/**
+	 * @brief Head of one sorted run during a k-way merge.
+	 */
+struct RunCursor {
+	int key;      ///< Minute key of the run's current record.
+	size_t run;   ///< Index of the run (lower runs win ties).
+	size_t pos;   ///< Position of the current record in its input vector.
+	size_t end;   ///< One past the run's last position.
+	size_t input; ///< Index of the input vector holding the run.
+};
+
+	/**
+	 * @brief Splits the inputs into ascending runs and merges them through a min-heap.
+	 *
+	 * If there are too many runs for the heap to pay off, every record is instead radix
+	 * sorted by its packed minute key; the sort is stable, so the first record in input
+	 * order still wins a tie.
 	 *
-	 * @param  record - Pointer to the WeatherRecord to be added. Ownership remains with this class.
+	 * @param  runs - Pointer to the input vectors (records are taken over; the vectors are cleared).
+	 * @param  out - Receives the merged, deduplicated records.
+	 * @return size_t - The number of duplicates deleted.
+	 */
+size_t WeatherDataCollection::mergeSortedRuns(std::vector<std::vector<WeatherRecord*>>* runs, std::vector<WeatherRecord*>* out) {
+	// Min-heap on (key, run): std heap functions build a max-heap, so the comparison is reversed
+	auto later = [](const RunCursor& a, const RunCursor& b) {
+		return a.key != b.key ? a.key > b.key : a.run > b.run;
+	};
+
+	std::vector<RunCursor> heap;
+	size_t total = 0;
+	for (size_t input = 0; input < runs->size(); ++input) {
+		const std::vector<WeatherRecord*>& records = (*runs)[input];
+		total += records.size();
+
+		size_t begin = 0;
+		while (begin < records.size()) {
+			size_t end = begin + 1;
+			int previous = records[begin]->date->toMinuteKey();
+			while (end < records.size()) {
+				int key = records[end]->date->toMinuteKey();
+				if (key < previous) break;
+				previous = key;
+				++end;
+			}
+			heap.push_back(RunCursor{records[begin]->date->toMinuteKey(), heap.size(), begin, end, input});
+			begin = end;
+		}
+	}
+
+	out->reserve(out->size() + total);
+	size_t duplicates = 0;
+
+	// An unordered feed breaks into many short runs; a stable radix sort beats the heap there
+	const size_t kMaxHeapRuns = 64;
+	if (heap.size() > kMaxHeapRuns) {
+		std::vector<uint32_t> keys;
+		std::vector<WeatherRecord*> records;
+		keys.reserve(total);
+		records.reserve(total);
+		for (std::vector<WeatherRecord*>& input : *runs) {
+			for (WeatherRecord* record : input) {
+				keys.push_back(RadixSort::packKey(record->date->toMinuteKey()));
+				records.push_back(record);
+			}
+			input.clear();
+		}
+		RadixSort::sortPairs(&keys, &records, &TaskPool::instance());
+
+		for (size_t i = 0; i < records.size(); ++i) {
+			if (i > 0 && keys[i] == keys[i - 1]) {
+				delete records[i];
+				++duplicates;
+			} else {
+				out->push_back(records[i]);
+			}
+		}
+		return duplicates;
+	}
+
+	std::make_heap(heap.begin(), heap.end(), later);
+	bool hasLast = false;
+	int lastKey = 0;
+	while (!heap.empty()) {
+		std::pop_heap(heap.begin(), heap.end(), later);
+		RunCursor& cursor = heap.back();
+		WeatherRecord* record = (*runs)[cursor.input][cursor.pos];
+
+		if (hasLast && cursor.key == lastKey) {
+			delete record; // Overlapping reading: the earlier run already supplied this timestamp
+			++duplicates;
+		} else {
+			out->push_back(record);
+			lastKey = cursor.key;
+			hasLast = true;
+		}
+
+		if (++cursor.pos < cursor.end) {
+			cursor.key = (*runs)[cursor.input][cursor.pos]->date->toMinuteKey();
+			std::push_heap(heap.begin(), heap.end(), later);
+		} else {
+			heap.pop_back();
+		}
+	}
+
+	for (std::vector<WeatherRecord*>& records : *runs) {
+		records.clear();
+	}
+	return duplicates;
+}
+
+	/**
+	 * @brief Replaces the contents with the rows of a column store.
+	 *
+	 * The presence bitmap, the climatology and the samples are rebuilt from the rows.
+	 *
+	 * @param  store - Pointer to the store (ownership is taken).
 	 * @return void
 	 */
-void WeatherDataCollection::addWeatherRecord(WeatherRecord* record) {
-	// Attempt to insert into BST. If a record with the same key (Date+Time) exists,
-	// the current BST implementation will not insert and will leak 'record'.
-	// Since we cannot change Bst<T>::insertRec, we must assume the caller (parseAndAddRecord)
-	// is responsible for handling the leak if Bst doesn't insert.
-	// However, the Bst does not return a status. We'll rely on the fix
-	// in Date comparison to minimize duplicate keys.
-	weatherDataBST->insert(record);
+void WeatherDataCollection::loadColumnStore(ColumnStore* store) {
+	finishCompaction(true);
 
+	base.reset(store);
+	delete weatherDataBST;
+	weatherDataBST = new PersistentBst<WeatherRecord>();
+	deltaCount = 0;
+	delete presenceByYear;
+	presenceByYear = new Map<int, YearPresence>();
+	climatology->clear();
+	samples->clear();
+
+	forEachInRange(std::numeric_limits<int>::min(), std::numeric_limits<int>::max(),
+				   [](const WeatherRecord* record, void* context) {
+		static_cast<WeatherDataCollection*>(context)->indexRecord(record);
+	}, this);
+}
+
+	/**
+	 * @brief Files a record in the presence bitmap, the climatology and the samples.
+	 *
+	 * @param  record - Pointer to the WeatherRecord.
+	 * @return void
+	 */
+void WeatherDataCollection::indexRecord(const WeatherRecord* record) {
 	int month = record->date->GetMonth();
-	if (!dataByMonth->contains(&month)) {
-		dataByMonth->insert(&month, new std::vector<WeatherRecord*>());
+	int year = record->date->GetYear();
+
+	// Map::at default-constructs a zeroed YearPresence for a year seen for the first time
+	YearPresence* presence = presenceByYear->at(&year);
+	presence->monthMask |= static_cast<unsigned short>(1u << (month - 1));
+	presence->counts[month - 1] += 1;
+
+	climatology->add(record);
+	samples->add(record);
+}
+
+	/**
+	 * @brief Takes a record out of the presence bitmap, the climatology and the samples.
+	 *
+	 * A month whose count drops to zero loses its presence bit, and a year with no months left is dropped.
+	 *
+	 * @param  record - Pointer to the WeatherRecord.
+	 * @return void
+	 */
+void WeatherDataCollection::unindexRecord(const WeatherRecord* record) {
+	int month = record->date->GetMonth();
+	int year = record->date->GetYear();
+
+	if (presenceByYear->contains(&year)) {
+		YearPresence* presence = presenceByYear->at(&year);
+		if (presence->counts[month - 1] > 0 && --presence->counts[month - 1] == 0) {
+			presence->monthMask &= static_cast<unsigned short>(~(1u << (month - 1)));
+			if (presence->monthMask == 0) presenceByYear->erase(&year);
+		}
 	}
 
-	std::vector<WeatherRecord*>* monthRecords = dataByMonth->at(&month);
-	monthRecords->push_back(record);
+	climatology->remove(record);
+	samples->remove(record);
 }
 
 	/**
-	 * @brief Displays all stored weather data records to the console in order.
+	 * @brief Removes a minute-key range from both tiers.
 	 *
-	 * Performs an in-order traversal on the BST and prints each record.
+	 * A running compaction is installed first so there is one delta tree. Its range is cut
+	 * out with PersistentBst::eraseRange, which reports each removed record for unindexing
+	 * before releasing it. The base rows of the range are then unindexed (the delta no longer
+	 * contributes to the scan) and the base replaced by a copy without them.
 	 *
+	 * @param  from - First minute key.
+	 * @param  to - Last minute key (inclusive).
+	 * @return int - The number of records removed.
+	 */
+int WeatherDataCollection::eraseRange(int from, int to) {
+	if (from > to) return 0;
+	finishCompaction(true);
+
+	int fromDelta = weatherDataBST->eraseRange(
+		[from](const WeatherRecord* record) { return record->date->toMinuteKey() < from; },
+		[to](const WeatherRecord* record) { return record->date->toMinuteKey() > to; },
+		[](const WeatherRecord* record, void* context) {
+			static_cast<WeatherDataCollection*>(context)->unindexRecord(record);
+		}, this);
+	deltaCount -= fromDelta;
+
+	int fromBase = 0;
+	if (base) {
+		size_t begin = base->lowerBound(from);
+		size_t end = (to == std::numeric_limits<int>::max()) ? base->size() : base->lowerBound(to + 1);
+		if (begin < end) {
+			forEachInRange(from, to, [](const WeatherRecord* record, void* context) {
+				static_cast<WeatherDataCollection*>(context)->unindexRecord(record);
+			}, this);
+
+			base.reset(new ColumnStore(base.get(), begin, end));
+			fromBase = static_cast<int>(end - begin);
+		}
+	}
+	return fromDelta + fromBase;
+}
+
+	/**
+	 * @brief Removes every record dated before a date.
+	 *
+	 * @param  date - Pointer to the first date to keep.
+	 * @return int - The number of records removed.
+	 */
+int WeatherDataCollection::eraseBefore(const Date* date) {
+	int key = date->toMinuteKey();
+	if (key == std::numeric_limits<int>::min()) return 0;
+	return eraseRange(std::numeric_limits<int>::min(), key - 1);
+}
+
+	/**
+	 * @brief Removes every record of a year.
+	 *
+	 * @param  year - The year.
+	 * @return int - The number of records removed.
+	 */
+int WeatherDataCollection::eraseYear(int year) {
+	int from, to, unused;
+	monthRange(year, 1, &from, &unused);
+	monthRange(year, 12, &unused, &to);
+	return eraseRange(from, to);
+}
+
+	/**
+	 * @brief Checks the base and the frozen delta for a record's timestamp.
+	 *
+	 * The live delta is not checked; its insert rejects duplicates itself.
+	 *
+	 * @param  record - Pointer to the probe record.
+	 * @return bool - True if the timestamp is already stored.
+	 */
+bool WeatherDataCollection::containsDate(WeatherRecord* record) const {
+	if (base) {
+		int key = record->date->toMinuteKey();
+		size_t row = base->lowerBound(key);
+		if (row < base->size() && base->getKey(row) == key) return true;
+	}
+	return frozenDelta != nullptr && frozenDelta->search(record) != nullptr;
+}
+
+	/**
+	 * @brief Traversal helper that collects the record pointers of one slice (no copies).
+	 *
+	 * @param  record - Pointer to the current WeatherRecord.
+	 * @param  slice - Pointer to the slice's vector.
 	 * @return void
 	 */
-void WeatherDataCollection::displayAllData() const {
-	std::cout << "=== All Weather Data (" << getTotalRecords() << " records) ===" << std::endl;
-	weatherDataBST->inOrder([](const WeatherRecord* record) {
-		// Use the new overloaded stream operator for WeatherRecord*
-		std::cout << record << std::endl;
-	});
+static void collectRecord(const WeatherRecord* record, std::vector<WeatherRecord*>* slice) {
+	slice->push_back(const_cast<WeatherRecord*>(record));
 }
 
 	/**
-	 * @brief Loads weather data from a list of CSV files.
+	 * @brief Merges the rows of a base with the records of a delta tree into a new base.
 	 *
-	 * Reads filenames from the provided list file, then parses each CSV, creates
-	 * WeatherRecord objects, and adds them to the collection. Records are shuffled
-	 * before final insertion into the BST for balance.
+	 * The delta is collected in rank slices on the TaskPool; concatenating the slices
+	 * keeps the records in date order.
+	 *
+	 * @param  oldBase - Pointer to the old base (may be nullptr).
+	 * @param  delta - Pointer to the delta tree.
+	 * @return ColumnStore* - Pointer to the new base. Caller must delete it.
+	 */
+ColumnStore* WeatherDataCollection::foldDelta(const ColumnStore* oldBase, const PersistentBst<WeatherRecord>* delta) {
+	std::vector<std::vector<WeatherRecord*>> slices;
+	delta->parallelInOrder(collectRecord, &slices);
+
+	std::vector<WeatherRecord*> ordered;
+	ordered.reserve(static_cast<size_t>(delta->size()));
+	for (const std::vector<WeatherRecord*>& slice : slices) {
+		ordered.insert(ordered.end(), slice.begin(), slice.end());
+	}
+	return new ColumnStore(oldBase, &ordered);
+}
+
+	/**
+	 * @brief Freezes the delta and submits its merge with the base to the TaskPool.
+	 *
+	 * The task only reads the base and the frozen delta, which stay untouched until the
+	 * result is installed, and only writes compactedBase.
+	 *
+	 * @return bool - True if a compaction was started.
+	 */
+bool WeatherDataCollection::startCompaction() {
+	finishCompaction(false);
+	if (compaction || deltaCount == 0) return false;
+
+	frozenDelta = weatherDataBST;
+	weatherDataBST = new PersistentBst<WeatherRecord>();
+	deltaCount = 0;
+
+	const ColumnStore* oldBase = base.get();
+	const PersistentBst<WeatherRecord>* frozen = frozenDelta;
+	compactionDone.store(false);
+	compaction = new TaskGroup();
+	compaction->run([this, oldBase, frozen] {
+		compactedBase.reset(foldDelta(oldBase, frozen));
+		compactionDone.store(true, std::memory_order_release);
+	}, "collection.compact");
+	return true;
+}
+
+	/**
+	 * @brief Waits until the running compaction task, if any, has finished.
 	 *
-	 * @param  filename - Pointer to the string containing the name of the file listing the CSVs.
 	 * @return void
 	 */
-void WeatherDataCollection::loadFromFiles(std::string* filename) {
-	std::ifstream listFile(*filename);
+void WeatherDataCollection::waitForCompaction() const {
+	if (compaction) compaction->wait();
+}
 
-	if (!listFile.is_open()) {
-		std::cerr << "Failed to open file list: " << *filename << std::endl;
-		return;
+	/**
+	 * @brief Swaps in the base built by a finished compaction and frees the frozen delta.
+	 *
+	 * @param  block - True to wait for a running compaction; false to leave it running if it is not done.
+	 * @return void
+	 */
+void WeatherDataCollection::finishCompaction(bool block) {
+	if (!compaction) return;
+	if (!block && !compactionDone.load(std::memory_order_acquire)) return;
+
+	compaction->wait();
+	delete compaction;
+	compaction = nullptr;
+	compactionDone.store(false);
+
+	base = compactedBase;
+	compactedBase.reset();
+	delete frozenDelta;
+	frozenDelta = nullptr;
+}
+
+	/**
+	 * @brief Folds everything in the delta tiers into the base, waiting for the work to finish.
+	 *
+	 * @return void
+	 */
+void WeatherDataCollection::compact() {
+	finishCompaction(true);
+	if (startCompaction()) {
+		finishCompaction(true);
 	}
+}
 
-	std::vector<WeatherRecord*> recordsToInsert; // Accumulate all records here first
+	/**
+	 * @brief Returns the number of records held in the delta BSTs.
+	 *
+	 * @return int - The record count.
+	 */
+int WeatherDataCollection::getDeltaRecordCount() const {
+	return deltaCount + (frozenDelta ? frozenDelta->size() : 0);
+}
 
-	std::string csvFileName;
-	while (std::getline(listFile, csvFileName)) {
-		csvFileName.erase(std::remove(csvFileName.begin(), csvFileName.end(), '\r'), csvFileName.end());
-		if (csvFileName.empty()) continue;
+	/**
+	 * @brief Context of the collectInRange traversal helper.
+	 */
+struct RangeContext {
+	std::vector<WeatherRecord*>* records; ///< Destination of the matching records.
+	int from;                             ///< First minute key.
+	int to;                               ///< Last minute key (inclusive).
+};
 
-		std::string fullPath = "data/" + csvFileName;
-		std::ifstream csvFile(fullPath);
+	/**
+	 * @brief Traversal helper that collects the record pointers whose key lies in a range.
+	 *
+	 * @param  record - Pointer to the current WeatherRecord.
+	 * @param  context - Pointer to the RangeContext.
+	 * @return void
+	 */
+static void collectInRange(const WeatherRecord* record, void* context) {
+	RangeContext* range = static_cast<RangeContext*>(context);
+	int key = record->date->toMinuteKey();
+	if (key >= range->from && key <= range->to) {
+		range->records->push_back(const_cast<WeatherRecord*>(record));
+	}
+}
 
-		if (!csvFile.is_open()) {
-			std::cerr << "Failed to open CSV file: " << fullPath << std::endl;
-			continue;
+	/**
+	 * @brief Collects the delta-tier records of a key range, merging the frozen and live deltas by date.
+	 *
+	 * @param  from - First minute key.
+	 * @param  to - Last minute key (inclusive).
+	 * @param  out - Receives the record pointers in date order.
+	 * @return void
+	 */
+void WeatherDataCollection::collectDelta(int from, int to, std::vector<WeatherRecord*>* out) const {
+	RangeContext range{out, from, to};
+	if (frozenDelta) frozenDelta->inOrder(collectInRange, &range);
+	size_t frozenEnd = out->size();
+	weatherDataBST->inOrder(collectInRange, &range);
+
+	std::inplace_merge(out->begin(), out->begin() + frozenEnd, out->end(),
+					   [](const WeatherRecord* a, const WeatherRecord* b) {
+						   return a->date->toMinuteKey() < b->date->toMinuteKey();
+					   });
+}
+
+	/**
+	 * @brief Visits the records of a key range in date order, merging the base rows with the delta records.
+	 *
+	 * Base rows are decoded a chunk at a time, column by column, into one scratch record.
+	 *
+	 * @param  from - First minute key.
+	 * @param  to - Last minute key (inclusive).
+	 * @param  visit - Function applied to each record.
+	 * @param  context - Opaque pointer passed to visit.
+	 * @return void
+	 */
+void WeatherDataCollection::forEachInRange(int from, int to, RecordVisitor visit, void* context) const {
+	if (from > to) return;
+
+	std::vector<WeatherRecord*> recent;
+	collectDelta(from, to, &recent);
+
+	size_t row = 0;
+	size_t end = 0;
+	if (base) {
+		row = base->lowerBound(from);
+		end = (to == std::numeric_limits<int>::max()) ? base->size() : base->lowerBound(to + 1);
+	}
+
+	const size_t kChunk = 256;
+	double values[kMetricCount][kChunk];
+	size_t chunkStart = row;
+	size_t chunkEnd = row;
+	WeatherRecord scratch(new Date(), 0.0, 0.0, 0.0);
+
+	size_t next = 0;
+	while (row < end || next < recent.size()) {
+		if (row < end && (next == recent.size() || base->getKey(row) < recent[next]->date->toMinuteKey())) {
+			if (row == chunkEnd) {
+				chunkStart = row;
+				chunkEnd = std::min(end, row + kChunk);
+				for (int m = 0; m < kMetricCount; ++m) {
+					base->copyColumn(static_cast<Metric>(m), chunkStart, chunkEnd, values[m]);
+				}
+			}
+			scratch.date->setMinuteKey(base->getKey(row));
+			scratch.windSpeed = values[static_cast<int>(Metric::WindSpeed)][row - chunkStart];
+			scratch.temperature = values[static_cast<int>(Metric::Temperature)][row - chunkStart];
+			scratch.solarRadiation = values[static_cast<int>(Metric::SolarRadiation)][row - chunkStart];
+			scratch.windDirection = values[static_cast<int>(Metric::WindDirection)][row - chunkStart];
+			visit(&scratch, context);
+			++row;
+		} else {
+			visit(recent[next++], context);
 		}
+	}
+}
 
-		std::string line;
-		// Skip the header line
-		if (std::getline(csvFile, line)) {
-			// Header skipped successfully
+	/**
+	 * @brief Aggregates one metric over a key range: the base's columnar summary plus the delta records.
+	 *
+	 * @param  metric - The metric.
+	 * @param  from - First minute key.
+	 * @param  to - Last minute key (inclusive).
+	 * @return SeriesSummary - The aggregates.
+	 */
+SeriesSummary WeatherDataCollection::summarize(Metric metric, int from, int to) const {
+	SeriesSummary summary = {0, 0.0, 0.0, 0.0, 0.0};
+	if (from > to) return summary;
+	if (base) summary = base->summarize(metric, from, to);
+
+	std::vector<WeatherRecord*> recent;
+	collectDelta(from, to, &recent);
+	for (const WeatherRecord* record : recent) {
+		double value = metricValue(record, metric);
+		if (summary.count == 0) {
+			summary.min = value;
+			summary.max = value;
 		}
+		summary.count += 1;
+		summary.sum += value;
+		summary.sumSq += value * value;
+		summary.min = std::min(summary.min, value);
+		summary.max = std::max(summary.max, value);
+	}
+	return summary;
+}
 
-		// ------------------ PARSING LOGIC ------------------
-		while (std::getline(csvFile, line)) {
-			std::stringstream ss(line);
-			std::string token;
-			std::vector<std::string> tokens;
+	/**
+	 * @brief Copies a metric column and its keys over a key range, merging the delta records into the base slice.
+	 *
+	 * @param  metric - The metric.
+	 * @param  from - First minute key.
+	 * @param  to - Last minute key (inclusive).
+	 * @param  keys - Receives the keys.
+	 * @param  values - Receives the values.
+	 * @return void
+	 */
+void WeatherDataCollection::copySeries(Metric metric, int from, int to, std::vector<int>* keys, std::vector<double>* values) const {
+	keys->clear();
+	values->clear();
+	if (from > to) return;
+
+	size_t row = 0;
+	size_t end = 0;
+	if (base) {
+		row = base->lowerBound(from);
+		end = (to == std::numeric_limits<int>::max()) ? base->size() : base->lowerBound(to + 1);
+	}
+
+	std::vector<WeatherRecord*> recent;
+	collectDelta(from, to, &recent);
 
-			while (std::getline(ss, token, ',')) {
-				tokens.push_back(token);
+	keys->resize(end - row + recent.size());
+	values->resize(end - row + recent.size());
+	if (recent.empty()) {
+		for (size_t i = row; i < end; ++i) {
+			(*keys)[i - row] = base->getKey(i);
+		}
+		if (end > row) base->copyColumn(metric, row, end, values->data());
+		return;
+	}
+
+	std::vector<double> baseValues(end - row);
+	if (end > row) base->copyColumn(metric, row, end, baseValues.data());
+
+	size_t out = 0;
+	size_t next = 0;
+	size_t first = row;
+	while (row < end || next < recent.size()) {
+		if (row < end && (next == recent.size() || base->getKey(row) < recent[next]->date->toMinuteKey())) {
+			(*keys)[out] = base->getKey(row);
+			(*values)[out++] = baseValues[row - first];
+			++row;
+		} else {
+			const WeatherRecord* record = recent[next++];
+			(*keys)[out] = record->date->toMinuteKey();
+			(*values)[out++] = metricValue(record, metric);
+		}
+	}
+}
+
+	/**
+	 * @brief Returns the minute key of a record; the key function of the delta lookups.
+	 *
+	 * @param  record - Pointer to the record.
+	 * @return int - The minute key.
+	 */
+static int minuteKeyOf(const WeatherRecord* record) {
+	return record->date->toMinuteKey();
+}
+
+	/**
+	 * @brief Looks a key up in the base (binary search) and in each delta tree (one descent), keeping the closest hit.
+	 *
+	 * Keys are unique across the tiers, so the closest hit is the answer.
+	 *
+	 * @param  key - The minute key.
+	 * @param  below - True for the floor, false for the ceiling.
+	 * @param  foundKey - Receives the key found.
+	 * @param  record - Receives the delta record found, or nullptr for a base row.
+	 * @param  row - Receives the base row found.
+	 * @return bool - False if nothing was found.
+	 */
+bool WeatherDataCollection::locate(int key, bool below, int* foundKey, const WeatherRecord** record, size_t* row) const {
+	bool found = false;
+	*record = nullptr;
+
+	if (base && base->size() > 0) {
+		if (below) {
+			size_t next = (key == std::numeric_limits<int>::max()) ? base->size() : base->lowerBound(key + 1);
+			if (next > 0) {
+				*row = next - 1;
+				found = true;
+			}
+		} else {
+			size_t next = base->lowerBound(key);
+			if (next < base->size()) {
+				*row = next;
+				found = true;
 			}
+		}
+		if (found) *foundKey = base->getKey(*row);
+	}
 
-			if (tokens.size() < 18) continue; // Skip lines with too few tokens
+	const PersistentBst<WeatherRecord>* trees[2] = {frozenDelta, weatherDataBST};
+	for (const PersistentBst<WeatherRecord>* tree : trees) {
+		if (!tree) continue;
+		PersistentNode<WeatherRecord>* node = below ? tree->floor(key, minuteKeyOf) : tree->ceil(key, minuteKeyOf);
+		if (!node) continue;
+
+		int nodeKey = minuteKeyOf(node->data);
+		if (!found || (below ? nodeKey > *foundKey : nodeKey < *foundKey)) {
+			*foundKey = nodeKey;
+			*record = node->data;
+			found = true;
+		}
+	}
+	return found;
+}
 
-			try {
-				// 1. Parse Date/Time (Index 0)
-				Date* date = parseDate(&tokens[0]);
+	/**
+	 * @brief Fills a record from a delta record or a base row without allocating.
+	 *
+	 * @param  key - Minute key of the source.
+	 * @param  record - The delta record, or nullptr to decode base row row.
+	 * @param  row - The base row.
+	 * @param  out - The record to fill.
+	 * @return void
+	 */
+void WeatherDataCollection::readInto(int key, const WeatherRecord* record, size_t row, WeatherRecord* out) const {
+	out->date->setMinuteKey(key);
+	if (record) {
+		out->windSpeed = record->windSpeed;
+		out->temperature = record->temperature;
+		out->solarRadiation = record->solarRadiation;
+		out->windDirection = record->windDirection;
+	} else {
+		out->windSpeed = base->getValue(Metric::WindSpeed, row);
+		out->temperature = base->getValue(Metric::Temperature, row);
+		out->solarRadiation = base->getValue(Metric::SolarRadiation, row);
+		out->windDirection = base->getValue(Metric::WindDirection, row);
+	}
+}
 
-				// 2. Extract Data (Indices 10, 11, 17) with N/A check
-				double windSpeed = 0.0;
-				if (tokens[10] != "N/A") windSpeed = std::stod(tokens[10]);
+	/**
+	 * @brief Finds the latest record at or before a minute key.
+	 *
+	 * @param  key - The minute key.
+	 * @param  out - Pointer to the record to fill.
+	 * @return bool - False if none exists.
+	 */
+bool WeatherDataCollection::findFloor(int key, WeatherRecord* out) const {
+	int foundKey = 0;
+	const WeatherRecord* record = nullptr;
+	size_t row = 0;
+	if (!locate(key, true, &foundKey, &record, &row)) return false;
+	readInto(foundKey, record, row, out);
+	return true;
+}
 
-				double solarRadiation = 0.0;
-				if (tokens[11] != "N/A") solarRadiation = std::stod(tokens[11]);
+	/**
+	 * @brief Finds the earliest record at or after a minute key.
+	 *
+	 * @param  key - The minute key.
+	 * @param  out - Pointer to the record to fill.
+	 * @return bool - False if none exists.
+	 */
+bool WeatherDataCollection::findCeil(int key, WeatherRecord* out) const {
+	int foundKey = 0;
+	const WeatherRecord* record = nullptr;
+	size_t row = 0;
+	if (!locate(key, false, &foundKey, &record, &row)) return false;
+	readInto(foundKey, record, row, out);
+	return true;
+}
 
-				double temperature = 0.0;
-				if (tokens[17] != "N/A") temperature = std::stod(tokens[17]);
+	/**
+	 * @brief Finds the record closest to a minute key by comparing its floor and ceiling.
+	 *
+	 * @param  key - The minute key.
+	 * @param  out - Pointer to the record to fill.
+	 * @return bool - False if the collection is empty.
+	 */
+bool WeatherDataCollection::findNearest(int key, WeatherRecord* out) const {
+	int floorKey = 0, ceilKey = 0;
+	const WeatherRecord* floorRecord = nullptr;
+	const WeatherRecord* ceilRecord = nullptr;
+	size_t floorRow = 0, ceilRow = 0;
+	bool hasFloor = locate(key, true, &floorKey, &floorRecord, &floorRow);
+	bool hasCeil = locate(key, false, &ceilKey, &ceilRecord, &ceilRow);
+	if (!hasFloor && !hasCeil) return false;
+
+	bool useFloor = hasFloor &&
+		(!hasCeil || static_cast<long long>(key) - floorKey <= static_cast<long long>(ceilKey) - key);
+	if (useFloor) {
+		readInto(floorKey, floorRecord, floorRow, out);
+	} else {
+		readInto(ceilKey, ceilRecord, ceilRow, out);
+	}
+	return true;
+}
 
-				// 3. Create Record and Store in temporary vector
-				recordsToInsert.push_back(
-					new WeatherRecord(date, windSpeed, temperature, solarRadiation)
-				);
+	/**
+	 * @brief Resolves the floors of an ascending run of keys.
+	 *
+	 * Each delta tree answers the whole batch with PersistentBst::floorBatch; the base search for
+	 * each key gallops forward from the row found for the previous one.
+	 *
+	 * @param  keys - Pointer to the minute keys, ascending.
+	 * @param  visit - Function called with each key's floor (or nullptr).
+	 * @param  context - Opaque pointer passed to visit.
+	 * @return size_t - The number of keys that have a floor.
+	 */
+size_t WeatherDataCollection::findFloorBatch(const std::vector<int>* keys, RecordVisitor visit, void* context) const {
+	size_t count = keys->size();
+	std::vector<PersistentNode<WeatherRecord>*> liveFloors(count, nullptr);
+	std::vector<PersistentNode<WeatherRecord>*> frozenFloors(count, nullptr);
+	weatherDataBST->floorBatch(keys->data(), count, minuteKeyOf, liveFloors.data());
+	if (frozenDelta) frozenDelta->floorBatch(keys->data(), count, minuteKeyOf, frozenFloors.data());
+
+	WeatherRecord scratch(new Date(), 0.0, 0.0, 0.0);
+	size_t resolved = 0;
+	size_t next = 0;
+	for (size_t i = 0; i < count; ++i) {
+		int key = (*keys)[i];
+		bool found = false;
+		int foundKey = 0;
+		const WeatherRecord* record = nullptr;
+
+		if (base) {
+			next = (key == std::numeric_limits<int>::max()) ? base->size() : base->lowerBound(key + 1, next);
+			if (next > 0) {
+				foundKey = base->getKey(next - 1);
+				found = true;
+			}
+		}
 
-			} catch (const std::exception& e) {
-				std::cerr << "Parsing error during file read: " << e.what()
-						  << " on line: " << line << std::endl;
+		PersistentNode<WeatherRecord>* nodes[2] = {frozenFloors[i], liveFloors[i]};
+		for (PersistentNode<WeatherRecord>* node : nodes) {
+			if (node && (!found || minuteKeyOf(node->data) > foundKey)) {
+				foundKey = minuteKeyOf(node->data);
+				record = node->data;
+				found = true;
 			}
 		}
-		// ------------------ END OF PARSING ------------------
-		csvFile.close();
+
+		if (!found) {
+			visit(nullptr, context);
+			continue;
+		}
+		readInto(foundKey, record, next - 1, &scratch);
+		visit(&scratch, context);
+		++resolved;
 	}
-	listFile.close();
+	return resolved;
+}
 
-	// ------------------ OPTIMIZATION STEP ------------------
-	if (recordsToInsert.empty()) {
-		std::cerr << "No valid records were parsed from files." << std::endl;
-		return;
+	/**
+	 * @brief Computes the minute keys of the first and last minute of a month.
+	 *
+	 * @param  year - The year.
+	 * @param  month - The month (1-12).
+	 * @param  from - Receives the first key.
+	 * @param  to - Receives the last key.
+	 * @return void
+	 */
+void WeatherDataCollection::monthRange(int year, int month, int* from, int* to) {
+	Date first(1, month, year);
+	Date next(1, month == 12 ? 1 : month + 1, month == 12 ? year + 1 : year);
+	*from = first.toMinuteKey();
+	*to = next.toMinuteKey() - 1;
+}
+
+	/**
+	 * @brief Finds the base rows of a month by binary search and collects its delta records, for each year holding it when year is 0.
+	 *
+	 * @param  year - The year (0 for every year holding the month).
+	 * @param  month - The month (1-12).
+	 * @param  rows - Receives the base row ranges.
+	 * @param  recent - Receives the delta records.
+	 * @return void
+	 */
+void WeatherDataCollection::monthRows(int year, int month, std::vector<ColumnStore::RowRange>* rows, std::vector<WeatherRecord*>* recent) const {
+	rows->clear();
+	recent->clear();
+
+	size_t offset = 0;
+	unsigned short bit = static_cast<unsigned short>(1u << (month - 1));
+	for (const auto& entry : *presenceByYear) {
+		if (year != 0 && entry.first != year) continue;
+		if (!(entry.second.monthMask & bit)) continue;
+		int from, to;
+		monthRange(entry.first, month, &from, &to);
+		collectDelta(from, to, recent);
+		if (!base) continue;
+		size_t begin = base->lowerBound(from);
+		size_t end = base->lowerBound(to + 1, begin);
+		if (end == begin) continue;
+		rows->push_back(ColumnStore::RowRange{begin, end, offset});
+		offset += end - begin;
 	}
+}
+
+	/**
+	 * @brief Checks the presence bitmap for a year and month.
+	 *
+	 * @param  year - Pointer to the year (0 for any year).
+	 * @param  month - Pointer to the month (1-12).
+	 * @return bool - True if at least one record exists.
+	 */
+bool WeatherDataCollection::hasData(int* year, int* month) const {
+	if (!year || !month || *month < 1 || *month > 12) return false;
 
-	std::cout << "Successfully parsed " << recordsToInsert.size() << " records. Shuffling for fast insertion..." << std::endl;
+	unsigned short bit = static_cast<unsigned short>(1u << (*month - 1));
+	if (*year != 0) {
+		return (getMonthMask(year) & bit) != 0;
+	}
+	for (const auto& entry : *presenceByYear) {
+		if (entry.second.monthMask & bit) return true;
+	}
+	return false;
+}
 
-	// SHUFFLE the records before inserting into the BST
-	unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-	std::shuffle(recordsToInsert.begin(), recordsToInsert.end(), std::default_random_engine(seed));
+	/**
+	 * @brief Returns the record count of a year and month from the presence index.
+	 *
+	 * @param  year - Pointer to the year (0 for all years).
+	 * @param  month - Pointer to the month (1-12).
+	 * @return int - The record count.
+	 */
+int WeatherDataCollection::getRecordCount(int* year, int* month) const {
+	if (!year || !month || *month < 1 || *month > 12) return 0;
 
-	// ------------------ FINAL INSERTION STEP ------------------
-	for (WeatherRecord* record : recordsToInsert) {
-		// addWeatherRecord handles insertion into BST and Map
+	if (*year != 0) {
+		const Map<int, YearPresence>* presence = presenceByYear;
+		return presence->contains(year) ? presence->at(year)->counts[*month - 1] : 0;
+	}
+	int total = 0;
+	for (const auto& entry : *presenceByYear) {
+		total += entry.second.counts[*month - 1];
+	}
+	return total;
+}
+
+	/**
+	 * @brief Returns the bitmap of months of a year that hold records.
+	 *
+	 * @param  year - Pointer to the year.
+	 * @return unsigned short - Bit m-1 is set when month m has records.
+	 */
+unsigned short WeatherDataCollection::getMonthMask(int* year) const {
+	const Map<int, YearPresence>* presence = presenceByYear;
+	if (!year || !presence->contains(year)) return 0;
+	return presence->at(year)->monthMask;
+}
+
+	/**
+	 * @brief Displays all stored weather data records to the console in order.
+	 *
+	 * Scans both tiers in date order and prints each record.
+	 *
+	 * @return void
+	 */
+void WeatherDataCollection::displayAllData() const {
+	std::cout << "=== All Weather Data (" << getTotalRecords() << " records) ===" << std::endl;
+	forEachInRange(std::numeric_limits<int>::min(), std::numeric_limits<int>::max(),
+				   [](const WeatherRecord* record, void*) {
+		// Use the new overloaded stream operator for WeatherRecord*
+		std::cout << record << std::endl;
+	}, nullptr);
+}
+
+	/**
+	 * @brief Parses one CSV data line into a new WeatherRecord.
+	 *
+	 * Extracts the date/time, wind speed, solar radiation, temperature and wind
+	 * direction from the columns the layout names. "N/A" readings are stored as 0.0.
+	 *
+	 * @param  line - Pointer to the raw CSV line.
+	 * @param  layout - Pointer to the column positions of the line's file (nullptr for the standard layout).
+	 * @return WeatherRecord* - The new record, or nullptr if the line is short or malformed.
+	 */
+WeatherRecord* WeatherDataCollection::parseRecord(std::string* line, const CsvLayout* layout) {
+	static const CsvLayout standard = CsvLayout::standard();
+	if (layout == nullptr) layout = &standard;
+
+	std::stringstream ss(*line);
+	std::string token;
+	std::vector<std::string> tokens;
+
+	while (std::getline(ss, token, ',')) {
+		tokens.push_back(token);
+	}
+
+	if (tokens.size() < static_cast<size_t>(layout->width)) return nullptr; // Skip lines with too few tokens
+
+	try {
+		// 1. Extract Data (columns named by the layout) with N/A check
+		double windSpeed = 0.0;
+		if (tokens[layout->windSpeed] != "N/A") windSpeed = std::stod(tokens[layout->windSpeed]);
+
+		double solarRadiation = 0.0;
+		if (tokens[layout->solarRadiation] != "N/A") solarRadiation = std::stod(tokens[layout->solarRadiation]);
+
+		double temperature = 0.0;
+		if (tokens[layout->temperature] != "N/A") temperature = std::stod(tokens[layout->temperature]);
+
+		double windDirection = 0.0;
+		if (layout->windDirection >= 0 && tokens[layout->windDirection] != "N/A") {
+			windDirection = std::stod(tokens[layout->windDirection]);
+		}
+
+		// 2. Parse Date/Time and create the record
+		return new WeatherRecord(parseDate(&tokens[layout->date]), windSpeed, temperature, solarRadiation, windDirection);
+
+	} catch (const std::exception& e) {
+		std::cerr << "Parsing error during file read: " << e.what()
+				  << " on line: " << *line << std::endl;
+	}
+	return nullptr;
+}
+
+	/**
+	 * @brief Parses a single CSV line and adds the resulting record to the collection.
+	 *
+	 * @param  line - Pointer to the raw CSV line.
+	 * @return void
+	 */
+void WeatherDataCollection::parseAndAddRecord(std::string* line) {
+	WeatherRecord* record = parseRecord(line);
+	if (record != nullptr) {
 		addWeatherRecord(record);
 	}
+}
+
+	/**
+	 * @brief State of a bulk load: the batches of files not yet folded in, and the running totals.
+	 */
+struct LoadProgress {
+	WeatherDataCollection* collection;                               ///< The collection being loaded.
+	std::vector<std::map<long, std::vector<WeatherRecord*>>> chunks; ///< Batches per file not yet folded, by sequence.
+	std::vector<long> chunkCounts;                                   ///< Chunks in each file once its last one arrived, else -1.
+	size_t nextFile;                                                 ///< The next file to fold, in list order.
+	size_t parsed;                                                   ///< Records parsed so far.
+	size_t duplicates;                                               ///< Readings dropped as already stored.
+};
+
+	/**
+	 * @brief Pipeline sink that files each batch under its file and folds every complete file into the collection.
+	 *
+	 * Files are folded strictly in list order, so where files overlap the reading from the file
+	 * listed first is kept. A file is put back in chunk order, merged into one ascending run
+	 * (dropping timestamps it repeats) and bulk-added; only files that are still arriving, or
+	 * waiting on an earlier file, are held as records.
+	 *
+	 * @param  batch - Pointer to the parsed batch (its records are taken over).
+	 * @param  context - Pointer to the LoadProgress.
+	 * @return void
+	 */
+static void foldBatch(RecordBatch* batch, void* context) {
+	LoadProgress* progress = static_cast<LoadProgress*>(context);
+	size_t fileIndex = static_cast<size_t>(batch->fileIndex);
+	if (progress->chunks.size() <= fileIndex) {
+		progress->chunks.resize(fileIndex + 1);
+		progress->chunkCounts.resize(fileIndex + 1, -1);
+	}
+	progress->parsed += batch->records.size();
+	progress->chunks[fileIndex][batch->sequence].swap(batch->records);
+	if (batch->last) progress->chunkCounts[fileIndex] = batch->sequence + 1;
+
+	while (progress->nextFile < progress->chunks.size()) {
+		size_t f = progress->nextFile;
+		long count = progress->chunkCounts[f];
+		if (count < 0 || static_cast<long>(progress->chunks[f].size()) < count) break;
+
+		std::vector<std::vector<WeatherRecord*>> runs(1);
+		for (auto& entry : progress->chunks[f]) {
+			runs[0].insert(runs[0].end(), entry.second.begin(), entry.second.end());
+		}
+		progress->chunks[f].clear();
+
+		std::vector<WeatherRecord*> ordered;
+		progress->duplicates += WeatherDataCollection::mergeSortedRuns(&runs, &ordered);
+		size_t unique = ordered.size();
+		progress->duplicates += unique - static_cast<size_t>(progress->collection->addSortedRecords(&ordered));
+		++progress->nextFile;
+	}
+}
+
+	/**
+	 * @brief Loads weather data from a list of CSV files.
+	 *
+	 * Runs the staged ingest pipeline: a reader thread streams the listed CSVs in
+	 * chunks, parser workers turn chunks into records, and this thread folds each file
+	 * into the columnar base as soon as its last batch arrives (see foldBatch). A file,
+	 * being chronological, is one sorted run, so it needs no sort; addSortedRecords drops
+	 * timestamps already stored by an earlier file, and the load never goes through the
+	 * BST. Peak memory is the base plus the few files in flight, not the parsed archive.
+	 *
+	 * @param  filename - Pointer to the string containing the name of the file listing the CSVs.
+	 * @return void
+	 */
+void WeatherDataCollection::loadFromFiles(std::string* filename) {
+	LoadProgress progress{this, std::vector<std::map<long, std::vector<WeatherRecord*>>>(), std::vector<long>(), 0, 0, 0};
+
+	IngestPipeline pipeline(parseRecord);
+	if (!pipeline.run(filename, foldBatch, &progress)) {
+		std::cerr << "Failed to open file list: " << *filename << std::endl;
+		return;
+	}
+
+	if (progress.parsed == 0) {
+		std::cerr << "No valid records were parsed from files." << std::endl;
+		return;
+	}
+
+	std::cout << "Successfully parsed " << progress.parsed << " records. Merged " << progress.nextFile << " sorted files." << std::endl;
+	if (progress.duplicates > 0) {
+		std::cout << "Dropped " << progress.duplicates << " readings repeated across overlapping files." << std::endl;
+	}
 
 	std::cout << "Data loading complete. Total records in collection: " << getTotalRecords() << std::endl;
 }
@@ -268,7 +1250,7 @@ Date* WeatherDataCollection::parseDate(std::string* dateTimeString) {
 	/**
 	 * @brief Retrieves all weather records for a specific year and month.
 	 *
-	 * Performs a traversal of the BST to collect matching records. Note: The returned
+	 * Scans the month's key range of both tiers to collect the records. Note: The returned
 	 * vector contains *deep copies* of the records to isolate them from the main collection.
 	 *
 	 * @param  year - Pointer to the target year (e.g., 2010).
@@ -277,16 +1259,20 @@ Date* WeatherDataCollection::parseDate(std::string* dateTimeString) {
 	 */
 std::vector<WeatherRecord*>* WeatherDataCollection::getDataForYearMonth(int* year, int* month) const {
 	std::vector<WeatherRecord*>* result = new std::vector<WeatherRecord*>();
+	if (!hasData(year, month)) return result; // Empty bucket: no traversal needed
+
+	result->reserve(getRecordCount(year, month));
 	CollectionContext ctx{result, *month, *year};
-	// Use the traversal with context (function pointer)
-	weatherDataBST->inOrder(collectByYearMonth, &ctx);
+	int from, to;
+	monthRange(*year, *month, &from, &to);
+	forEachInRange(from, to, collectByYearMonth, &ctx);
 	return result;
 }
 
 	/**
 	 * @brief Retrieves all weather records for a specific month across all years.
 	 *
-	 * Performs a traversal of the BST to collect all records matching the month, regardless of year.
+	 * Scans the month's key range of every year that has it (per the presence bitmap), in year order.
 	 * The year parameter in the internal context is set to 0 to indicate all years.
 	 *
 	 * @param  month - Pointer to the target month (1-12).
@@ -298,8 +1284,22 @@ std::vector<WeatherRecord*>* WeatherDataCollection::getDataForMonth(int* month)
 	// Setup context: targetMonth, targetYear=0 (ignored by collectByMonth)
 	CollectionContext* context = new CollectionContext{new std::vector<WeatherRecord*>(), *month, 0};
 
-	// Perform in-order traversal, collecting records matching the month
-	weatherDataBST->inOrder(collectByMonth, context);
+	int allYears = 0;
+	if (!hasData(&allYears, month)) {
+		std::vector<WeatherRecord*>* empty = context->records;
+		delete context;
+		return empty; // No year has this month: no traversal needed
+	}
+	context->records->reserve(getRecordCount(&allYears, month));
+
+	// Scan the month of each year holding it, collecting records matching the month
+	unsigned short bit = static_cast<unsigned short>(1u << (*month - 1));
+	for (const auto& entry : *presenceByYear) {
+		if (!(entry.second.monthMask & bit)) continue;
+		int from, to;
+		monthRange(entry.first, *month, &from, &to);
+		forEachInRange(from, to, collectByMonth, context);
+	}
 
 	std::vector<WeatherRecord*>* results = context->records;
 	delete context; // Clean up the context struct, but not the vector it holds
@@ -310,7 +1310,7 @@ std::vector<WeatherRecord*>* WeatherDataCollection::getDataForMonth(int* month)
 	/**
 	 * @brief Retrieves all weather records for a specific year and month.
 	 *
-	 * This helper is specifically designed to use the collectByYearMonth traversal function.
+	 * This helper is specifically designed to use the collectByYearMonth visitor over the month's key range.
 	 * The returned vector contains *deep copies* of the records.
 	 *
 	 * @param  year - Pointer to the target year.
@@ -323,8 +1323,17 @@ std::vector<WeatherRecord*>* WeatherDataCollection::getDataForSpecificMonthYear(
 	// Setup context: targetMonth and targetYear
 	CollectionContext* context = new CollectionContext{new std::vector<WeatherRecord*>(), *month, *year};
 
-	// Perform in-order traversal, collecting records matching both year and month
-	weatherDataBST->inOrder(collectByYearMonth, context);
+	if (!hasData(year, month)) {
+		std::vector<WeatherRecord*>* empty = context->records;
+		delete context;
+		return empty; // Empty bucket: no traversal needed
+	}
+	context->records->reserve(getRecordCount(year, month));
+
+	// Scan the month's key range, collecting records matching both year and month
+	int from, to;
+	monthRange(*year, *month, &from, &to);
+	forEachInRange(from, to, collectByYearMonth, context);
 
 	std::vector<WeatherRecord*>* results = context->records;
 	delete context;
@@ -336,7 +1345,8 @@ std::vector<WeatherRecord*>* WeatherDataCollection::getDataForSpecificMonthYear(
 	 * @brief Calculates the Sample Pearson Correlation Coefficient (SPCC) between two variables for a given month and year.
 	 *
 	 * Supports calculation across all years for a given month if `year` is 0.
-	 * The correlation type (`S_T`, `S_R`, `T_R`) specifies the variables to compare.
+	 * The correlation type (`S_T`, `S_R`, `T_R`) is mapped to a metric pair once, up front;
+	 * the per-record work is done by the compile-time calculateSPCC<X, Y>.
 	 *
 	 * @param  year - Pointer to the target year (0 for all years).
 	 * @param  month - Pointer to the target month (1-12).
@@ -346,93 +1356,152 @@ std::vector<WeatherRecord*>* WeatherDataCollection::getDataForSpecificMonthYear(
 double WeatherDataCollection::calculateSPCC(int* year, int* month, std::string* type) const {
 	if (!year || !month || !type || *month < 1 || *month > 12) return 0.0;
 
-	std::vector<WeatherRecord*>* records = nullptr;
-
-	// CRITICAL FIX: Check the year to determine data scope
-	if (*year == 0) {
-		// Use the function that aggregates records for the month across ALL years.
-		records = getDataForMonth(month);
-	} else {
-		// Fallback to the original logic for a specific year and month
-		records = getDataForSpecificMonthYear(year, month);
-	}
-
-	if (!records || records->empty()) {
-		std::cerr << "No data available for the requested month/year combination." << std::endl;
+	Metric x, y;
+	if (!parseCorrelationType(type, &x, &y)) {
+		std::cerr << "Invalid correlation type: " << *type << std::endl;
 		return 0.0;
 	}
 
-	// Extract the paired data into vectors x and y
-	std::vector<double> x, y;
+	return calculateSPCC(year, month, x, y);
+}
 
-	if (*type == "S_T") { // Solar Radiation (SR) vs Temperature (T)
-		for (WeatherRecord* r : *records) {
-			x.push_back(r->solarRadiation);
-			y.push_back(r->temperature);
-		}
-	} else if (*type == "S_R") { // Solar Radiation (SR) vs Wind Speed (R is DP/Wind)
-		for (WeatherRecord* r : *records) {
-			x.push_back(r->solarRadiation);
-			y.push_back(r->windSpeed);
-		}
-	} else if (*type == "T_R") { // Temperature (T) vs Wind Speed (R is DP/Wind)
-		for (WeatherRecord* r : *records) {
-			x.push_back(r->temperature);
-			y.push_back(r->windSpeed);
-		}
-	} else {
-		std::cerr << "Invalid correlation type: " << *type << std::endl;
-		return 0.0;
+	/**
+	 * @brief Calculates the SPCC between two metrics selected at runtime.
+	 *
+	 * Looks the pair up in a table of calculateSPCC<X, Y> instantiations, so every
+	 * combination runs its own specialized extraction loop.
+	 *
+	 * @param  year - Pointer to the target year (0 for all years).
+	 * @param  month - Pointer to the target month (1-12).
+	 * @param  x - The first metric.
+	 * @param  y - The second metric.
+	 * @return double - The calculated SPCC value.
+	 */
+double WeatherDataCollection::calculateSPCC(int* year, int* month, Metric x, Metric y) const {
+	typedef double (WeatherDataCollection::*SpccFunction)(int*, int*) const;
+
+	static const SpccFunction table[kMetricCount][kMetricCount] = {
+		{ &WeatherDataCollection::calculateSPCC<Metric::WindSpeed, Metric::WindSpeed>,
+		  &WeatherDataCollection::calculateSPCC<Metric::WindSpeed, Metric::Temperature>,
+		  &WeatherDataCollection::calculateSPCC<Metric::WindSpeed, Metric::SolarRadiation>,
+		  &WeatherDataCollection::calculateSPCC<Metric::WindSpeed, Metric::WindDirection> },
+		{ &WeatherDataCollection::calculateSPCC<Metric::Temperature, Metric::WindSpeed>,
+		  &WeatherDataCollection::calculateSPCC<Metric::Temperature, Metric::Temperature>,
+		  &WeatherDataCollection::calculateSPCC<Metric::Temperature, Metric::SolarRadiation>,
+		  &WeatherDataCollection::calculateSPCC<Metric::Temperature, Metric::WindDirection> },
+		{ &WeatherDataCollection::calculateSPCC<Metric::SolarRadiation, Metric::WindSpeed>,
+		  &WeatherDataCollection::calculateSPCC<Metric::SolarRadiation, Metric::Temperature>,
+		  &WeatherDataCollection::calculateSPCC<Metric::SolarRadiation, Metric::SolarRadiation>,
+		  &WeatherDataCollection::calculateSPCC<Metric::SolarRadiation, Metric::WindDirection> },
+		{ &WeatherDataCollection::calculateSPCC<Metric::WindDirection, Metric::WindSpeed>,
+		  &WeatherDataCollection::calculateSPCC<Metric::WindDirection, Metric::Temperature>,
+		  &WeatherDataCollection::calculateSPCC<Metric::WindDirection, Metric::SolarRadiation>,
+		  &WeatherDataCollection::calculateSPCC<Metric::WindDirection, Metric::WindDirection> }
+	};
+
+	return (this->*table[static_cast<int>(x)][static_cast<int>(y)])(year, month);
+}
+
+	/**
+	 * @brief Estimates a monthly mean from the reservoir samples, or computes it exactly from the column summaries.
+	 *
+	 * The exact path sums summarize() over the month's key range of the year, or of every
+	 * year holding the month, so it reads the whole month but no record is copied. It is
+	 * also taken when removals have left a matching stratum with no samples. Wind direction
+	 * has no linear mean (see isLinearMetric) and returns the empty estimate.
+	 *
+	 * @param  metric - The metric.
+	 * @param  year - Pointer to the target year (0 for all years).
+	 * @param  month - Pointer to the target month (1-12).
+	 * @param  exact - True to use every record.
+	 * @param  confidence - Confidence level of the interval.
+	 * @return Estimate - The mean and its interval.
+	 */
+Estimate WeatherDataCollection::estimateMean(Metric metric, int* year, int* month, bool exact, double confidence) const {
+	Estimate estimate = {0.0, 0.0, 0.0, 0.0, 0, 0, true};
+	if (!year || !month || *month < 1 || *month > 12 || !isLinearMetric(metric)) return estimate;
+	if (!exact) {
+		Estimate sampled = samples->mean(metric, *year, *month, confidence);
+		if (sampled.sampled > 0 || sampled.population == 0) return sampled;
 	}
 
-	// Call the decoupled statistical function
-	double spcc = Statistics::calculateSPCC(&x, &y);
+	double sum = 0.0;
+	unsigned short bit = static_cast<unsigned short>(1u << (*month - 1));
+	for (const auto& entry : *presenceByYear) {
+		if (*year != 0 && entry.first != *year) continue;
+		if (!(entry.second.monthMask & bit)) continue;
+		int from, to;
+		monthRange(entry.first, *month, &from, &to);
+		SeriesSummary summary = summarize(metric, from, to);
+		sum += summary.sum;
+		estimate.population += summary.count;
+	}
+	estimate.sampled = estimate.population;
+	if (estimate.population > 0) estimate.value = sum / estimate.population;
+	estimate.lower = estimate.upper = estimate.value;
+	return estimate;
+}
 
-	// Clean up the temporary vector of deep-copied records (required by getData functions)
-	for (WeatherRecord* rec : *records) {
-		delete rec;
+	/**
+	 * @brief Estimates a monthly SPCC from the reservoir samples, or computes it exactly with calculateSPCC.
+	 *
+	 * The exact path is also taken when removals have left a matching stratum with no samples.
+	 *
+	 * @param  x - The first metric.
+	 * @param  y - The second metric.
+	 * @param  year - Pointer to the target year (0 for all years).
+	 * @param  month - Pointer to the target month (1-12).
+	 * @param  exact - True to use every record.
+	 * @param  confidence - Confidence level of the interval.
+	 * @return Estimate - The coefficient and its interval.
+	 */
+Estimate WeatherDataCollection::estimateSPCC(Metric x, Metric y, int* year, int* month, bool exact, double confidence) const {
+	Estimate estimate = {0.0, 0.0, 0.0, 0.0, 0, 0, true};
+	if (!year || !month || *month < 1 || *month > 12) return estimate;
+	if (!exact) {
+		Estimate sampled = samples->correlation(x, y, *year, *month, confidence);
+		if (sampled.sampled > 0 || sampled.population == 0) return sampled;
 	}
-	delete records;
 
-	return spcc;
+	estimate.population = static_cast<unsigned long>(getRecordCount(year, month));
+	estimate.sampled = estimate.population;
+	if (estimate.population > 0) estimate.value = calculateSPCC(year, month, x, y);
+	estimate.lower = estimate.upper = estimate.value;
+	return estimate;
 }
 
 	/**
 	 * @brief Calculates and displays the average wind speed and standard deviation for a specific year and month.
 	 *
-	 * Retrieves the relevant data and uses the Statistics module for calculation and console output.
+	 * Runs the Statistics module over a view of the month's wind column (base rows plus delta records) for calculation and console output.
 	 *
 	 * @param  year - Pointer to the target year.
 	 * @param  month - Pointer to the target month (1-12).
 	 * @return void
 	 */
 void WeatherDataCollection::displayAverageWindSpeed(int* year, int* month) const {
-	std::vector<WeatherRecord*>* monthData = getDataForYearMonth(year, month);
+	std::vector<ColumnStore::RowRange> rows;
+	std::vector<WeatherRecord*> recent;
+	if (*year >= 1 && hasData(year, month)) monthRows(*year, *month, &rows, &recent);
 
-	if (!monthData || monthData->empty()) {
+	if (rows.empty() && recent.empty()) {
 		std::cout << *month << "/" << *year << ": No Data" << std::endl;
 		return;
 	}
 
-	std::vector<double> winds;
-	for (auto rec : *monthData) winds.push_back(rec->windSpeed);
-
-	std::cout << *month << "/" << *year << ": "
-			  << "Average speed: " << Statistics::calculateMean(&winds)
-			  << " km/h, Sample stdev: " << Statistics::calculateStdDev(&winds)
-			  << std::endl;
-
-	// Clean up the temporary vector of records
-	for (WeatherRecord* rec : *monthData) {
-		delete rec;
-	}
-	delete monthData;
+	visitMetric<Metric::WindSpeed>(&rows, &recent, [month, year](const auto& winds) {
+		std::cout << *month << "/" << *year << ": "
+				  << "Average speed: " << Statistics::calculateMean(&winds)
+				  << " km/h, Sample stdev: " << Statistics::calculateStdDev(&winds)
+				  << std::endl;
+	});
 }
 
 	/**
 	 * @brief Displays the monthly temperature averages, standard deviations, and MADs for a specified year.
 	 *
-	 * Iterates through all 12 months, retrieves data, performs statistical calculations, and outputs the results.
+	 * The populated months (per the presence bitmap) are computed as parallel tasks on
+	 * the shared TaskPool, then printed in calendar order; empty months cost nothing.
 	 *
 	 * @param  year - Pointer to the target year.
 	 * @return void
@@ -441,28 +1510,43 @@ void WeatherDataCollection::displayMonthlyTemperatures(int* year) const {
 	std::string monthNames[12] = {"January","February","March","April","May","June",
 								  "July","August","September","October","November","December"};
 
+	bool monthHasData[12] = {false};
+	double meanTemp[12] = {0.0};
+	double stdTemp[12] = {0.0};
+
+	unsigned short populated = getMonthMask(year);
+
+	TaskGroup group;
+	for (int m = 1; m <= 12; ++m) {
+		if (!(populated & (1u << (m - 1)))) continue; // "No Data" is known from the bitmap
+
+		group.run([this, year, m, &monthHasData, &meanTemp, &stdTemp] {
+			std::vector<ColumnStore::RowRange> rows;
+			std::vector<WeatherRecord*> recent;
+			monthRows(*year, m, &rows, &recent);
+			if (rows.empty() && recent.empty()) return;
+
+			monthHasData[m-1] = true;
+			visitMetric<Metric::Temperature>(&rows, &recent, [m, &meanTemp, &stdTemp](const auto& temps) {
+				meanTemp[m-1] = Statistics::calculateMean(&temps);
+				stdTemp[m-1] = Statistics::calculateStdDev(&temps);
+			});
+		}, "report.monthlyTemperatures");
+	}
+	group.wait();
+
 	std::cout << *year << std::endl;
 
 	for (int m = 1; m <= 12; ++m) {
-		std::vector<WeatherRecord*>* monthData = getDataForYearMonth(year, &m);
-		if (!monthData || monthData->empty()) {
+		if (!monthHasData[m-1]) {
 			std::cout << monthNames[m-1] << ": No Data" << std::endl;
 			continue;
 		}
 
-		std::vector<double> temps;
-		for (auto rec : *monthData) temps.push_back(rec->temperature);
-
 		std::cout << monthNames[m-1] << ": average: "
-				  << Statistics::calculateMean(&temps)
-				  << " degrees C, stdev: " << Statistics::calculateStdDev(&temps)
+				  << meanTemp[m-1]
+				  << " degrees C, stdev: " << stdTemp[m-1]
 				  << std::endl;
-
-		// Clean up the temporary vector of records
-		for (WeatherRecord* rec : *monthData) {
-			delete rec;
-		}
-		delete monthData;
 	}
 }
 
@@ -470,19 +1554,71 @@ void WeatherDataCollection::displayMonthlyTemperatures(int* year) const {
 	 * @brief Generates a CSV file containing monthly statistics for wind speed, temperature, and solar radiation for a specified year.
 	 *
 	 * Calculates mean, standard deviation, and Mean Absolute Deviation (MAD) for wind and temperature,
-	 * and total solar radiation for each month.
+	 * and total solar radiation for each month. Populated months are computed as parallel tasks on the
+	 * shared TaskPool and written in calendar order; empty months are known from the presence bitmap.
 	 *
 	 * @param  year - Pointer to the target year.
 	 * @param  filename - Pointer to the output filename (e.g., "WindTempSolar.csv").
 	 * @return void
 	 */
 void WeatherDataCollection::generateMonthlyStats(int* year, std::string* filename) const {
-	std::string monthNames[12] = {"January","February","March","April","May","June",
-								  "July","August","September","October","November","December"};
-
 	std::ofstream out(*filename);
 	if (!out.is_open()) return;
 
+	MonthlyStatsRow rows[12] = {};
+
+	unsigned short populated = getMonthMask(year);
+
+	TaskGroup group;
+	for (int m = 1; m <= 12; ++m) {
+		if (!(populated & (1u << (m - 1)))) continue; // "No Data" is known from the bitmap
+
+		group.run([this, year, m, &rows] {
+			// The kernels read each column where it is stored; nothing is gathered
+			std::vector<ColumnStore::RowRange> located;
+			std::vector<WeatherRecord*> recent;
+			monthRows(*year, m, &located, &recent);
+			if (located.empty() && recent.empty()) return;
+
+			MonthlyStatsRow& row = rows[m-1];
+			row.hasData = true;
+			visitMetric<Metric::WindSpeed>(&located, &recent, [&row](const auto& winds) {
+				row.meanWind = Statistics::calculateMean(&winds);
+				row.stdWind = Statistics::calculateStdDev(&winds);
+				row.madWind = Statistics::calculateMAD(&winds);
+			});
+			visitMetric<Metric::Temperature>(&located, &recent, [&row](const auto& temps) {
+				row.meanTemp = Statistics::calculateMean(&temps);
+				row.stdTemp = Statistics::calculateStdDev(&temps);
+				row.madTemp = Statistics::calculateMAD(&temps);
+			});
+			visitMetric<Metric::SolarRadiation>(&located, &recent, [&row](const auto& solar) {
+				row.totalSolar = 0.0;
+				for (size_t i = 0; i < solar.size(); ++i) row.totalSolar += solar[i];
+			});
+		}, "report.monthlyStats");
+	}
+	group.wait();
+
+	writeMonthlyStats(&out, year, rows);
+	out.close();
+}
+
+	/**
+	 * @brief Writes the twelve monthly rows of the WindTempSolar report in CSV format.
+	 *
+	 * Shared by the in-memory report and the streaming aggregator so both produce identical files.
+	 *
+	 * @param  stream - Pointer to the output stream.
+	 * @param  year - Pointer to the report year.
+	 * @param  rows - Array of 12 rows, January first.
+	 * @return void
+	 */
+void WeatherDataCollection::writeMonthlyStats(std::ostream* stream, int* year, const MonthlyStatsRow* rows) {
+	std::string monthNames[12] = {"January","February","March","April","May","June",
+								  "July","August","September","October","November","December"};
+	std::ostream& out = *stream;
+
 	// 1. CSV Metadata Line (Optional, for year identification)
 	out << "Year," << *year << "\n";
 
@@ -490,56 +1626,74 @@ void WeatherDataCollection::generateMonthlyStats(int* year, std::string* filenam
 	out << "Month,Avg_Wind(StdDev,MAD),Avg_Temp(StdDev,MAD),Total_Solar_Radiation\n";
 
 	for (int m = 1; m <= 12; ++m) {
-		// NOTE: Assuming getDataForYearMonth is correctly implemented to call
-		// getDataForSpecificMonthYear or equivalent and returns a vector of *deep copies*.
-		std::vector<WeatherRecord*>* monthData = getDataForYearMonth(year, &m);
+		const MonthlyStatsRow& row = rows[m-1];
 
-		if (!monthData || monthData->empty()) {
+		if (!row.hasData) {
 			// Write the "No Data" line, still in a CSV format
 			out << monthNames[m-1] << ",No Data,,,\n"; // Use extra commas to fill expected columns
 			continue;
 		}
 
-		std::vector<double> winds, temps, solars;
-		for (auto r : *monthData) {
-			winds.push_back(r->windSpeed);
-			temps.push_back(r->temperature);
-			solars.push_back(r->solarRadiation);
-		}
-
-		double meanWind = Statistics::calculateMean(&winds);
-		double stdWind	= Statistics::calculateStdDev(&winds);
-		double madWind	= Statistics::calculateMAD(&winds);
-
-		double meanTemp = Statistics::calculateMean(&temps);
-		double stdTemp	= Statistics::calculateStdDev(&temps);
-		double madTemp	= Statistics::calculateMAD(&temps);
-
-		double totalSolar = std::accumulate(solars.begin(), solars.end(), 0.0);
-
 		// 3. Write the data row (already comma-separated)
 		out << monthNames[m-1] << ","
-			<< meanWind << "(" << stdWind << "," << madWind << "),"
-			<< meanTemp << "(" << stdTemp << "," << madTemp << "),"
-			<< totalSolar << "\n";
-
-		// Clean up the temporary vector of records (necessary for deep copies)
-		for (WeatherRecord* rec : *monthData) {
-			delete rec;
-		}
-		delete monthData;
+			<< row.meanWind << "(" << row.stdWind << "," << row.madWind << "),"
+			<< row.meanTemp << "(" << row.stdTemp << "," << row.madTemp << "),"
+			<< row.totalSolar << "\n";
 	}
-
-	out.close();
 }
 
 	/**
 	 * @brief Returns the total number of weather records stored in the collection.
 	 *
-	 * Calls the size() method of the internal BST.
+	 * Adds the base row count to the delta record count.
 	 *
 	 * @return int - The total number of records.
 	 */
 int WeatherDataCollection::getTotalRecords() const {
-	return weatherDataBST->size();
+	return static_cast<int>(base ? base->size() : 0) + getDeltaRecordCount();
+}
+
+	/**
+	 * @brief Traversal helper that appends one metric of a record to a compressed series.
+	 *
+	 * @param  record - Pointer to the current WeatherRecord.
+	 * @param  context - Pointer to the CompressedSeries being built.
+	 * @return void
+	 */
+template <Metric M>
+static void appendToSeries(const WeatherRecord* record, void* context) {
+	static_cast<CompressedSeries*>(context)->append(record->date->toMinuteKey(), MetricColumn<M>::get(record));
+}
+
+	/**
+	 * @brief Builds a compressed series of one metric from a date-ordered scan of both tiers.
+	 *
+	 * @param  metric - The column to copy.
+	 * @return CompressedSeries* - Pointer to the new, sealed series. Caller must delete it.
+	 */
+CompressedSeries* WeatherDataCollection::buildCompressedSeries(Metric metric) const {
+	typedef void (*SeriesVisitor)(const WeatherRecord*, void*);
+	static const SeriesVisitor visitors[kMetricCount] = {
+		appendToSeries<Metric::WindSpeed>,
+		appendToSeries<Metric::Temperature>,
+		appendToSeries<Metric::SolarRadiation>,
+		appendToSeries<Metric::WindDirection>
+	};
+
+	CompressedSeries* series = new CompressedSeries();
+	forEachInRange(std::numeric_limits<int>::min(), std::numeric_limits<int>::max(),
+				   visitors[static_cast<int>(metric)], series);
+	series->seal();
+	return series;
+}
+
+	/**
+	 * @brief Builds a column store holding the base rows merged with the delta records.
+	 *
+	 * @return ColumnStore* - Pointer to the new store. Caller must delete it.
+	 */
+ColumnStore* WeatherDataCollection::buildColumnStore() const {
+	std::vector<WeatherRecord*> recent;
+	collectDelta(std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), &recent);
+	return new ColumnStore(base.get(), &recent);
 }
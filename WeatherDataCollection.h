@@ -1,40 +1,133 @@
 #ifndef WEATHERDATACOLLECTION_H
 #define WEATHERDATACOLLECTION_H
 
-#include "Bst.h"
+#include "PersistentBst.h"
+#include "ClimatologyIndex.h"
+#include "ColumnStore.h"
+#include "CompressedSeries.h"
 #include "Map.h"
+#include "Metric.h"
+#include "ReservoirSampler.h"
+#include "Shared.h"
 #include "WeatherRecord.h"
 #include "Statistics.h"
+#include "TaskPool.h"
+#include <atomic>
 #include <string>
 #include <vector>
 
+/**
+ * @struct MonthlyStatsRow
+ * @brief One month of the WindTempSolar report.
+ */
+struct MonthlyStatsRow {
+	bool hasData;                       ///< False if the month has no records.
+	double meanWind, stdWind, madWind;  ///< Wind speed mean, sample standard deviation and mean absolute deviation.
+	double meanTemp, stdTemp, madTemp;  ///< Temperature mean, sample standard deviation and mean absolute deviation.
+	double totalSolar;                  ///< Sum of the solar radiation readings.
+};
+
 /**
  * @class WeatherDataCollection
- * @brief Collection of weather data with BST storage and month mapping.
+ * @brief Collection of weather data with tiered (columnar base + BST delta) storage and month mapping.
  *
- * This class manages weather data records, storing them in a Binary Search Tree (BST)
- * sorted by date, and additionally maintaining a map for quick access by month.
- * It provides functionality for loading data, performing statistical calculations,
- * and generating reports.
+ * Records live in two tiers, in the manner of a log-structured merge tree. The
+ * historical bulk sits in an immutable, sorted ColumnStore (the base); records added
+ * one at a time go into a small persistent Binary Search Tree (the delta), so appends
+ * stay cheap. Copies share the base and the delta's nodes (see Shared and PersistentBst),
+ * so copying a collection copies neither its rows nor its delta records. Once the delta holds compactionThreshold records it is frozen and a
+ * TaskPool task folds it into a new base while appends continue into a fresh delta;
+ * the new base is swapped in by the next modifying call. Queries merge the tiers in
+ * date order (see forEachInRange), and range scans of the base are binary-searched
+ * and decoded column by column.
+ *
+ * A month map of the delta records and per-year presence and climatology indexes are
+ * maintained alongside. The class provides functionality for loading data,
+ * performing statistical calculations, and generating reports.
  */
 class WeatherDataCollection {
 private:
 	/**
-	 * @brief Binary search tree containing all WeatherRecord objects, ordered by date.
+	 * @brief Immutable, date-ordered columnar tier holding the compacted (historical) records.
+	 * Shared by copies of the collection; a change installs a new store rather than editing it.
+	 */
+	Shared<ColumnStore> base; ///< Compacted tier (empty until the first compaction)
+
+	/**
+	 * @brief Binary search tree of the records added since the last compaction, ordered by date.
+	 */
+	PersistentBst<WeatherRecord>* weatherDataBST; ///< Mutable delta tier
+
+	/**
+	 * @brief Former delta being folded into the base by a background compaction (nullptr when none is running).
+	 */
+	PersistentBst<WeatherRecord>* frozenDelta; ///< Delta under compaction
+
+	/**
+	 * @brief The base produced by the running compaction. Written by the compaction task only.
+	 */
+	Shared<ColumnStore> compactedBase; ///< Result of the running compaction
+
+	/**
+	 * @brief The running compaction task (nullptr when none is running).
+	 */
+	TaskGroup* compaction; ///< Background compaction
+
+	/**
+	 * @brief Set by the compaction task once compactedBase is complete.
+	 */
+	std::atomic<bool> compactionDone; ///< Compaction finished flag
+
+	/**
+	 * @brief Number of records in weatherDataBST.
+	 */
+	int deltaCount; ///< Records in the delta tier
+
+	/**
+	 * @brief Delta size that triggers a background compaction (0 disables automatic compaction).
 	 */
-	Bst<WeatherRecord>* weatherDataBST; ///< Binary search tree of all records
+	int compactionThreshold; ///< Records per delta before compaction
 
 	/**
-	 * @brief Map where the key is the month (1-12) and the value is a vector of pointers
-	 * to WeatherRecord objects that occurred in that month.
+	 * @struct YearPresence
+	 * @brief Which months of one year hold records, and how many.
 	 */
-	Map<int, std::vector<WeatherRecord*>>* dataByMonth; ///< Map of month to records
+	struct YearPresence {
+		unsigned short monthMask; ///< Bit m-1 is set when month m has at least one record.
+		int counts[12];           ///< Number of records per month, January first.
+	};
+
+	/**
+	 * @brief Map where the key is the year and the value records which of its months hold data
+	 * (in either tier). Maintained on insert, so empty (year, month) buckets are answered without a traversal.
+	 */
+	Map<int, YearPresence>* presenceByYear; ///< Map of year to month presence
+
+	/**
+	 * @brief Normals per (day-of-year, hour) across all years, maintained on insert.
+	 */
+	ClimatologyIndex* climatology; ///< Day/hour climatology of all records
+
+	/**
+	 * @brief Reservoir samples per (year, month), maintained on insert, for approximate answers.
+	 */
+	ReservoirSampler* samples; ///< Stratified samples of all records
 
 public:
+	/**
+	 * @brief Default delta size that triggers a background compaction (about two weeks of 10-minute readings).
+	 */
+	static const int kDefaultCompactionThreshold = 2048;
+
+	/**
+	 * @brief Function applied to each record of a range scan.
+	 */
+	typedef void (*RecordVisitor)(const WeatherRecord* record, void* context);
+
 	/**
 	 * @brief Default constructor.
 	 *
-	 * Initializes the internal BST and Map structures.
+	 * Initializes an empty base, the delta BST and the Map structures.
 	 */
 	WeatherDataCollection();
 
@@ -61,15 +154,237 @@ public:
 	/**
 	 * @brief Adds a single weather record to the collection.
 	 *
-	 * Inserts the record into the BST and updates the dataByMonth map.
-	 * @param record A pointer to the WeatherRecord to add.
+	 * Inserts the record into the delta BST and updates the presence bitmap, the climatology
+	 * and the samples, then starts a background compaction if the delta is full.
+	 * A record whose date and time are already present in either tier is deleted instead.
+	 * @param record A pointer to the WeatherRecord to add (ownership is taken).
+	 * @return bool True if the record was added, false if it was a duplicate.
+	 */
+	bool addWeatherRecord(WeatherRecord* record);
+
+	/**
+	 * @brief Adds many records in one merge into the columnar base, bypassing the delta BST.
+	 *
+	 * Used for bulk loads, snapshots and log replay. The records need not be sorted; a record
+	 * whose date and time are already present (or repeated within the batch) is deleted.
+	 * @param records A pointer to the records (ownership is taken; the vector is cleared).
+	 * @return int The number of records added.
+	 */
+	int addWeatherRecords(std::vector<WeatherRecord*>* records);
+
+	/**
+	 * @brief Adds records that are already in strictly ascending date order, without sorting them.
+	 *
+	 * The bulk-build step of addWeatherRecords and loadFromFiles. A record whose date and time
+	 * are already stored is deleted.
+	 * @param records A pointer to the records, strictly ascending (ownership is taken; the vector is cleared).
+	 * @return int The number of records added.
+	 */
+	int addSortedRecords(std::vector<WeatherRecord*>* records);
+
+	/**
+	 * @brief Merges sorted runs of records into one ascending stream with one record per timestamp.
+	 *
+	 * Each maximal ascending stretch of each input vector is a run; the runs are merged with a
+	 * min-heap keyed by (timestamp, run order), so the cost is O(n log k) for k runs and input
+	 * that is already sorted per file needs no global sort. Unordered input (many short runs)
+	 * is radix sorted on its packed minute keys instead (see RadixSort). Of several records
+	 * with one timestamp the first in input order is kept and the others are deleted.
+	 * @param runs A pointer to the input vectors, in priority order (ownership of the records is taken; the vectors are cleared).
+	 * @param out Receives the merged records (appended).
+	 * @return size_t The number of duplicate records dropped.
+	 */
+	static size_t mergeSortedRuns(std::vector<std::vector<WeatherRecord*>>* runs, std::vector<WeatherRecord*>* out);
+
+	/**
+	 * @brief Replaces the contents of the collection with the rows of a column store (e.g. a snapshot).
+	 * @param store A pointer to the store (ownership is taken).
+	 */
+	void loadColumnStore(ColumnStore* store);
+
+	/**
+	 * @brief Removes every record with from <= minute key <= to, from both tiers, and frees it.
+	 *
+	 * The delta tree is split around the range and the cut-out subtree released whole; the
+	 * base is rebuilt without the range's rows by copying the column slices either side of it.
+	 * The month, presence and climatology indexes are updated for the removed records only.
+	 * @param from The first minute key of the range (see Date::toMinuteKey).
+	 * @param to The last minute key of the range (inclusive).
+	 * @return int The number of records removed.
+	 */
+	int eraseRange(int from, int to);
+
+	/**
+	 * @brief Retention: removes every record dated before a date.
+	 * @param date A constant pointer to the first date to keep.
+	 * @return int The number of records removed.
+	 */
+	int eraseBefore(const Date* date);
+
+	/**
+	 * @brief Retention: removes every record of one year.
+	 * @param year The year.
+	 * @return int The number of records removed.
+	 */
+	int eraseYear(int year);
+
+	/**
+	 * @brief Checks whether any record exists for a year and month, without traversing the tree.
+	 * @param year A pointer to the year (0 for any year).
+	 * @param month A pointer to the month (1-12).
+	 * @return bool True if at least one record exists.
+	 */
+	bool hasData(int* year, int* month) const;
+
+	/**
+	 * @brief Gets the number of records for a year and month, without traversing the tree.
+	 * @param year A pointer to the year (0 for all years).
+	 * @param month A pointer to the month (1-12).
+	 * @return int The record count.
+	 */
+	int getRecordCount(int* year, int* month) const;
+
+	/**
+	 * @brief Gets the months of a year that hold records.
+	 * @param year A pointer to the year.
+	 * @return unsigned short A bitmap with bit m-1 set when month m has records.
+	 */
+	unsigned short getMonthMask(int* year) const;
+
+	/**
+	 * @brief Gets the day-of-year/hour climatology of the stored records.
+	 *
+	 * Answers "what is normal for this day and hour" and anomaly questions in constant time.
+	 * @return const ClimatologyIndex* A pointer to the index (owned by the collection).
+	 */
+	const ClimatologyIndex* getClimatology() const { return climatology; }
+
+	/**
+	 * @brief Gets the stratified reservoir samples of the stored records.
+	 * @return const ReservoirSampler* A pointer to the sampler (owned by the collection).
+	 */
+	const ReservoirSampler* getSamples() const { return samples; }
+
+	/**
+	 * @brief Visits every record with from <= minute key <= to, in date order, across both tiers.
+	 *
+	 * Base rows are decoded into a scratch record, so the pointer passed to visit is only
+	 * valid during the call; copy the record to keep it.
+	 * @param from The first minute key of the range (see Date::toMinuteKey).
+	 * @param to The last minute key of the range (inclusive).
+	 * @param visit The function applied to each record.
+	 * @param context Opaque pointer passed to visit.
+	 */
+	void forEachInRange(int from, int to, RecordVisitor visit, void* context) const;
+
+	/**
+	 * @brief Copies one metric over a minute-key range, with its keys, into two parallel vectors in date order.
+	 *
+	 * The base contributes whole column slices; delta records are merged in. Used to line up
+	 * two collections (see MergeJoin) without building record objects.
+	 * @param metric The metric.
+	 * @param from The first minute key of the range.
+	 * @param to The last minute key of the range (inclusive).
+	 * @param keys Receives the minute keys, ascending (overwritten).
+	 * @param values Receives the values (overwritten).
+	 */
+	void copySeries(Metric metric, int from, int to, std::vector<int>* keys, std::vector<double>* values) const;
+
+	/**
+	 * @brief Finds the latest record at or before a minute key (e.g. "the reading at or just before 14:07").
+	 *
+	 * Each tier is searched by key in O(log n); no probe record is built.
+	 * @param key The minute key (see Date::toMinuteKey).
+	 * @param out A pointer to a record that receives the date and readings (its Date is reused).
+	 * @return bool False if no record is that early (out is left unchanged).
+	 */
+	bool findFloor(int key, WeatherRecord* out) const;
+
+	/**
+	 * @brief Finds the earliest record at or after a minute key.
+	 * @param key The minute key.
+	 * @param out A pointer to a record that receives the date and readings.
+	 * @return bool False if no record is that late (out is left unchanged).
+	 */
+	bool findCeil(int key, WeatherRecord* out) const;
+
+	/**
+	 * @brief Finds the record closest in time to a minute key (the earlier one on a tie).
+	 * @param key The minute key.
+	 * @param out A pointer to a record that receives the date and readings.
+	 * @return bool False if the collection is empty.
+	 */
+	bool findNearest(int key, WeatherRecord* out) const;
+
+	/**
+	 * @brief Finds the floor record of each of an ascending run of minute keys.
+	 *
+	 * The delta trees resolve the whole batch in one shared descent and the base is searched
+	 * forward from the previous key's row, instead of one independent search per key.
+	 * As with forEachInRange, the results are passed through one scratch record, so the
+	 * pointer given to visit is only valid during the call.
+	 * @param keys A constant pointer to the minute keys, ascending.
+	 * @param visit The function called once per key, in order, with its floor record (nullptr if no record is that early).
+	 * @param context Opaque pointer passed to visit.
+	 * @return size_t The number of keys that have a floor.
 	 */
-	void addWeatherRecord(WeatherRecord* record);
+	size_t findFloorBatch(const std::vector<int>* keys, RecordVisitor visit, void* context) const;
+
+	/**
+	 * @brief Aggregates one metric over a minute-key range, merging both tiers.
+	 *
+	 * The base contributes through its columnar summary, so the cost is dominated by the range
+	 * length in narrow column values rather than by record objects.
+	 * @param metric The metric.
+	 * @param from The first minute key of the range.
+	 * @param to The last minute key of the range (inclusive).
+	 * @return SeriesSummary The aggregates.
+	 */
+	SeriesSummary summarize(Metric metric, int from, int to) const;
+
+	/**
+	 * @brief Folds the delta (and any running compaction) into the base and waits until it is done.
+	 */
+	void compact();
+
+	/**
+	 * @brief Freezes the delta and starts folding it into the base on the TaskPool.
+	 *
+	 * Appends continue into a new, empty delta; the new base replaces the old one on the next
+	 * modifying call after the task completes. Does nothing if the delta is empty or a compaction
+	 * is already running.
+	 * @return bool True if a compaction was started.
+	 */
+	bool startCompaction();
+
+	/**
+	 * @brief Checks whether a background compaction has been started and not yet installed.
+	 * @return bool True while a compaction is pending.
+	 */
+	bool isCompacting() const { return compaction != nullptr; }
+
+	/**
+	 * @brief Sets the delta size that triggers a background compaction.
+	 * @param records The threshold (0 to compact only on request).
+	 */
+	void setCompactionThreshold(int records) { compactionThreshold = records; }
+
+	/**
+	 * @brief Gets the number of records in the mutable tiers (the delta and a delta under compaction).
+	 * @return int The record count.
+	 */
+	int getDeltaRecordCount() const;
+
+	/**
+	 * @brief Gets the compacted, columnar tier.
+	 * @return const ColumnStore* A pointer to the base (owned by the collection), or nullptr if nothing has been compacted.
+	 */
+	const ColumnStore* getBase() const { return base.get(); }
 
 	/**
 	 * @brief Loads weather data from a file specified by the filename.
 	 *
-	 * Reads, parses, and adds each record to the collection.
+	 * Reads and parses the files in parallel, folding each file into the base tier as soon as it has been parsed.
 	 * @param filename A constant pointer to the string containing the path to the data file.
 	 */
 	void loadFromFiles(std::string* filename);
@@ -108,6 +423,61 @@ public:
 	 */
 	double calculateSPCC(int* year, int* month, std::string* type) const;
 
+	/**
+	 * @brief Calculates the SPCC between two metrics chosen at runtime.
+	 *
+	 * Dispatches through a table to the matching calculateSPCC<X, Y> instantiation.
+	 * @param year A constant pointer to the integer representing the year (0 for all years).
+	 * @param month A constant pointer to the integer representing the month (1-12).
+	 * @param x The first metric.
+	 * @param y The second metric.
+	 * @return double The calculated SPCC value.
+	 */
+	double calculateSPCC(int* year, int* month, Metric x, Metric y) const;
+
+	/**
+	 * @brief Calculates the SPCC between two metrics chosen at compile time.
+	 *
+	 * The kernel runs over views of the two columns: X and Y pick the base columns, whose
+	 * encodings are resolved once per call, and the delta records are read through the
+	 * inlined MetricColumn<X> and MetricColumn<Y> accessors. Nothing is gathered first.
+	 * @tparam X The first metric.
+	 * @tparam Y The second metric.
+	 * @param year A constant pointer to the integer representing the year (0 for all years).
+	 * @param month A constant pointer to the integer representing the month (1-12).
+	 * @return double The calculated SPCC value, or 0.0 if there is no data.
+	 */
+	template <Metric X, Metric Y>
+	double calculateSPCC(int* year, int* month) const;
+
+	/**
+	 * @brief Estimates the mean of a metric for a month, from the reservoir samples or exactly.
+	 *
+	 * The approximate answer reads only the samples of the matching (year, month) strata, so
+	 * its cost does not grow with the archive; exact scans every matching record, and is also
+	 * used when removals have left a matching stratum without samples. Wind direction is
+	 * not supported (see isLinearMetric) and gives the empty estimate.
+	 * @param metric The metric.
+	 * @param year A pointer to the year (0 for all years).
+	 * @param month A pointer to the month (1-12).
+	 * @param exact True to compute from every record, with a zero-width interval.
+	 * @param confidence The confidence level of the interval (e.g. 0.95).
+	 * @return Estimate The mean, its interval and the readings behind it.
+	 */
+	Estimate estimateMean(Metric metric, int* year, int* month, bool exact = false, double confidence = 0.95) const;
+
+	/**
+	 * @brief Estimates the SPCC between two metrics for a month, from the reservoir samples or exactly.
+	 * @param x The first metric.
+	 * @param y The second metric.
+	 * @param year A pointer to the year (0 for all years).
+	 * @param month A pointer to the month (1-12).
+	 * @param exact True to compute with calculateSPCC, with a zero-width interval.
+	 * @param confidence The confidence level of the interval (e.g. 0.95).
+	 * @return Estimate The coefficient, its interval and the readings behind it.
+	 */
+	Estimate estimateSPCC(Metric x, Metric y, int* year, int* month, bool exact = false, double confidence = 0.95) const;
+
 	/**
 	 * @brief Displays the average wind speed and its standard deviation for a given year and month.
 	 * @param year A constant pointer to the integer representing the year.
@@ -129,7 +499,15 @@ public:
 	void generateMonthlyStats(int* year, std::string* filename) const;
 
 	/**
-	 * @brief Displays all weather data records stored in the collection (typically using an inorder traversal of the BST).
+	 * @brief Writes the monthly statistics report for one year in CSV format.
+	 * @param stream A pointer to the output stream.
+	 * @param year A pointer to the report year.
+	 * @param rows An array of the 12 monthly rows, January first.
+	 */
+	static void writeMonthlyStats(std::ostream* stream, int* year, const MonthlyStatsRow* rows);
+
+	/**
+	 * @brief Displays all weather data records stored in the collection, in date order.
 	 */
 	void displayAllData() const;
 
@@ -139,6 +517,34 @@ public:
 	 */
 	int getTotalRecords() const;
 
+	/**
+	 * @brief Builds a compressed, time-ordered copy of one metric column.
+	 *
+	 * The series is independent of the collection and can be queried by minute-key
+	 * range (see Date::toMinuteKey) at a fraction of the memory of the records.
+	 * @param metric The column to copy.
+	 * @return CompressedSeries* A pointer to the new, sealed series. Caller must delete it.
+	 */
+	CompressedSeries* buildCompressedSeries(Metric metric) const;
+
+	/**
+	 * @brief Builds a compact, immutable column copy of every record (both tiers), in date order.
+	 *
+	 * Takes a fraction of the memory of the heap records while decoding to the same values.
+	 * @return ColumnStore* A pointer to the new store. Caller must delete it.
+	 */
+	ColumnStore* buildColumnStore() const;
+
+	/**
+	 * @brief Parses one CSV data line into a new WeatherRecord.
+	 *
+	 * Safe to call from several threads at once; used by the ingest pipeline's parser workers.
+	 * @param line A pointer to the raw data string line.
+	 * @param layout The column positions of the line's file (see CsvLayout::fromHeader), or nullptr for the standard layout.
+	 * @return WeatherRecord* A pointer to the new record, or nullptr if the line is malformed.
+	 */
+	static WeatherRecord* parseRecord(std::string* line, const CsvLayout* layout = nullptr);
+
 private:
 	/**
 	 * @brief Internal helper function to parse a single line of raw data and create a WeatherRecord.
@@ -151,7 +557,151 @@ private:
 	 * @param dateTimeString A pointer to the raw date/time string.
 	 * @return Date* A pointer to the newly created Date object.
 	 */
-	Date* parseDate(std::string* dateTimeString);
+	static Date* parseDate(std::string* dateTimeString);
+
+	/**
+	 * @brief Internal helper that files a record in presenceByYear, climatology and samples.
+	 * @param record A pointer to the record.
+	 */
+	void indexRecord(const WeatherRecord* record);
+
+	/**
+	 * @brief Internal helper that takes a removed record back out of presenceByYear, climatology and samples.
+	 * @param record A pointer to the record.
+	 */
+	void unindexRecord(const WeatherRecord* record);
+
+	/**
+	 * @brief Checks whether either tier already holds a record with the same date and time.
+	 * @param record A pointer to the probe record.
+	 * @return bool True if the timestamp is taken.
+	 */
+	bool containsDate(WeatherRecord* record) const;
+
+	/**
+	 * @brief Collects the delta-tier records with from <= minute key <= to, in date order.
+	 * @param from The first minute key.
+	 * @param to The last minute key (inclusive).
+	 * @param out Receives the record pointers (owned by the delta trees).
+	 */
+	void collectDelta(int from, int to, std::vector<WeatherRecord*>* out) const;
+
+	/**
+	 * @brief Finds the floor or ceiling of a minute key across the tiers.
+	 * @param key The minute key.
+	 * @param below True for the floor, false for the ceiling.
+	 * @param foundKey Receives the key of the record found.
+	 * @param record Receives the delta record found, or nullptr if it is a base row.
+	 * @param row Receives the base row found (when record is nullptr).
+	 * @return bool False if there is no such record.
+	 */
+	bool locate(int key, bool below, int* foundKey, const WeatherRecord** record, size_t* row) const;
+
+	/**
+	 * @brief Copies the date and readings of a delta record or base row into a record.
+	 * @param key The minute key of the source.
+	 * @param record The delta record, or nullptr to read base row row.
+	 * @param row The base row.
+	 * @param out The record to fill (its Date is reused).
+	 */
+	void readInto(int key, const WeatherRecord* record, size_t row, WeatherRecord* out) const;
+
+	/**
+	 * @brief Waits for the running compaction task, if any, to finish (does not install its result).
+	 */
+	void waitForCompaction() const;
+
+	/**
+	 * @brief Installs the result of a completed compaction: replaces the base and frees the frozen delta.
+	 * @param block True to wait for a running compaction, false to return if it has not finished.
+	 */
+	void finishCompaction(bool block);
+
+	/**
+	 * @brief Builds a new base holding the rows of an old base and the records of a delta tree.
+	 * @param oldBase A constant pointer to the old base (may be nullptr).
+	 * @param delta A constant pointer to the delta tree.
+	 * @return ColumnStore* A pointer to the new base. Caller must delete it.
+	 */
+	static ColumnStore* foldDelta(const ColumnStore* oldBase, const PersistentBst<WeatherRecord>* delta);
+
+	/**
+	 * @brief Computes the minute-key range of a year and month.
+	 * @param year The year.
+	 * @param month The month (1-12).
+	 * @param from Receives the key of the first minute of the month.
+	 * @param to Receives the key of the last minute of the month.
+	 */
+	static void monthRange(int year, int month, int* from, int* to);
+
+	/**
+	 * @brief Locates a month's rows: its base row ranges and its delta records.
+	 * @param year The year (0 for every year holding the month, in year order).
+	 * @param month The month (1-12).
+	 * @param rows Receives the base row ranges.
+	 * @param recent Receives the delta records, in date order (owned by the delta trees).
+	 */
+	void monthRows(int year, int month, std::vector<ColumnStore::RowRange>* rows, std::vector<WeatherRecord*>* recent) const;
+
+	/**
+	 * @brief Passes a view of one metric over located rows to a callable: the base rows, then the delta records.
+	 * @tparam M The metric.
+	 * @param rows A constant pointer to the base row ranges (see monthRows).
+	 * @param recent A constant pointer to the delta records.
+	 * @param visit Called once as visit(view) with a Statistics::ConcatView of a ColumnStore::ColumnView and a projection of the records.
+	 */
+	template <Metric M, class Visit>
+	void visitMetric(const std::vector<ColumnStore::RowRange>* rows, const std::vector<WeatherRecord*>* recent, Visit visit) const;
 };
 
+// Template implementation
+
+/**
+ * @brief Compile-time metric SPCC implementation.
+ * @param year The target year (0 for all years).
+ * @param month The target month (1-12).
+ * @return double The SPCC value.
+ */
+template <Metric X, Metric Y>
+double WeatherDataCollection::calculateSPCC(int* year, int* month) const {
+	if (!year || !month || *month < 1 || *month > 12) return 0.0;
+
+	std::vector<ColumnStore::RowRange> rows;
+	std::vector<WeatherRecord*> recent;
+	if (*year >= 0) monthRows(*year, *month, &rows, &recent);
+
+	if (rows.empty() && recent.empty()) {
+		std::cerr << "No data available for the requested month/year combination." << std::endl;
+		return 0.0;
+	}
+
+	// The kernel reads both columns where they are stored; nothing is gathered
+	double spcc = 0.0;
+	visitMetric<X>(&rows, &recent, [&](const auto& x) {
+		visitMetric<Y>(&rows, &recent, [&](const auto& y) { spcc = Statistics::calculateSPCC(&x, &y); });
+	});
+	return spcc;
+}
+
+/**
+ * @brief Builds the base column view and the delta projection of a metric and passes their concatenation on.
+ * @param rows The base row ranges.
+ * @param recent The delta records.
+ * @param visit The callable.
+ */
+template <Metric M, class Visit>
+void WeatherDataCollection::visitMetric(const std::vector<ColumnStore::RowRange>* rows, const std::vector<WeatherRecord*>* recent,
+										Visit visit) const {
+	auto delta = Statistics::project(recent, &MetricColumn<M>::get);
+	auto withDelta = [&delta, &visit](const auto& column) {
+		auto view = Statistics::concat(&column, &delta);
+		visit(view);
+	};
+	if (base) {
+		base->visitColumn(M, rows, withDelta);
+	} else {
+		withDelta(ColumnStore::ColumnView<double, false>(nullptr, 1.0, rows));
+	}
+}
+
 #endif
@@ -0,0 +1,273 @@
+// WeatherDataStore.cpp
+
+// Implements the WeatherDataStore class: copy-on-publish versions of the weather
+// collection, lock-free reader pinning and epoch-based reclamation of retired versions.
+
+#include "WeatherDataStore.h"
+#include <functional>
+#include <iostream>
+#include <thread>
+
+	/**
+	 * @brief Constructs a guard over an already announced reader slot.
+	 *
+	 * @param  s - The slot holding the reader's announced epoch.
+	 * @param  snap - The snapshot loaded after the announcement.
+	 * @param  v - The version number of the snapshot.
+	 * @return void
+	 */
+WeatherDataStore::ReadGuard::ReadGuard(std::atomic<unsigned long>* s, const WeatherDataCollection* snap, unsigned long v)
+	: slot(s), snapshot(snap), version(v) {}
+
+	/**
+	 * @brief Move constructor. Transfers the pinned slot to the new guard.
+	 *
+	 * @param  other - The guard to take over.
+	 * @return void
+	 */
+WeatherDataStore::ReadGuard::ReadGuard(ReadGuard&& other)
+	: slot(other.slot), snapshot(other.snapshot), version(other.version) {
+	other.slot = nullptr;
+}
+
+	/**
+	 * @brief Destructor. Marks the reader slot as free so the snapshot can be reclaimed.
+	 *
+	 * @return void
+	 */
+WeatherDataStore::ReadGuard::~ReadGuard() {
+	if (slot != nullptr) {
+		slot->store(0);
+	}
+}
+
+	/**
+	 * @brief Default constructor. Publishes an empty collection as version 1.
+	 *
+	 * @return void
+	 */
+WeatherDataStore::WeatherDataStore()
+	: current(new Version{new WeatherDataCollection(), 1}), globalEpoch(1), log(nullptr) {
+	for (int i = 0; i < kReaderSlots; ++i) {
+		slots[i].epoch.store(0);
+	}
+}
+
+	/**
+	 * @brief Destructor. Frees the published version and everything still retired.
+	 *
+	 * @return void
+	 */
+WeatherDataStore::~WeatherDataStore() {
+	for (Retired& r : retired) {
+		delete r.version->data;
+		delete r.version;
+	}
+	Version* v = current.load();
+	delete v->data;
+	delete v;
+}
+
+	/**
+	 * @brief Pins the most recently published snapshot without taking any lock.
+	 *
+	 * The reader claims a free slot by announcing the current epoch into it, and only
+	 * then loads the published pointer. Any version it can load is therefore retired
+	 * at a later epoch than the one announced, so reclaim() will not free it.
+	 *
+	 * @return ReadGuard - Guard pinning the snapshot until it is destroyed.
+	 */
+WeatherDataStore::ReadGuard WeatherDataStore::read() const {
+	// Start each thread at a different slot so readers rarely contend on the same line
+	static thread_local unsigned hint = static_cast<unsigned>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+	for (;;) {
+		for (int i = 0; i < kReaderSlots; ++i) {
+			Slot& s = slots[(hint + i) % kReaderSlots];
+			unsigned long expected = 0;
+			if (s.epoch.compare_exchange_strong(expected, globalEpoch.load())) {
+				Version* v = current.load();
+				return ReadGuard(&s.epoch, v->data, v->number);
+			}
+		}
+		std::this_thread::yield();
+	}
+}
+
+	/**
+	 * @brief Publishes a new version and retires the previous one.
+	 *
+	 * @param  next - The new collection (ownership is transferred).
+	 * @return void
+	 */
+void WeatherDataStore::publish(WeatherDataCollection* next) {
+	Version* old = current.load();
+	current.store(new Version{next, old->number + 1});
+	unsigned long retiredAt = globalEpoch.fetch_add(1) + 1;
+	retired.push_back(Retired{old, retiredAt});
+	reclaim();
+}
+
+	/**
+	 * @brief Frees every retired version that no pinned reader can still reference.
+	 *
+	 * A version retired at epoch R is safe once every active reader announced an epoch >= R.
+	 *
+	 * @return void
+	 */
+void WeatherDataStore::reclaim() {
+	unsigned long minActive = globalEpoch.load();
+	for (int i = 0; i < kReaderSlots; ++i) {
+		unsigned long e = slots[i].epoch.load();
+		if (e != 0 && e < minActive) minActive = e;
+	}
+
+	size_t kept = 0;
+	for (size_t i = 0; i < retired.size(); ++i) {
+		if (retired[i].epoch <= minActive) {
+			delete retired[i].version->data;
+			delete retired[i].version;
+		} else {
+			retired[kept++] = retired[i];
+		}
+	}
+	retired.resize(kept);
+}
+
+	/**
+	 * @brief Appends a single record as a new version.
+	 *
+	 * @param  record - Pointer to the record to add (ownership is transferred).
+	 * @return void
+	 */
+void WeatherDataStore::append(WeatherRecord* record) {
+	std::vector<WeatherRecord*> batch(1, record);
+	appendBatch(&batch);
+}
+
+	/**
+	 * @brief Appends a batch of records and publishes them together.
+	 *
+	 * The batch is first written to the attached log, if any. The current version is
+	 * then copied, the batch is added to the copy, and the copy is published.
+	 *
+	 * @param  records - Pointer to the records to add (ownership is transferred, the vector is cleared).
+	 * @return void
+	 */
+void WeatherDataStore::appendBatch(std::vector<WeatherRecord*>* records) {
+	if (records->empty()) return;
+
+	// Log first, outside the writer mutex, so concurrent appenders share a sync
+	std::shared_lock<std::shared_mutex> gate(checkpointGate);
+	if (log != nullptr && !log->append(records)) {
+		std::cerr << "Write-ahead log append failed; the records are not durable." << std::endl;
+	}
+
+	std::lock_guard<std::mutex> lock(writerMutex);
+	WeatherDataCollection* next = new WeatherDataCollection(*current.load()->data);
+	for (WeatherRecord* record : *records) {
+		next->addWeatherRecord(record);
+	}
+	records->clear();
+	publish(next);
+}
+
+	/**
+	 * @brief Publishes a copy of the current version with the records before a date removed.
+	 *
+	 * @param  date - Pointer to the first date to keep.
+	 * @return int - The number of records removed.
+	 */
+int WeatherDataStore::eraseBefore(const Date* date) {
+	std::lock_guard<std::mutex> lock(writerMutex);
+	WeatherDataCollection* next = new WeatherDataCollection(*current.load()->data);
+	int removed = next->eraseBefore(date);
+	if (removed == 0) {
+		delete next;
+		return 0;
+	}
+	publish(next);
+	return removed;
+}
+
+	/**
+	 * @brief Attaches (or detaches) the write-ahead log.
+	 *
+	 * @param  log - Pointer to the log, or nullptr.
+	 * @return void
+	 */
+void WeatherDataStore::attachLog(WriteAheadLog* log) {
+	std::unique_lock<std::shared_mutex> gate(checkpointGate);
+	this->log = log;
+}
+
+	/**
+	 * @brief Writes a snapshot of the current version and empties the log.
+	 *
+	 * Holding the gate exclusively guarantees that every logged record has been published,
+	 * and that nothing is logged, between the snapshot and the truncation.
+	 *
+	 * @param  snapshotPath - Pointer to the snapshot file path.
+	 * @return bool - False if no log is attached or the snapshot failed.
+	 */
+bool WeatherDataStore::checkpoint(std::string* snapshotPath) {
+	std::unique_lock<std::shared_mutex> gate(checkpointGate);
+	if (log == nullptr) return false;
+
+	std::lock_guard<std::mutex> lock(writerMutex);
+	return log->checkpoint(current.load()->data, snapshotPath);
+}
+
+	/**
+	 * @brief Rebuilds the data from the snapshot and the log and publishes it.
+	 *
+	 * @param  snapshotPath - Pointer to the snapshot file path.
+	 * @return bool - False if no log is attached or the snapshot is unreadable.
+	 */
+bool WeatherDataStore::recover(std::string* snapshotPath) {
+	std::unique_lock<std::shared_mutex> gate(checkpointGate);
+	if (log == nullptr) return false;
+
+	std::lock_guard<std::mutex> lock(writerMutex);
+	WeatherDataCollection* next = new WeatherDataCollection();
+	if (!log->recover(snapshotPath, next)) {
+		delete next;
+		return false;
+	}
+	publish(next);
+	return true;
+}
+
+	/**
+	 * @brief Loads data files into a new version and publishes it when loading completes.
+	 *
+	 * Readers keep querying the previous version for the whole duration of the load.
+	 *
+	 * @param  filename - Pointer to the name of the file listing the CSVs to load.
+	 * @return void
+	 */
+void WeatherDataStore::loadFromFiles(std::string* filename) {
+	std::lock_guard<std::mutex> lock(writerMutex);
+	WeatherDataCollection* next = new WeatherDataCollection(*current.load()->data);
+	next->loadFromFiles(filename);
+	publish(next);
+}
+
+	/**
+	 * @brief Returns the version number of the most recently published snapshot.
+	 *
+	 * @return unsigned long - The current version.
+	 */
+unsigned long WeatherDataStore::getVersion() const {
+	return current.load()->number;
+}
+
+	/**
+	 * @brief Returns the number of retired versions not yet freed.
+	 *
+	 * @return size_t - Count of versions waiting for readers.
+	 */
+size_t WeatherDataStore::getPendingReclaims() const {
+	std::lock_guard<std::mutex> lock(writerMutex);
+	return retired.size();
+}
@@ -0,0 +1,226 @@
+#ifndef WEATHERDATASTORE_H
+#define WEATHERDATASTORE_H
+
+#include "WeatherDataCollection.h"
+#include "WriteAheadLog.h"
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @class WeatherDataStore
+ * @brief Publishes immutable WeatherDataCollection snapshots to concurrent readers (RCU-style).
+ *
+ * Writers never modify a collection that readers can see. Each write builds a new
+ * version from the current one, publishes it with a single atomic pointer swap and
+ * retires the old version. Readers pin the current version through a ReadGuard,
+ * which only announces the reader's epoch in a slot and loads the pointer: no locks
+ * are taken on the read path. A retired version is freed once every reader that
+ * could still see it has released its guard (epoch-based reclamation).
+ *
+ * Writers are serialized among themselves by a mutex that readers never touch.
+ *
+ * With a WriteAheadLog attached, appended records are logged (and group-committed with
+ * other concurrent appenders) before they are published, checkpoint() snapshots the
+ * current version and empties the log, and recover() rebuilds the store from the
+ * snapshot and the log after a restart.
+ */
+class WeatherDataStore {
+public:
+	/**
+	 * @brief Number of reader slots. At most this many ReadGuards can be live at once;
+	 * further readers spin until a slot is released.
+	 */
+	static const int kReaderSlots = 64;
+
+	/**
+	 * @class ReadGuard
+	 * @brief Pins one published snapshot for the lifetime of the guard.
+	 *
+	 * The snapshot seen through a guard never changes, even if writers publish
+	 * newer versions while the guard is held.
+	 */
+	class ReadGuard {
+	public:
+		/**
+		 * @brief Move constructor. The source guard no longer pins anything.
+		 * @param other The guard to take over.
+		 */
+		ReadGuard(ReadGuard&& other);
+
+		/**
+		 * @brief Destructor. Releases the reader slot.
+		 */
+		~ReadGuard();
+
+		/**
+		 * @brief Gets the pinned snapshot.
+		 * @return const WeatherDataCollection* The immutable collection.
+		 */
+		const WeatherDataCollection* get() const { return snapshot; }
+
+		/**
+		 * @brief Member access to the pinned snapshot.
+		 * @return const WeatherDataCollection* The immutable collection.
+		 */
+		const WeatherDataCollection* operator->() const { return snapshot; }
+
+		/**
+		 * @brief Gets the version number of the pinned snapshot.
+		 * @return unsigned long The version (starts at 1, increments on each publish).
+		 */
+		unsigned long getVersion() const { return version; }
+
+	private:
+		friend class WeatherDataStore;
+
+		/**
+		 * @brief Constructs a guard over an already announced slot.
+		 * @param s The slot the reader announced its epoch in.
+		 * @param snap The snapshot loaded after the announcement.
+		 * @param v The version number of the snapshot.
+		 */
+		ReadGuard(std::atomic<unsigned long>* s, const WeatherDataCollection* snap, unsigned long v);
+
+		ReadGuard(const ReadGuard&) = delete;
+		ReadGuard& operator=(const ReadGuard&) = delete;
+
+		std::atomic<unsigned long>* slot;         ///< Announced epoch slot (nullptr once moved from).
+		const WeatherDataCollection* snapshot;    ///< The pinned collection.
+		unsigned long version;                    ///< Version number of the pinned collection.
+	};
+
+	/**
+	 * @brief Default constructor. Publishes an empty collection as version 1.
+	 */
+	WeatherDataStore();
+
+	/**
+	 * @brief Destructor. Frees the current and all retired versions.
+	 *
+	 * No ReadGuard may outlive the store.
+	 */
+	~WeatherDataStore();
+
+	/**
+	 * @brief Pins the most recently published snapshot. Lock-free.
+	 * @return ReadGuard A guard giving access to the snapshot.
+	 */
+	ReadGuard read() const;
+
+	/**
+	 * @brief Appends one record and publishes the result as a new version.
+	 * @param record The record to add. Ownership is transferred to the store.
+	 */
+	void append(WeatherRecord* record);
+
+	/**
+	 * @brief Appends a batch of records and publishes them as a single new version.
+	 *
+	 * Every publish copies the current version, so batching appends amortizes that cost.
+	 * @param records The records to add. Ownership of each record is transferred; the vector is left empty.
+	 */
+	void appendBatch(std::vector<WeatherRecord*>* records);
+
+	/**
+	 * @brief Loads data files into a new version, leaving readers on the previous one until it is published.
+	 * @param filename A pointer to the name of the file listing the CSVs to load.
+	 */
+	void loadFromFiles(std::string* filename);
+
+	/**
+	 * @brief Retention: publishes a version without the records dated before a date.
+	 *
+	 * The removal is not logged; with a log attached, checkpoint afterwards to make it durable.
+	 * @param date A constant pointer to the first date to keep.
+	 * @return int The number of records removed.
+	 */
+	int eraseBefore(const Date* date);
+
+	/**
+	 * @brief Attaches a write-ahead log that every later append goes through.
+	 * @param log A pointer to the log (not owned; must outlive the store), or nullptr to detach.
+	 */
+	void attachLog(WriteAheadLog* log);
+
+	/**
+	 * @brief Snapshots the current version through the attached log and empties the log.
+	 *
+	 * Appends wait while the checkpoint runs. Call it after loadFromFiles too, since loads are not logged.
+	 * @param snapshotPath A pointer to the snapshot file path.
+	 * @return bool False if no log is attached or the snapshot failed.
+	 */
+	bool checkpoint(std::string* snapshotPath);
+
+	/**
+	 * @brief Publishes a version rebuilt from a snapshot and the attached log's records.
+	 * @param snapshotPath A pointer to the snapshot file path.
+	 * @return bool False if no log is attached or the snapshot is unreadable.
+	 */
+	bool recover(std::string* snapshotPath);
+
+	/**
+	 * @brief Gets the version number of the most recently published snapshot.
+	 * @return unsigned long The current version.
+	 */
+	unsigned long getVersion() const;
+
+	/**
+	 * @brief Gets the number of retired versions still waiting for readers to release them.
+	 * @return size_t The count of pending retired versions.
+	 */
+	size_t getPendingReclaims() const;
+
+private:
+	/**
+	 * @struct Version
+	 * @brief A published collection together with its version number.
+	 */
+	struct Version {
+		WeatherDataCollection* data;  ///< The immutable collection.
+		unsigned long number;         ///< Publish sequence number.
+	};
+
+	/**
+	 * @struct Retired
+	 * @brief A replaced version and the epoch at which it was retired.
+	 */
+	struct Retired {
+		Version* version;             ///< The version to free.
+		unsigned long epoch;          ///< Global epoch after the swap that retired it.
+	};
+
+	/**
+	 * @struct Slot
+	 * @brief One reader slot, padded to a cache line so readers do not false-share.
+	 */
+	struct alignas(64) Slot {
+		std::atomic<unsigned long> epoch;  ///< 0 when free, otherwise the epoch the reader announced.
+	};
+
+	/**
+	 * @brief Publishes a new version and retires the old one. Caller must hold writerMutex.
+	 * @param next The new collection. Ownership is transferred.
+	 */
+	void publish(WeatherDataCollection* next);
+
+	/**
+	 * @brief Frees every retired version no active reader can still see. Caller must hold writerMutex.
+	 */
+	void reclaim();
+
+	std::atomic<Version*> current;             ///< Currently published version.
+	std::atomic<unsigned long> globalEpoch;    ///< Advanced on every publish.
+	mutable Slot slots[kReaderSlots];          ///< Reader epoch announcements.
+	mutable std::mutex writerMutex;            ///< Serializes writers only.
+	std::shared_mutex checkpointGate;          ///< Shared by logging appends, exclusive for checkpoints.
+	WriteAheadLog* log;                        ///< Attached log (nullptr if none).
+	std::vector<Retired> retired;              ///< Versions waiting to be freed.
+
+	WeatherDataStore(const WeatherDataStore&) = delete;
+	WeatherDataStore& operator=(const WeatherDataStore&) = delete;
+};
+
+#endif // WEATHERDATASTORE_H
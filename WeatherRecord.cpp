@@ -1,10 +1,11 @@
 // WeatherRecord.cpp
 //
 // Implements the WeatherRecord class, which holds a single observation of weather data
-// (date/time, wind speed, temperature, solar radiation), and its associated
-// comparison logic and collection helpers.
+// (date/time, wind speed, temperature, solar radiation, wind direction), its associated
+// comparison logic and collection helpers, and the CSV column layout it is read with.
 
 #include "WeatherRecord.h"
+#include <algorithm>
 #include <iostream>
 
 	/**
@@ -16,10 +17,11 @@
 	 * @param  ws - Wind speed.
 	 * @param  temp - Temperature.
 	 * @param  sr - Solar radiation.
+	 * @param  wd - Wind direction.
 	 * @return void
 	 */
-WeatherRecord::WeatherRecord(Date* d, double ws, double temp, double sr)
-    : date(d), windSpeed(ws), temperature(temp), solarRadiation(sr) {}
+WeatherRecord::WeatherRecord(Date* d, double ws, double temp, double sr, double wd)
+    : date(d), windSpeed(ws), temperature(temp), solarRadiation(sr), windDirection(wd) {}
 
 	/**
 	 * @brief Destructor for WeatherRecord.
@@ -44,7 +46,8 @@ WeatherRecord::WeatherRecord(const WeatherRecord& other)
     : date(new Date(*(other.date))),
       windSpeed(other.windSpeed),
       temperature(other.temperature),
-      solarRadiation(other.solarRadiation) {}
+      solarRadiation(other.solarRadiation),
+      windDirection(other.windDirection) {}
 
 	/**
 	 * @brief Assignment operator for WeatherRecord.
@@ -61,6 +64,7 @@ WeatherRecord& WeatherRecord::operator=(const WeatherRecord& other) {
         windSpeed = other.windSpeed;
         temperature = other.temperature;
         solarRadiation = other.solarRadiation;
+        windDirection = other.windDirection;
     }
     return *this;
 }
@@ -102,6 +106,58 @@ bool WeatherRecord::operator==(const WeatherRecord& other) const {
     return date->operator==(other.date);
 }
 
+	/**
+	 * @brief Returns the column positions of the original exports.
+	 *
+	 * WAST is column 0, Dta 2, S 10, SR 11 and T 17.
+	 *
+	 * @return CsvLayout - The standard layout.
+	 */
+CsvLayout CsvLayout::standard() {
+    return CsvLayout{0, 10, 17, 11, 2, 18};
+}
+
+	/**
+	 * @brief Finds the WAST, S, T, SR and Dta columns by name in a header line.
+	 *
+	 * Names are matched exactly once spaces and carriage returns are removed.
+	 *
+	 * @param  header - Pointer to the header line.
+	 * @return CsvLayout - The layout, or the standard one if a required column is missing.
+	 */
+CsvLayout CsvLayout::fromHeader(const std::string* header) {
+    CsvLayout layout{-1, -1, -1, -1, -1, 0};
+
+    int column = 0;
+    size_t begin = 0;
+    while (begin <= header->size()) {
+        size_t end = header->find(',', begin);
+        if (end == std::string::npos) end = header->size();
+
+        std::string name = header->substr(begin, end - begin);
+        name.erase(std::remove_if(name.begin(), name.end(), [](char c) {
+            return c == ' ' || c == '\t' || c == '\r';
+        }), name.end());
+
+        if (name == "WAST") layout.date = column;
+        else if (name == "S") layout.windSpeed = column;
+        else if (name == "T") layout.temperature = column;
+        else if (name == "SR") layout.solarRadiation = column;
+        else if (name == "Dta") layout.windDirection = column;
+
+        ++column;
+        begin = end + 1;
+    }
+
+    if (layout.date < 0 || layout.windSpeed < 0 || layout.temperature < 0 || layout.solarRadiation < 0) {
+        return standard();
+    }
+
+    layout.width = std::max({layout.date, layout.windSpeed, layout.temperature,
+                             layout.solarRadiation, layout.windDirection}) + 1;
+    return layout;
+}
+
 	/**
 	 * @brief Standalone print function used for generic BST traversal.
 	 *
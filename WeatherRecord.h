@@ -2,16 +2,17 @@
 #define WEATHERRECORD_H
 
 #include "Date.h"
-#include <vector>
 #include <iostream>
+#include <string>
+#include <vector>
 
 /**
  * @class WeatherRecord
  * @brief Represents a single weather data observation at a specific date and time.
  *
- * This class holds the date, wind speed, temperature, and solar radiation for
- * a single recorded observation. It includes comparison operators essential for
- * storage within the Binary Search Tree (BST).
+ * This class holds the date, wind speed, temperature, solar radiation and wind
+ * direction for a single recorded observation. It includes comparison operators
+ * essential for storage within the Binary Search Tree (BST).
  */
 class WeatherRecord {
 public:
@@ -35,14 +36,20 @@ public:
 	 */
 	double solarRadiation;
 
+	/**
+	 * @brief Wind direction recorded (in degrees clockwise from north, 0 when unknown).
+	 */
+	double windDirection;
+
 	/**
 	 * @brief Constructor.
 	 * @param d Pointer to the Date object.
 	 * @param ws Wind speed value.
 	 * @param temp Temperature value.
 	 * @param sr Solar radiation value.
+	 * @param wd Wind direction value.
 	 */
-	WeatherRecord(Date* d, double ws, double temp, double sr);
+	WeatherRecord(Date* d, double ws, double temp, double sr, double wd = 0.0);
 
 	/**
 	 * @brief Destructor.
@@ -92,6 +99,35 @@ public:
 	bool operator==(const WeatherRecord& other) const;
 };
 
+/**
+ * @struct CsvLayout
+ * @brief Positions of the fields a WeatherRecord is read from in a line of a data CSV.
+ *
+ * The data files do not share one column order (the 2014 and 2015 exports move T
+ * and reorder other columns), so each file's layout is taken from its header line.
+ */
+struct CsvLayout {
+	int date;            ///< WAST column.
+	int windSpeed;       ///< S column.
+	int temperature;     ///< T column.
+	int solarRadiation;  ///< SR column.
+	int windDirection;   ///< Dta column (-1 if the file has none).
+	int width;           ///< Fewest fields a data line must have.
+
+	/**
+	 * @brief Returns the layout of the original exports (WAST,DP,Dta,...,S,SR,...,T).
+	 * @return CsvLayout The standard layout.
+	 */
+	static CsvLayout standard();
+
+	/**
+	 * @brief Builds the layout named by a header line.
+	 * @param header A constant pointer to the header line.
+	 * @return CsvLayout The layout, or the standard one if WAST, S, T or SR is missing.
+	 */
+	static CsvLayout fromHeader(const std::string* header);
+};
+
 /**
  * @brief Utility function to print the details of a WeatherRecord.
  *
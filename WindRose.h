@@ -0,0 +1,135 @@
+#ifndef WINDROSE_H
+#define WINDROSE_H
+
+#include "TaskPool.h"
+#include "WeatherDataCollection.h"
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * @class WindRose
+ * @brief Two-dimensional histogram of wind readings: direction sectors by speed classes.
+ *
+ * Sector s is centred on s * 360 / sectors degrees, so sector 0 is north and spans half a
+ * sector either side of it. Readings slower than the calm threshold have no meaningful
+ * direction and are counted once, as calm, rather than in a sector. The remaining speeds
+ * fall into the classes [calm, e0), [e0, e1), ..., [e(k-1), infinity) for edges e0 < ... < e(k-1).
+ *
+ * Readings are binned column-wise: each block of directions and speeds is turned into
+ * histogram indices by a branch-free loop the compiler vectorizes, then counted. Large
+ * inputs are split into one slice per thread, each counted into its own histogram, and the
+ * slice histograms are added up at the end, so no counter is ever shared between threads.
+ */
+class WindRose {
+public:
+	/**
+	 * @brief Constructor. Creates an empty rose.
+	 * @param sectors The number of direction sectors (at least 1; 16 gives N, NNE, NE, ...).
+	 * @param speedEdges A constant pointer to the ascending class edges, or nullptr for 2, 4, 6, 8 and 10.
+	 * @param calmBelow Speeds below this count as calm.
+	 */
+	explicit WindRose(int sectors = 16, const std::vector<double>* speedEdges = nullptr, double calmBelow = 0.5);
+
+	/**
+	 * @brief Adds readings given as parallel direction and speed arrays.
+	 * @param directions A constant pointer to the directions, in degrees from north.
+	 * @param speeds A constant pointer to the speeds.
+	 * @param count The number of readings.
+	 * @param pool The pool for large inputs, or nullptr to count on the calling thread.
+	 */
+	void add(const double* directions, const double* speeds, size_t count, TaskPool* pool = nullptr);
+
+	/**
+	 * @brief Adds the readings of a collection over a minute-key range, optionally for one calendar month only.
+	 * @param data A constant pointer to the collection.
+	 * @param from The first minute key of the range.
+	 * @param to The last minute key of the range (inclusive).
+	 * @param month The month (1-12) to keep in every year of the range, or 0 for all.
+	 * @param pool The pool for large inputs, or nullptr.
+	 * @return size_t The number of readings added.
+	 */
+	size_t add(const WeatherDataCollection* data, int from, int to, int month = 0, TaskPool* pool = &TaskPool::instance());
+
+	/**
+	 * @brief Empties the histogram, keeping its bins.
+	 */
+	void clear();
+
+	/**
+	 * @brief Gets the number of readings in one bin.
+	 * @param sector The direction sector (0 is north, counting clockwise).
+	 * @param speedClass The speed class (0 is the slowest above calm).
+	 * @return unsigned long The count.
+	 */
+	unsigned long getCount(int sector, int speedClass) const { return counts[sector * speedClasses + speedClass]; }
+
+	/**
+	 * @brief Gets the number of calm readings.
+	 * @return unsigned long The count.
+	 */
+	unsigned long getCalm() const { return counts[sectors * speedClasses]; }
+
+	/**
+	 * @brief Gets the number of readings added, calm included.
+	 * @return unsigned long The count.
+	 */
+	unsigned long getTotal() const { return total; }
+
+	/**
+	 * @brief Gets the number of direction sectors.
+	 * @return int The sector count.
+	 */
+	int getSectors() const { return sectors; }
+
+	/**
+	 * @brief Gets the number of speed classes above calm.
+	 * @return int The class count.
+	 */
+	int getSpeedClasses() const { return speedClasses; }
+
+	/**
+	 * @brief Gets the name of a sector: a compass point for 4, 8 or 16 sectors, else its centre in degrees.
+	 * @param sector The sector.
+	 * @return std::string The name.
+	 */
+	std::string getSectorName(int sector) const;
+
+	/**
+	 * @brief Writes the rose as a CSV table: one row per sector, one column per speed class, in percent of all readings.
+	 * @param out A pointer to the output stream.
+	 */
+	void writeTable(std::ostream* out) const;
+
+	/**
+	 * @brief Writes the table of writeTable to a file.
+	 * @param filename A pointer to the output file name.
+	 * @return bool False if the file could not be written.
+	 */
+	bool writeCsv(std::string* filename) const;
+
+private:
+	/**
+	 * @brief Bins a slice of readings into a histogram.
+	 * @param directions The directions.
+	 * @param speeds The speeds.
+	 * @param count The number of readings.
+	 * @param histogram The histogram to add to (sectors * speedClasses + 1 bins).
+	 */
+	void binInto(const double* directions, const double* speeds, size_t count, unsigned long* histogram) const;
+
+	/**
+	 * @brief Inputs shorter than this are binned on the calling thread.
+	 */
+	static const size_t kParallelThreshold = 1 << 15;
+
+	int sectors;                        ///< Direction sectors.
+	int speedClasses;                   ///< Speed classes above calm.
+	double calmBelow;                   ///< Calm threshold.
+	std::vector<double> edges;          ///< Class edges, ascending.
+	std::vector<unsigned long> counts;  ///< sectors * speedClasses bins, sector-major, then the calm bin.
+	unsigned long total;                ///< Readings added.
+};
+
+#endif // WINDROSE_H
@@ -0,0 +1,469 @@
+// WriteAheadLog.cpp
+
+// Implements the write-ahead log: frame encoding with checksums, leader-based group
+// commit, torn-tail recovery, and snapshot checkpoints through ColumnStore.
+
+#include "WriteAheadLog.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	const char kMagic[4] = {'W', 'W', 'A', 'L'};
+	const uint32_t kVersion = 2;
+	const long kHeaderBytes = sizeof(kMagic) + sizeof(kVersion);
+	const size_t kFrameHeaderBytes = 2 * sizeof(uint32_t);
+	const size_t kRecordBytes = sizeof(int32_t) + 4 * sizeof(double);
+	const size_t kVersion1RecordBytes = sizeof(int32_t) + 3 * sizeof(double); // No wind direction
+
+	/**
+	 * @brief Computes the 32-bit FNV-1a hash of a byte range.
+	 *
+	 * @param  data - The bytes.
+	 * @param  length - Number of bytes.
+	 * @return uint32_t - The hash.
+	 */
+	uint32_t checksum(const char* data, size_t length) {
+		uint32_t hash = 2166136261u;
+		for (size_t i = 0; i < length; ++i) {
+			hash ^= static_cast<unsigned char>(data[i]);
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	/**
+	 * @brief Opens a file for reading and appending, creating it if needed.
+	 *
+	 * @param  path - The file path.
+	 * @return int - The descriptor, or -1 on failure.
+	 */
+	int openLog(const std::string& path) {
+#ifdef _WIN32
+		return _open(path.c_str(), _O_RDWR | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+		return open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+#endif
+	}
+
+	/**
+	 * @brief Closes a descriptor.
+	 *
+	 * @param  fd - The descriptor.
+	 * @return void
+	 */
+	void closeLog(int fd) {
+#ifdef _WIN32
+		_close(fd);
+#else
+		close(fd);
+#endif
+	}
+
+	/**
+	 * @brief Writes a whole buffer, retrying short writes.
+	 *
+	 * @param  fd - The descriptor.
+	 * @param  data - The bytes.
+	 * @param  length - Number of bytes.
+	 * @return bool - False on error.
+	 */
+	bool writeAll(int fd, const char* data, size_t length) {
+		while (length > 0) {
+#ifdef _WIN32
+			int written = _write(fd, data, static_cast<unsigned>(length));
+#else
+			ssize_t written = write(fd, data, length);
+#endif
+			if (written <= 0) return false;
+			data += written;
+			length -= static_cast<size_t>(written);
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Flushes a file's data to stable storage.
+	 *
+	 * @param  fd - The descriptor.
+	 * @return bool - False on error.
+	 */
+	bool syncFile(int fd) {
+#ifdef _WIN32
+		return _commit(fd) == 0;
+#else
+		return fsync(fd) == 0;
+#endif
+	}
+
+	/**
+	 * @brief Cuts a file to a length and syncs it.
+	 *
+	 * @param  fd - The descriptor.
+	 * @param  length - The new length.
+	 * @return bool - False on error.
+	 */
+	bool truncateFile(int fd, long length) {
+#ifdef _WIN32
+		return _chsize(fd, length) == 0 && syncFile(fd);
+#else
+		return ftruncate(fd, length) == 0 && syncFile(fd);
+#endif
+	}
+
+	/**
+	 * @brief Syncs a file by name (e.g. a snapshot written through a stream).
+	 *
+	 * @param  path - The file path.
+	 * @return bool - False on error.
+	 */
+	bool syncPath(const std::string& path) {
+#ifdef _WIN32
+		int fd = _open(path.c_str(), _O_RDWR | _O_BINARY);
+		if (fd < 0) return false;
+		bool ok = syncFile(fd);
+		_close(fd);
+#else
+		int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0) return false;
+		bool ok = syncFile(fd);
+		close(fd);
+#endif
+		return ok;
+	}
+
+	/**
+	 * @brief Syncs the directory holding a path, so a rename into it is durable (POSIX only).
+	 *
+	 * @param  path - A file path inside the directory.
+	 * @return void
+	 */
+	void syncDirectoryOf(const std::string& path) {
+#ifndef _WIN32
+		size_t slash = path.find_last_of('/');
+		std::string dir = (slash == std::string::npos) ? "." : path.substr(0, slash + 1);
+		int fd = open(dir.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd >= 0) {
+			fsync(fd);
+			close(fd);
+		}
+#else
+		(void)path;
+#endif
+	}
+
+	/**
+	 * @brief Appends the log header (magic and current version) to a buffer.
+	 *
+	 * @param  out - The buffer.
+	 * @return void
+	 */
+	void encodeHeader(std::string* out) {
+		out->append(kMagic, sizeof(kMagic));
+		out->append(reinterpret_cast<const char*>(&kVersion), sizeof(kVersion));
+	}
+
+	/**
+	 * @brief Checks whether a file shorter than a header holds the start of one, as a crash while creating the log leaves.
+	 *
+	 * @param  path - The file path.
+	 * @param  size - The file size, less than kHeaderBytes.
+	 * @return bool - True if the bytes are a prefix of the header.
+	 */
+	bool isTornHeader(const std::string& path, long size) {
+		std::string header;
+		encodeHeader(&header);
+		std::ifstream in(path, std::ios::binary);
+		std::string bytes(static_cast<size_t>(size), '\0');
+		in.read(&bytes[0], size);
+		return in.gcount() == size && header.compare(0, bytes.size(), bytes) == 0;
+	}
+
+	/**
+	 * @brief Appends the encoded frame of a batch of records to a buffer.
+	 *
+	 * @param  records - The records.
+	 * @param  out - The buffer.
+	 * @return void
+	 */
+	void encodeFrame(const std::vector<WeatherRecord*>* records, std::string* out) {
+		std::string payload(records->size() * kRecordBytes, '\0');
+		char* p = &payload[0];
+		for (const WeatherRecord* record : *records) {
+			int32_t key = record->date->toMinuteKey();
+			std::memcpy(p, &key, sizeof(key));
+			std::memcpy(p + 4, &record->windSpeed, sizeof(double));
+			std::memcpy(p + 12, &record->temperature, sizeof(double));
+			std::memcpy(p + 20, &record->solarRadiation, sizeof(double));
+			std::memcpy(p + 28, &record->windDirection, sizeof(double));
+			p += kRecordBytes;
+		}
+
+		uint32_t header[2] = {static_cast<uint32_t>(records->size()), checksum(payload.data(), payload.size())};
+		out->append(reinterpret_cast<const char*>(header), sizeof(header));
+		out->append(payload);
+	}
+}
+
+	/**
+	 * @brief Constructor for WriteAheadLog. Opens the log, writes a header if it is new,
+	 * migrates a version 1 log, and truncates any torn or corrupt frames at its end.
+	 *
+	 * A non-empty file that is not a log of a known version is left untouched and the log
+	 * is not opened, so a mistyped path cannot wipe another file.
+	 *
+	 * @param  path - Pointer to the log file path.
+	 * @return void
+	 */
+WriteAheadLog::WriteAheadLog(std::string* path)
+	: path(*path), fd(openLog(*path)), enqueued(0), durable(0), flushing(false), failed(false),
+	  syncCount(0), recordCount(0) {
+	if (fd < 0) return;
+
+	uint32_t version = 0;
+	long valid = scan(nullptr, &version);
+#ifdef _WIN32
+	long size = _lseek(fd, 0, SEEK_END);
+#else
+	long size = static_cast<long>(lseek(fd, 0, SEEK_END));
+#endif
+
+	if (size < kHeaderBytes && (size == 0 || isTornHeader(*path, size))) {
+		// New file, or one whose creation was cut short: start a fresh log
+		std::string header;
+		encodeHeader(&header);
+		if (!truncateFile(fd, 0) || !writeAll(fd, header.data(), header.size()) || !syncFile(fd)) failed = true;
+	} else if (valid < kHeaderBytes) {
+		// Foreign file or unknown version: refuse it
+		closeLog(fd);
+		fd = -1;
+		failed = true;
+	} else if (version != kVersion) {
+		if (!migrate()) failed = true;
+	} else if (valid < size) {
+		if (!truncateFile(fd, valid)) failed = true;
+	}
+}
+
+	/**
+	 * @brief Destructor for WriteAheadLog.
+	 *
+	 * @return void
+	 */
+WriteAheadLog::~WriteAheadLog() {
+	if (fd < 0) return;
+	closeLog(fd);
+}
+
+	/**
+	 * @brief Rewrites an older log in the current format.
+	 *
+	 * The intact records are re-encoded as one frame into "<path>.tmp", which is synced and
+	 * renamed over the log, so a crash leaves either the old log or the migrated one.
+	 *
+	 * @return bool - False if the new log could not be written (the old one is then kept and closed).
+	 */
+bool WriteAheadLog::migrate() {
+	std::vector<WeatherRecord*> records;
+	scan(&records);
+	std::string contents;
+	encodeHeader(&contents);
+	if (!records.empty()) encodeFrame(&records, &contents);
+	for (WeatherRecord* record : records) {
+		delete record;
+	}
+
+	std::string tempPath = path + ".tmp";
+	int tempFd = openLog(tempPath);
+	bool ok = tempFd >= 0 && truncateFile(tempFd, 0) && writeAll(tempFd, contents.data(), contents.size()) && syncFile(tempFd);
+	if (tempFd >= 0) closeLog(tempFd);
+
+	closeLog(fd);
+	fd = -1;
+	if (!ok) {
+		std::remove(tempPath.c_str());
+		return false;
+	}
+#ifdef _WIN32
+	std::remove(path.c_str());
+#endif
+	if (std::rename(tempPath.c_str(), path.c_str()) != 0) return false;
+	syncDirectoryOf(path);
+	fd = openLog(path);
+	return fd >= 0;
+}
+
+	/**
+	 * @brief Reads the log and finds the end of its last intact frame.
+	 *
+	 * Reads the current format and version 1 (no wind direction, which reads as 0).
+	 *
+	 * @param  records - Receives the decoded records (may be nullptr).
+	 * @param  version - Receives the log's version (may be nullptr).
+	 * @return long - Length of the valid prefix in bytes (0 if the header is missing or of an unknown version).
+	 */
+long WriteAheadLog::scan(std::vector<WeatherRecord*>* records, uint32_t* version) const {
+	std::ifstream in(path, std::ios::binary);
+	std::ostringstream contents;
+	contents << in.rdbuf();
+	std::string data = contents.str();
+
+	uint32_t found = 0;
+	if (data.size() < static_cast<size_t>(kHeaderBytes) || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) return 0;
+	std::memcpy(&found, data.data() + sizeof(kMagic), sizeof(found));
+	if (found != kVersion && found != 1) return 0;
+	if (version != nullptr) *version = found;
+	const size_t recordBytes = (found == 1) ? kVersion1RecordBytes : kRecordBytes;
+
+	size_t pos = kHeaderBytes;
+	while (pos + kFrameHeaderBytes <= data.size()) {
+		uint32_t header[2];
+		std::memcpy(header, data.data() + pos, sizeof(header));
+		size_t payloadBytes = static_cast<size_t>(header[0]) * recordBytes;
+		const char* payload = data.data() + pos + kFrameHeaderBytes;
+		if (pos + kFrameHeaderBytes + payloadBytes > data.size() || checksum(payload, payloadBytes) != header[1]) break;
+
+		if (records != nullptr) {
+			for (uint32_t i = 0; i < header[0]; ++i) {
+				const char* p = payload + i * recordBytes;
+				int32_t key;
+				double wind, temperature, solar, direction = 0.0;
+				std::memcpy(&key, p, sizeof(key));
+				std::memcpy(&wind, p + 4, sizeof(double));
+				std::memcpy(&temperature, p + 12, sizeof(double));
+				std::memcpy(&solar, p + 20, sizeof(double));
+				if (found != 1) std::memcpy(&direction, p + 28, sizeof(double));
+				records->push_back(new WeatherRecord(Date::fromMinuteKey(key), wind, temperature, solar, direction));
+			}
+		}
+		pos += kFrameHeaderBytes + payloadBytes;
+	}
+	return static_cast<long>(pos);
+}
+
+	/**
+	 * @brief Queues a frame and waits for a group commit to make it durable.
+	 *
+	 * Whoever finds no flush in progress becomes the leader: it takes every queued frame,
+	 * writes and syncs them without holding the lock, then wakes the waiters it covered.
+	 *
+	 * @param  records - Pointer to the records to log.
+	 * @return bool - False if the log is closed or a write failed.
+	 */
+bool WriteAheadLog::append(const std::vector<WeatherRecord*>* records) {
+	if (fd < 0) return false;
+	if (records->empty()) return true;
+
+	std::string frame;
+	encodeFrame(records, &frame);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	pending.append(frame);
+	recordCount += records->size();
+	unsigned long ticket = ++enqueued;
+
+	while (durable < ticket) {
+		if (flushing) {
+			flushed.wait(lock);
+			continue;
+		}
+
+		flushing = true;
+		std::string batch;
+		batch.swap(pending);
+		unsigned long covered = enqueued;
+		lock.unlock();
+
+		bool ok = writeAll(fd, batch.data(), batch.size()) && syncFile(fd);
+
+		lock.lock();
+		flushing = false;
+		durable = covered;
+		syncCount += 1;
+		if (!ok) failed = true;
+		flushed.notify_all();
+	}
+	return !failed;
+}
+
+	/**
+	 * @brief Decodes every intact frame of the log.
+	 *
+	 * @param  records - Receives the records (caller takes ownership).
+	 * @return size_t - The number of records read.
+	 */
+size_t WriteAheadLog::replay(std::vector<WeatherRecord*>* records) {
+	std::lock_guard<std::mutex> lock(mutex);
+	size_t before = records->size();
+	scan(records);
+	return records->size() - before;
+}
+
+	/**
+	 * @brief Writes the collection as a ColumnStore snapshot, then cuts the log back to its header.
+	 *
+	 * The snapshot goes to "<snapshotPath>.tmp", is synced, and is renamed over the previous
+	 * snapshot, so a crash at any point leaves either the old snapshot and the full log or the
+	 * new snapshot (with the log possibly not yet emptied; replaying it again is harmless).
+	 *
+	 * @param  data - Pointer to the collection.
+	 * @param  snapshotPath - Pointer to the snapshot file path.
+	 * @return bool - False if the snapshot or the truncation failed.
+	 */
+bool WriteAheadLog::checkpoint(const WeatherDataCollection* data, std::string* snapshotPath) {
+	std::string tempPath = *snapshotPath + ".tmp";
+
+	ColumnStore* store = data->buildColumnStore();
+	std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+	bool ok = out.is_open() && store->writeTo(&out);
+	out.close();
+	delete store;
+
+	if (!ok || out.fail() || !syncPath(tempPath)) {
+		std::remove(tempPath.c_str());
+		return false;
+	}
+#ifdef _WIN32
+	std::remove(snapshotPath->c_str());
+#endif
+	if (std::rename(tempPath.c_str(), snapshotPath->c_str()) != 0) return false;
+	syncDirectoryOf(*snapshotPath);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	return fd >= 0 && truncateFile(fd, kHeaderBytes);
+}
+
+	/**
+	 * @brief Loads the latest snapshot into a collection and replays the log over it.
+	 *
+	 * @param  snapshotPath - Pointer to the snapshot file path.
+	 * @param  data - Pointer to the collection to fill (its contents are replaced).
+	 * @return bool - False if the snapshot exists but is unreadable.
+	 */
+bool WriteAheadLog::recover(std::string* snapshotPath, WeatherDataCollection* data) {
+	std::ifstream in(*snapshotPath, std::ios::binary);
+	if (in.is_open()) {
+		ColumnStore* store = ColumnStore::readFrom(&in);
+		if (store == nullptr) return false;
+		data->loadColumnStore(store);
+	} else {
+		std::vector<WeatherRecord*> none; // No checkpoint yet: everything is in the log
+		data->loadColumnStore(new ColumnStore(&none));
+	}
+
+	std::vector<WeatherRecord*> records;
+	replay(&records);
+	data->addWeatherRecords(&records);
+	return true;
+}
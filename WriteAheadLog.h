@@ -0,0 +1,129 @@
+#ifndef WRITEAHEADLOG_H
+#define WRITEAHEADLOG_H
+
+#include "WeatherDataCollection.h"
+#include "WeatherRecord.h"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @class WriteAheadLog
+ * @brief Append-only binary log of ingested records with group commit, plus snapshot checkpoints.
+ *
+ * Each append is encoded as one frame: a record count, a checksum and 36 bytes per record
+ * (minute key and the four readings). Appends from several threads are group-committed:
+ * the first caller to find no flush in progress writes every frame queued so far and
+ * syncs the file once, while the others wait for that sync to cover their frames. An
+ * append returns once its records are on stable storage.
+ *
+ * A checkpoint writes the collection as a ColumnStore snapshot (to a temporary file that is
+ * synced and then renamed over the old one) and empties the log. Recovery loads the latest
+ * snapshot and replays the log on top of it, so restart time depends on the records logged
+ * since the last checkpoint rather than on the archive. A frame torn by a crash fails its
+ * checksum; it and anything after it are discarded when the log is opened.
+ *
+ * Opening a version 1 log (no wind direction) rewrites it in the current format. A
+ * non-empty file that is not a log of a known version is left untouched and the log stays
+ * closed (isOpen() is false).
+ */
+class WriteAheadLog {
+public:
+	/**
+	 * @brief Constructor. Opens (or creates) the log, migrates an older one and cuts off any torn tail.
+	 * @param path A pointer to the log file path.
+	 */
+	explicit WriteAheadLog(std::string* path);
+
+	/**
+	 * @brief Destructor. Closes the log.
+	 */
+	~WriteAheadLog();
+
+	/**
+	 * @brief Checks whether the log file is open.
+	 * @return bool True if appends can be made.
+	 */
+	bool isOpen() const { return fd >= 0; }
+
+	/**
+	 * @brief Appends records to the log and waits until they are durable.
+	 *
+	 * The records are only read; ownership stays with the caller.
+	 * @param records A constant pointer to the records.
+	 * @return bool False if the log could not be written.
+	 */
+	bool append(const std::vector<WeatherRecord*>* records);
+
+	/**
+	 * @brief Reads back every record in the log, in append order.
+	 * @param records Receives new records (caller takes ownership).
+	 * @return size_t The number of records read.
+	 */
+	size_t replay(std::vector<WeatherRecord*>* records);
+
+	/**
+	 * @brief Writes a snapshot of a collection and empties the log.
+	 *
+	 * The caller must ensure the collection holds every record appended so far and that no
+	 * append runs concurrently (see WeatherDataStore::checkpoint).
+	 * @param data A constant pointer to the collection.
+	 * @param snapshotPath A pointer to the snapshot file path.
+	 * @return bool False if the snapshot could not be written (the log is then kept).
+	 */
+	bool checkpoint(const WeatherDataCollection* data, std::string* snapshotPath);
+
+	/**
+	 * @brief Loads a snapshot and replays the log into a collection.
+	 * @param snapshotPath A pointer to the snapshot file path (a missing snapshot means an empty archive).
+	 * @param data A pointer to the collection, whose contents are replaced.
+	 * @return bool False if a snapshot exists but cannot be read.
+	 */
+	bool recover(std::string* snapshotPath, WeatherDataCollection* data);
+
+	/**
+	 * @brief Gets the number of syncs performed by appends (one per group commit).
+	 * @return unsigned long The sync count.
+	 */
+	unsigned long getSyncCount() const { return syncCount; }
+
+	/**
+	 * @brief Gets the number of records appended since the log was opened.
+	 * @return unsigned long The record count.
+	 */
+	unsigned long getRecordCount() const { return recordCount; }
+
+private:
+	/**
+	 * @brief Scans the log, returning the length of its valid prefix.
+	 * @param records Receives the decoded records if not nullptr.
+	 * @param version Receives the log's format version if not nullptr.
+	 * @return long The byte length of the header and the complete, intact frames.
+	 */
+	long scan(std::vector<WeatherRecord*>* records, uint32_t* version = nullptr) const;
+
+	/**
+	 * @brief Rewrites an older log in the current format (through a temporary file and a rename).
+	 * @return bool False if the rewrite failed; the log is then closed.
+	 */
+	bool migrate();
+
+	std::string path;                 ///< Log file path.
+	int fd;                           ///< Log file descriptor, or -1 if not open.
+	std::mutex mutex;                 ///< Guards the fields below.
+	std::condition_variable flushed;  ///< Signalled after each group commit.
+	std::string pending;              ///< Frames queued for the next group commit.
+	unsigned long enqueued;           ///< Appends queued so far.
+	unsigned long durable;            ///< Appends covered by a completed sync.
+	bool flushing;                    ///< True while a leader is writing and syncing.
+	bool failed;                      ///< Set if a write or sync failed.
+	unsigned long syncCount;          ///< Group commits performed.
+	unsigned long recordCount;        ///< Records appended.
+
+	WriteAheadLog(const WriteAheadLog&) = delete;
+	WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+};
+
+#endif // WRITEAHEADLOG_H
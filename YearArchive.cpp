@@ -0,0 +1,432 @@
+// YearArchive.cpp
+
+// Implements YearArchive: per-year column store partitions, least-recently-queried
+// eviction to segment files under a memory budget, and reloading them by mapping.
+
+#include "YearArchive.h"
+#include "Date.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace {
+	/**
+	 * @struct YearBuilder
+	 * @brief Context of addCollection: the records of the year being built.
+	 */
+	struct YearBuilder {
+		YearArchive* archive;                  ///< The archive being filled.
+		int year;                              ///< Year of the records held (0 before the first).
+		std::vector<WeatherRecord*> records;   ///< Copies of the year's records, in date order.
+		size_t total;                          ///< Records copied so far.
+	};
+
+	/**
+	 * @brief Turns the records held by a builder into a partition and frees them.
+	 *
+	 * @param  builder - Pointer to the builder.
+	 * @return void
+	 */
+	void flushYear(YearBuilder* builder) {
+		if (builder->records.empty()) return;
+		builder->archive->addYear(builder->year, new ColumnStore(&builder->records));
+		for (WeatherRecord* record : builder->records) {
+			delete record;
+		}
+		builder->records.clear();
+	}
+
+	/**
+	 * @brief Visitor of addCollection: copies a record, first flushing the previous year if it ends here.
+	 *
+	 * @param  record - Pointer to the visited record.
+	 * @param  context - Pointer to the YearBuilder.
+	 * @return void
+	 */
+	void collectYear(const WeatherRecord* record, void* context) {
+		YearBuilder* builder = static_cast<YearBuilder*>(context);
+		int year = record->date->GetYear();
+		if (year != builder->year) {
+			flushYear(builder);
+			builder->year = year;
+		}
+		builder->records.push_back(new WeatherRecord(*record));
+		builder->total += 1;
+	}
+
+	/**
+	 * @brief Adds one summary into another.
+	 *
+	 * @param  part - Pointer to the summary to add.
+	 * @param  total - Pointer to the running summary.
+	 * @return void
+	 */
+	void mergeSummary(const SeriesSummary* part, SeriesSummary* total) {
+		if (part->count == 0) return;
+		if (total->count == 0) {
+			*total = *part;
+			return;
+		}
+		total->count += part->count;
+		total->sum += part->sum;
+		total->sumSq += part->sumSq;
+		total->min = std::min(total->min, part->min);
+		total->max = std::max(total->max, part->max);
+	}
+
+	/**
+	 * @brief Gets the minute key of midnight on 1 January of a year.
+	 *
+	 * @param  year - The year.
+	 * @return int - The key.
+	 */
+	int yearStart(int year) {
+		Date first(1, 1, year);
+		return first.toMinuteKey();
+	}
+}
+
+	/**
+	 * @brief Constructor for YearArchive.
+	 *
+	 * @param  directory - Pointer to the segment directory.
+	 * @param  budgetBytes - Memory budget.
+	 * @return void
+	 */
+YearArchive::YearArchive(const std::string* directory, size_t budgetBytes)
+	: directory(*directory), budget(budgetBytes), resident(0), clock(0),
+	  evictions(0), reloads(0), writes(0) {}
+
+	/**
+	 * @brief Destructor for YearArchive. Frees resident partitions and removes the segment files.
+	 *
+	 * @return void
+	 */
+YearArchive::~YearArchive() {
+	std::vector<int> all;
+	partitions.keys(&all);
+	for (int year : all) {
+		Partition* partition = partitions.at(&year);
+		delete partition->store;
+		if (partition->written) std::remove(segmentPath(year).c_str());
+	}
+}
+
+	/**
+	 * @brief Copies a collection into the archive one year at a time.
+	 *
+	 * @param  data - Pointer to the collection.
+	 * @return size_t - The number of records copied.
+	 */
+size_t YearArchive::addCollection(const WeatherDataCollection* data) {
+	YearBuilder builder;
+	builder.archive = this;
+	builder.year = 0;
+	builder.total = 0;
+	data->forEachInRange(std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), collectYear, &builder);
+	flushYear(&builder);
+	return builder.total;
+}
+
+	/**
+	 * @brief Installs a year's partition as the most recently used one, dropping any previous one, then enforces the budget.
+	 *
+	 * @param  year - The year.
+	 * @param  store - Pointer to the rows (ownership is taken).
+	 * @return void
+	 */
+void YearArchive::addYear(int year, ColumnStore* store) {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (partitions.contains(&year)) {
+		Partition* old = partitions.at(&year);
+		if (old->store) resident -= old->bytes;
+		delete old->store;
+		if (old->written) std::remove(segmentPath(year).c_str());
+	}
+
+	Partition partition = {store, store->getMemoryBytes(), ++clock, false};
+	partitions.insert(&year, &partition);
+	resident += partition.bytes;
+	enforceBudget(year);
+}
+
+	/**
+	 * @brief Drops a year's partition and deletes its segment file.
+	 *
+	 * @param  year - The year.
+	 * @return bool - False if the year is not in the archive.
+	 */
+bool YearArchive::removeYear(int year) {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!partitions.contains(&year)) return false;
+
+	Partition* partition = partitions.at(&year);
+	if (partition->store) resident -= partition->bytes;
+	delete partition->store;
+	if (partition->written) std::remove(segmentPath(year).c_str());
+	partitions.erase(&year);
+	return true;
+}
+
+	/**
+	 * @brief Visits the records of every overlapping year in order, decoding rows in chunks into a scratch record.
+	 *
+	 * @param  from - First minute key.
+	 * @param  to - Last minute key (inclusive).
+	 * @param  visit - Function applied to each record.
+	 * @param  context - Opaque pointer passed to visit.
+	 * @return bool - False if a year could not be reloaded (the scan stops there).
+	 */
+bool YearArchive::forEachInRange(int from, int to, RecordVisitor visit, void* context) {
+	std::lock_guard<std::mutex> lock(mutex);
+	std::vector<int> years;
+	overlapping(from, to, &years);
+
+	const size_t kChunk = 256;
+	double values[kMetricCount][kChunk];
+	WeatherRecord scratch(new Date(), 0.0, 0.0, 0.0);
+
+	for (int year : years) {
+		const ColumnStore* store = touch(year);
+		if (!store) return false;
+		size_t row = store->lowerBound(from);
+		size_t end = (to == std::numeric_limits<int>::max()) ? store->size() : store->lowerBound(to + 1);
+
+		for (size_t chunkStart = row; chunkStart < end; chunkStart += kChunk) {
+			size_t chunkEnd = std::min(end, chunkStart + kChunk);
+			for (int m = 0; m < kMetricCount; ++m) {
+				store->copyColumn(static_cast<Metric>(m), chunkStart, chunkEnd, values[m]);
+			}
+			for (size_t i = chunkStart; i < chunkEnd; ++i) {
+				scratch.date->setMinuteKey(store->getKey(i));
+				scratch.windSpeed = values[static_cast<int>(Metric::WindSpeed)][i - chunkStart];
+				scratch.temperature = values[static_cast<int>(Metric::Temperature)][i - chunkStart];
+				scratch.solarRadiation = values[static_cast<int>(Metric::SolarRadiation)][i - chunkStart];
+				scratch.windDirection = values[static_cast<int>(Metric::WindDirection)][i - chunkStart];
+				visit(&scratch, context);
+			}
+		}
+	}
+	return true;
+}
+
+	/**
+	 * @brief Adds up the columnar summaries of every overlapping year.
+	 *
+	 * @param  metric - The metric.
+	 * @param  from - First minute key.
+	 * @param  to - Last minute key (inclusive).
+	 * @param  summary - Pointer to the aggregates to fill (empty on failure).
+	 * @return bool - False if a year could not be reloaded.
+	 */
+bool YearArchive::summarize(Metric metric, int from, int to, SeriesSummary* summary) {
+	std::lock_guard<std::mutex> lock(mutex);
+	const SeriesSummary empty = {0, 0.0, 0.0, 0.0, 0.0};
+	*summary = empty;
+	std::vector<int> years;
+	overlapping(from, to, &years);
+
+	for (int year : years) {
+		const ColumnStore* store = touch(year);
+		if (!store) {
+			*summary = empty;
+			return false;
+		}
+		SeriesSummary part = store->summarize(metric, from, to);
+		mergeSummary(&part, summary);
+	}
+	return true;
+}
+
+	/**
+	 * @brief Appends the key and value column slices of every overlapping year.
+	 *
+	 * @param  metric - The metric.
+	 * @param  from - First minute key.
+	 * @param  to - Last minute key (inclusive).
+	 * @param  keys - Pointer to the vector receiving the keys.
+	 * @param  values - Pointer to the vector receiving the values.
+	 * @return bool - False if a year could not be reloaded (both vectors are then left empty).
+	 */
+bool YearArchive::copySeries(Metric metric, int from, int to, std::vector<int>* keys, std::vector<double>* values) {
+	std::lock_guard<std::mutex> lock(mutex);
+	keys->clear();
+	values->clear();
+	std::vector<int> years;
+	overlapping(from, to, &years);
+
+	for (int year : years) {
+		const ColumnStore* store = touch(year);
+		if (!store) {
+			keys->clear();
+			values->clear();
+			return false;
+		}
+		size_t row = store->lowerBound(from);
+		size_t end = (to == std::numeric_limits<int>::max()) ? store->size() : store->lowerBound(to + 1);
+		if (end <= row) continue;
+
+		size_t offset = keys->size();
+		keys->resize(offset + (end - row));
+		values->resize(offset + (end - row));
+		for (size_t i = row; i < end; ++i) {
+			(*keys)[offset + i - row] = store->getKey(i);
+		}
+		store->copyColumn(metric, row, end, values->data() + offset);
+	}
+	return true;
+}
+
+	/**
+	 * @brief Sets the budget and evicts down to it.
+	 *
+	 * @param  budgetBytes - The new budget.
+	 * @return void
+	 */
+void YearArchive::setBudget(size_t budgetBytes) {
+	std::lock_guard<std::mutex> lock(mutex);
+	budget = budgetBytes;
+	enforceBudget(0);
+}
+
+	/**
+	 * @brief Snapshots the counters.
+	 *
+	 * @return ArchiveStats - The counters.
+	 */
+ArchiveStats YearArchive::getStats() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	ArchiveStats stats = {evictions, reloads, writes, resident, budget, 0, 0};
+	std::vector<int> all;
+	partitions.keys(&all);
+	for (int year : all) {
+		stats.years += 1;
+		if (partitions.at(&year)->store) stats.residentYears += 1;
+	}
+	return stats;
+}
+
+	/**
+	 * @brief Lists the years in the archive.
+	 *
+	 * @param  years - Pointer to the vector receiving the years.
+	 * @return void
+	 */
+void YearArchive::years(std::vector<int>* years) const {
+	std::lock_guard<std::mutex> lock(mutex);
+	partitions.keys(years);
+}
+
+	/**
+	 * @brief Marks a year most recently used, mapping its segment back in if it was evicted.
+	 *
+	 * The budget is enforced after a reload, keeping the year just loaded.
+	 *
+	 * @param  year - The year.
+	 * @return const ColumnStore* - The rows, or nullptr if the segment could not be mapped.
+	 */
+const ColumnStore* YearArchive::touch(int year) {
+	Partition* partition = partitions.at(&year);
+	partition->lastUsed = ++clock;
+	if (partition->store) return partition->store;
+
+	std::string path = segmentPath(year);
+	partition->store = ColumnStore::mapFile(&path);
+	if (!partition->store) {
+		std::cerr << "Error: Could not reload segment " << path << "." << std::endl;
+		return nullptr;
+	}
+	partition->bytes = partition->store->getMemoryBytes();
+	resident += partition->bytes;
+	reloads += 1;
+	enforceBudget(year);
+	return partition->store;
+}
+
+	/**
+	 * @brief Evicts the least recently used resident partition, other than keep, until the budget holds.
+	 *
+	 * @param  keep - Year to keep resident (0 for none).
+	 * @return void
+	 */
+void YearArchive::enforceBudget(int keep) {
+	std::vector<int> all;
+	while (resident > budget) {
+		partitions.keys(&all);
+		int victim = 0;
+		Partition* oldest = nullptr;
+		for (int year : all) {
+			Partition* partition = partitions.at(&year);
+			if (year == keep || !partition->store) continue;
+			if (!oldest || partition->lastUsed < oldest->lastUsed) {
+				victim = year;
+				oldest = partition;
+			}
+		}
+		if (!oldest || !evict(victim, oldest)) return;
+	}
+}
+
+	/**
+	 * @brief Writes a partition's segment the first time it is evicted, then frees or unmaps it.
+	 *
+	 * Partitions are immutable, so a segment once written stays valid and later evictions
+	 * only drop the mapping. The partition stays resident unless the segment closed cleanly.
+	 *
+	 * @param  year - The year.
+	 * @param  partition - Pointer to the partition.
+	 * @return bool - False if the segment could not be written.
+	 */
+bool YearArchive::evict(int year, Partition* partition) {
+	if (!partition->written) {
+		std::string path = segmentPath(year);
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		bool ok = out.is_open() && partition->store->writeTo(&out);
+		// writeTo can succeed with bytes still buffered: only a clean close means the segment is complete
+		out.close();
+		if (!ok || out.fail()) {
+			std::cerr << "Error: Could not write segment " << path << "." << std::endl;
+			std::remove(path.c_str());
+			return false;
+		}
+		partition->written = true;
+		writes += 1;
+	}
+
+	delete partition->store;
+	partition->store = nullptr;
+	resident -= partition->bytes;
+	evictions += 1;
+	return true;
+}
+
+	/**
+	 * @brief Collects the archived years whose first-to-last key range meets [from, to].
+	 *
+	 * @param  from - First minute key.
+	 * @param  to - Last minute key (inclusive).
+	 * @param  overlapping - Pointer to the vector receiving the years.
+	 * @return void
+	 */
+void YearArchive::overlapping(int from, int to, std::vector<int>* overlapping) const {
+	overlapping->clear();
+	if (from > to) return;
+
+	std::vector<int> all;
+	partitions.keys(&all);
+	for (int year : all) {
+		if (yearStart(year) <= to && yearStart(year + 1) > from) overlapping->push_back(year);
+	}
+}
+
+	/**
+	 * @brief Builds the segment path: the directory, then year_<year>.wcs.
+	 *
+	 * @param  year - The year.
+	 * @return std::string - The path.
+	 */
+std::string YearArchive::segmentPath(int year) const {
+	return directory + "/year_" + std::to_string(year) + ".wcs";
+}
@@ -0,0 +1,205 @@
+#ifndef YEARARCHIVE_H
+#define YEARARCHIVE_H
+
+#include "ColumnStore.h"
+#include "CompressedSeries.h"
+#include "Map.h"
+#include "Metric.h"
+#include "WeatherDataCollection.h"
+#include "WeatherRecord.h"
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @struct ArchiveStats
+ * @brief Counters of a YearArchive.
+ */
+struct ArchiveStats {
+	unsigned long evictions;  ///< Partitions dropped from memory to get under the budget.
+	unsigned long reloads;    ///< Evicted partitions mapped back in because a query touched them.
+	unsigned long writes;     ///< Segment files written (a partition is written at most once).
+	size_t residentBytes;     ///< Bytes of the partitions in memory.
+	size_t budgetBytes;       ///< The memory budget.
+	int residentYears;        ///< Partitions in memory.
+	int years;                ///< Partitions in the archive.
+};
+
+/**
+ * @class YearArchive
+ * @brief Records partitioned by year into column stores, kept under a memory budget.
+ *
+ * Each year is one immutable ColumnStore. When the partitions in memory exceed the budget,
+ * the least recently queried ones are evicted: a partition that has never been evicted is
+ * written to a segment file in the archive's directory (ColumnStore::writeTo), and then
+ * freed. A query that touches an evicted year maps its segment back in
+ * (ColumnStore::mapFile), so a reload costs a page-in rather than a parse, and may in turn
+ * evict others. The year being queried is never evicted, so a single partition larger
+ * than the budget still answers.
+ *
+ * A partition is only freed once its segment has been written and closed without error. A
+ * query that cannot map an evicted year back in fails as a whole rather than answering
+ * without that year. Mapped partitions count against the budget like heap ones. Queries hold the archive's
+ * lock while they run, so concurrent queries are safe but serialized, and a visitor must
+ * not call back into the archive.
+ */
+class YearArchive {
+public:
+	/**
+	 * @brief Function applied to each record of a range scan.
+	 */
+	typedef WeatherDataCollection::RecordVisitor RecordVisitor;
+
+	/**
+	 * @brief Constructor. Creates an empty archive.
+	 * @param directory A constant pointer to an existing directory for the segment files.
+	 * @param budgetBytes The memory budget of the partitions in memory.
+	 */
+	YearArchive(const std::string* directory, size_t budgetBytes);
+
+	/**
+	 * @brief Destructor. Frees the partitions and deletes the segment files the archive wrote.
+	 */
+	~YearArchive();
+
+	YearArchive(const YearArchive&) = delete;
+	YearArchive& operator=(const YearArchive&) = delete;
+
+	/**
+	 * @brief Copies every record of a collection into one partition per year.
+	 *
+	 * Years are built one at a time in date order, so only one year of records is held
+	 * as objects at once, and the budget is enforced as each partition is added.
+	 * @param data A constant pointer to the collection.
+	 * @return size_t The number of records copied.
+	 */
+	size_t addCollection(const WeatherDataCollection* data);
+
+	/**
+	 * @brief Adds or replaces the partition of a year.
+	 * @param year The year.
+	 * @param store A pointer to the year's rows (ownership is taken).
+	 */
+	void addYear(int year, ColumnStore* store);
+
+	/**
+	 * @brief Removes the partition of a year and its segment file.
+	 * @param year The year.
+	 * @return bool False if the year is not in the archive.
+	 */
+	bool removeYear(int year);
+
+	/**
+	 * @brief Visits every record with from <= minute key <= to, in date order, reloading evicted years as needed.
+	 *
+	 * Rows are decoded into a scratch record, so the pointer passed to visit is only valid
+	 * during the call.
+	 * @param from The first minute key of the range.
+	 * @param to The last minute key of the range (inclusive).
+	 * @param visit The function applied to each record.
+	 * @param context Opaque pointer passed to visit.
+	 * @return bool False if an evicted year could not be reloaded; the scan stops there, after
+	 * visiting the records of the years before it.
+	 */
+	bool forEachInRange(int from, int to, RecordVisitor visit, void* context);
+
+	/**
+	 * @brief Aggregates one metric over a minute-key range.
+	 * @param metric The metric.
+	 * @param from The first minute key of the range.
+	 * @param to The last minute key of the range (inclusive).
+	 * @param summary Receives the aggregates (empty if the call fails).
+	 * @return bool False if an evicted year could not be reloaded.
+	 */
+	bool summarize(Metric metric, int from, int to, SeriesSummary* summary);
+
+	/**
+	 * @brief Copies one metric over a minute-key range, with its keys, into two parallel vectors in date order.
+	 * @param metric The metric.
+	 * @param from The first minute key of the range.
+	 * @param to The last minute key of the range (inclusive).
+	 * @param keys Receives the minute keys, ascending (overwritten).
+	 * @param values Receives the values (overwritten; both vectors are empty if the call fails).
+	 * @return bool False if an evicted year could not be reloaded.
+	 */
+	bool copySeries(Metric metric, int from, int to, std::vector<int>* keys, std::vector<double>* values);
+
+	/**
+	 * @brief Changes the memory budget, evicting at once if the partitions in memory exceed it.
+	 * @param budgetBytes The new budget.
+	 */
+	void setBudget(size_t budgetBytes);
+
+	/**
+	 * @brief Gets the eviction and reload counters and the memory in use.
+	 * @return ArchiveStats The counters.
+	 */
+	ArchiveStats getStats() const;
+
+	/**
+	 * @brief Lists the years in the archive.
+	 * @param years Receives the years, ascending (overwritten).
+	 */
+	void years(std::vector<int>* years) const;
+
+private:
+	/**
+	 * @struct Partition
+	 * @brief One year of the archive.
+	 */
+	struct Partition {
+		ColumnStore* store;       ///< The rows, or nullptr while evicted.
+		size_t bytes;             ///< Memory of store while it is in memory.
+		unsigned long lastUsed;   ///< Query clock value of the last touch.
+		bool written;             ///< True once the segment file exists.
+	};
+
+	/**
+	 * @brief Makes a year's partition resident and marks it most recently used.
+	 * @param year The year (must be in the archive).
+	 * @return const ColumnStore* The rows, or nullptr if the segment could not be mapped.
+	 */
+	const ColumnStore* touch(int year);
+
+	/**
+	 * @brief Evicts least recently used partitions until the budget holds.
+	 * @param keep A year that must stay resident (or 0 for none).
+	 */
+	void enforceBudget(int keep);
+
+	/**
+	 * @brief Writes a partition's segment if needed and frees it.
+	 * @param year The year.
+	 * @param partition The partition.
+	 * @return bool False if the segment could not be written (the partition stays resident).
+	 */
+	bool evict(int year, Partition* partition);
+
+	/**
+	 * @brief Collects the years whose key ranges overlap [from, to].
+	 * @param from The first minute key.
+	 * @param to The last minute key (inclusive).
+	 * @param overlapping Receives the years, ascending.
+	 */
+	void overlapping(int from, int to, std::vector<int>* overlapping) const;
+
+	/**
+	 * @brief Gets the path of a year's segment file.
+	 * @param year The year.
+	 * @return std::string The path.
+	 */
+	std::string segmentPath(int year) const;
+
+	std::string directory;          ///< Directory of the segment files.
+	size_t budget;                  ///< Memory budget in bytes.
+	size_t resident;                ///< Bytes of the resident partitions.
+	unsigned long clock;            ///< Query clock for recency.
+	unsigned long evictions;        ///< Evictions so far.
+	unsigned long reloads;          ///< Reloads so far.
+	unsigned long writes;           ///< Segment writes so far.
+	Map<int, Partition> partitions; ///< Partitions by year.
+	mutable std::mutex mutex;       ///< Guards everything above.
+};
+
+#endif // YEARARCHIVE_H
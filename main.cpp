@@ -1,18 +1,84 @@
 // main.cpp
 
 // The entry point for the Assignment 2 Weather Data Analysis application.
-// Initializes and runs the Assignment2App class.
+// Initializes and runs the Assignment2App class, produces a monthly report in
+// streaming mode when invoked with --stream, or tail-follows the data files with --follow.
 
 #include "Assignment2App.h"
+#include "FileFollower.h"
+#include "StreamingAggregator.h"
+#include "WeatherDataStore.h"
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+	/**
+	 * @brief Follower sink that publishes each batch of new records as a new store version.
+	 *
+	 * @param  records - Pointer to the new records (ownership is transferred).
+	 * @param  context - Pointer to the WeatherDataStore.
+	 * @return void
+	 */
+static void appendToStore(std::vector<WeatherRecord*>* records, void* context) {
+	WeatherDataStore* store = static_cast<WeatherDataStore*>(context);
+	int before = store->read()->getTotalRecords();
+	store->appendBatch(records);
+	int total = store->read()->getTotalRecords();
+	std::cout << "+" << (total - before) << " records, " << total << " in total" << std::endl;
+}
 
 	/**
 	 * @brief Main function of the program.
 	 *
-	 * Creates an instance of the Assignment2App and starts the application loop.
+	 * With no arguments, creates an instance of the Assignment2App and starts the application loop.
+	 * With "--stream <listFile> <year> [output]", writes the monthly statistics report for the
+	 * year straight from the data files without loading them (see StreamingAggregator).
+	 * With "--follow <listFile> [intervalMs]", loads the files and then keeps appending the
+	 * lines written to them since the load began until interrupted (see FileFollower).
 	 *
-	 * @return int - Returns 0 upon successful execution.
+	 * @param  argc - Argument count.
+	 * @param  argv - Argument values.
+	 * @return int - Returns 0 upon successful execution, 1 if the streaming report failed.
 	 */
-int main() {
+int main(int argc, char* argv[]) {
+	if (argc >= 4 && std::string(argv[1]) == "--stream") {
+		std::string listFile = argv[2];
+		int year = std::atoi(argv[3]);
+		std::string filename = argc > 4 ? argv[4] : "WindTempSolar.csv";
+
+		StreamingAggregator aggregator;
+		if (!aggregator.aggregateFiles(&listFile) || !aggregator.writeMonthlyStats(&year, &filename)) {
+			std::cerr << "Streaming report failed." << std::endl;
+			return 1;
+		}
+		std::cout << "Aggregated " << aggregator.getRecordCount() << " records. Report generated: "
+				  << filename << std::endl;
+		return 0;
+	}
+
+	if (argc >= 3 && std::string(argv[1]) == "--follow") {
+		std::string listFile = argv[2];
+		int intervalMs = argc > 3 ? std::atoi(argv[3]) : 1000;
+
+		// Take each file's end before loading, so lines appended while the load runs are
+		// delivered by the first poll; any the load also read are rejected as duplicates
+		FileFollower follower(WeatherDataCollection::parseRecord, intervalMs);
+		if (!follower.followList(&listFile, false)) {
+			std::cerr << "Failed to open file list: " << listFile << std::endl;
+			return 1;
+		}
+
+		WeatherDataStore store;
+		store.loadFromFiles(&listFile);
+		std::cout << "Following " << listFile << (follower.isUsingInotify() ? " (inotify)" : " (polling)")
+				  << "; press Ctrl+C to stop." << std::endl;
+
+		std::atomic<bool> stop(false);
+		follower.run(appendToStore, &store, &stop);
+		return 0;
+	}
+
 	Assignment2App app;
 	app.run();
 